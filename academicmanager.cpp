@@ -4,20 +4,70 @@
  * Handles File I/O, Authentication, and Data Management.
  */
 #include "academicmanager.hpp"
+#include "tableregistry.hpp"
+#include "gradebook.hpp"
+#include "gpaengine.hpp"
+#include "profiler.hpp"
+#include "storagebackend.hpp"
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
 #include <QMap>
+#include <QSet>
+#include <QHash>
+#include <limits>
 
 // Helper functions for CSV handling
+/**
+ * @brief Splits one CSV line into trimmed fields.
+ * Handles quoted fields containing commas and escaped quotes ("").
+ */
+QStringList AcadenceManager::parseCsvLine(const QString &line)
+{
+    QStringList row;
+    QString currentField;
+    bool inQuotes = false;
+    for (int i = 0; i < line.length(); ++i)
+    {
+        QChar c = line[i];
+        if (c == '"')
+        {
+            // Handle escaped quotes ("") inside quoted fields
+            if (inQuotes && i + 1 < line.length() && line[i + 1] == '"')
+            {
+                currentField += '"'; // Escaped quote
+                i++;
+            }
+            else
+            {
+                // Toggle quote state
+                inQuotes = !inQuotes;
+            }
+        }
+        else if (c == ',' && !inQuotes)
+        {
+            // Field separator found outside of quotes
+            row.append(currentField.trimmed());
+            currentField.clear();
+        }
+        else
+        {
+            currentField += c;
+        }
+    }
+    row.append(currentField.trimmed());
+    return row;
+}
+
 /**
  * @brief Reads a CSV file and parses it into a vector of string lists.
- * Handles quoted fields containing commas or newlines.
  * @param filename The path to the CSV file.
  * @return A QVector of QStringList, where each inner list is a row.
  */
 QVector<QStringList> AcadenceManager::readCsv(const QString &filename)
 {
+    ACADENCE_PROFILE("AcadenceManager::readCsv");
+    ACADENCE_TRACE_DETAIL("io", "read", filename);
     QVector<QStringList> data;
     QFile file(filename);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -32,41 +82,9 @@ QVector<QStringList> AcadenceManager::readCsv(const QString &filename)
             QString line = in.readLine();
             if (line.trimmed().isEmpty())
                 continue;
-
-            QStringList row;
-            QString currentField;
-            bool inQuotes = false;
-            for (int i = 0; i < line.length(); ++i)
-            {
-                QChar c = line[i];
-                if (c == '"')
-                {
-                    // Handle escaped quotes ("") inside quoted fields
-                    if (inQuotes && i + 1 < line.length() && line[i + 1] == '"')
-                    {
-                        currentField += '"'; // Escaped quote
-                        i++;
-                    }
-                    else
-                    {
-                        // Toggle quote state
-                        inQuotes = !inQuotes;
-                    }
-                }
-                else if (c == ',' && !inQuotes)
-                {
-                    // Field separator found outside of quotes
-                    row.append(currentField.trimmed());
-                    currentField.clear();
-                }
-                else
-                {
-                    currentField += c;
-                }
-            }
-            row.append(currentField.trimmed());
-            data.append(row);
+            data.append(parseCsvLine(line));
         }
+        ACADENCE_PROFILE_READ(file.size(), data.size());
         file.close();
     }
     return data;
@@ -87,8 +105,15 @@ static QString escapeCsv(const QString &val)
     return val;
 }
 
-static void appendCsv(const QString &filename, const QStringList &fields)
+void AcadenceManager::appendCsv(const QString &filename, const QStringList &fields)
 {
+    appendCsv(filename, QVector<QStringList>{fields});
+}
+
+void AcadenceManager::appendCsv(const QString &filename, const QVector<QStringList> &rows)
+{
+    ACADENCE_PROFILE("AcadenceManager::appendCsv");
+    ACADENCE_TRACE_DETAIL("io", "append", filename);
     QFile file(filename);
     if (!file.open(QIODevice::Append | QIODevice::Text))
     {
@@ -96,17 +121,25 @@ static void appendCsv(const QString &filename, const QStringList &fields)
     }
     else
     {
+        [[maybe_unused]] qint64 start = file.size();
         QTextStream out(&file);
-        QStringList escaped;
-        for (const QString &f : fields)
-            escaped << escapeCsv(f);
-        out << escaped.join(",") << "\n";
+        for (const auto &row : rows)
+        {
+            QStringList escaped;
+            for (const QString &f : row)
+                escaped << escapeCsv(f);
+            out << escaped.join(",") << "\n";
+        }
+        out.flush();
+        ACADENCE_PROFILE_WRITTEN(file.size() - start);
         file.close();
     }
 }
 
 void AcadenceManager::writeCsv(const QString &filename, const QVector<QStringList> &data)
 {
+    ACADENCE_PROFILE("AcadenceManager::writeCsv");
+    ACADENCE_TRACE_DETAIL("io", "write", filename);
     QFile file(filename);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
     {
@@ -114,18 +147,132 @@ void AcadenceManager::writeCsv(const QString &filename, const QVector<QStringLis
     }
     else
     {
-        QTextStream out(&file);
-        for (const auto &row : data)
+        writeCsv(file, data);
+        file.close();
+    }
+}
+
+void AcadenceManager::writeCsv(QIODevice &device, const QVector<QStringList> &data)
+{
+    QTextStream out(&device);
+    for (const auto &row : data)
+    {
+        QStringList escapedRow;
+        for (const QString &field : row)
+            escapedRow << escapeCsv(field);
+        out << escapedRow.join(",") << "\n";
+    }
+    out.flush();
+    ACADENCE_PROFILE_WRITTEN(device.pos());
+}
+
+QVector<QStringList> AcadenceManager::table(const QString &filename)
+{
+    ACADENCE_PROFILE("AcadenceManager::table");
+    return DataStore::instance().table(filename)->getRows();
+}
+
+QVector<QStringList> AcadenceManager::rowsWhere(const QString &filename, int column, const QString &value)
+{
+    int total = 0;
+    return selectRows(filename, column, value, 0, std::numeric_limits<int>::max(), total);
+}
+
+QVector<QStringList> AcadenceManager::selectRows(const QString &filename, int column, const QString &value, int offset, int limit, int &total)
+{
+    ACADENCE_PROFILE("AcadenceManager::selectRows");
+    std::shared_ptr<StorageBackend> backend = DataStore::instance().backend();
+    if (backend->isRemote() && !DataStore::instance().snapshot()->table(filename))
+    {
+        QByteArray request;
+        QDataStream out(&request, QIODevice::WriteOnly);
+        Protocol::writeString(out, filename);
+        out << qint32(column);
+        Protocol::writeString(out, value);
+        out << quint32(qMax(0, offset)) << quint32(qMax(0, limit));
+
+        QByteArray reply = backend->query(Protocol::Select, request);
+        QDataStream in(reply);
+        quint32 matches = 0;
+        in >> matches;
+        QVector<QStringList> rows = Protocol::readRows(in);
+        if (in.status() != QDataStream::Ok)
+            throw Acadence::FileException("Malformed rows from acadence-server for " + filename);
+        total = int(qMin<quint32>(matches, std::numeric_limits<int>::max()));
+        return rows;
+    }
+
+    TableSnapshotPtr t = DataStore::instance().table(filename);
+    QVector<QStringList> rows;
+    total = 0;
+    for (const auto &row : t->getRows())
+    {
+        if (column >= 0 && row.value(column) != value)
+            continue;
+        if (total >= offset && rows.size() < limit)
+            rows.append(row);
+        ++total;
+    }
+    return rows;
+}
+
+void AcadenceManager::saveTable(const QString &filename, const QVector<QStringList> &data)
+{
+    ACADENCE_PROFILE("AcadenceManager::saveTable");
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 { batch.rows(filename) = data; });
+}
+
+QStringList AcadenceManager::dataFiles()
+{
+    ACADENCE_PROFILE("AcadenceManager::dataFiles");
+    QStringList files;
+    for (const TableDescriptor *table : TableRegistry::tables())
+        files << table->getFileName();
+    return files;
+}
+
+void AcadenceManager::initializeDataFiles()
+{
+    ACADENCE_PROFILE("AcadenceManager::initializeDataFiles");
+    QFile adminsFile("admins.csv");
+    if (!adminsFile.exists())
+    {
+        if (adminsFile.open(QIODevice::WriteOnly | QIODevice::Text))
         {
-            QStringList escapedRow;
-            for (const QString &field : row)
-                escapedRow << escapeCsv(field);
-            out << escapedRow.join(",") << "\n";
+            QTextStream out(&adminsFile);
+            // Format: ID,Username,Password,Name,Email (Admin is a Person only)
+            out << "1,admin,admin,System Admin,admin@school.edu\n";
+            adminsFile.close();
+        }
+    }
+
+    for (const QString &fileName : dataFiles())
+    {
+        QFile file(fileName);
+        if (!file.exists() && !file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            // Log warning or handle error, but don't crash main loop yet
+        }
+        else
+        {
+            file.close();
         }
-        file.close();
     }
 }
 
+/**
+ * @brief Returns the highest integer in column 0 of a table, for ID generation.
+ */
+static int maxIdOf(const CsvTable &data)
+{
+    int maxId = 0;
+    for (const auto &row : data)
+        if (row.size() > 0)
+            maxId = std::max(maxId, row[0].toInt());
+    return maxId;
+}
+
 AcadenceManager::AcadenceManager()
 {
     // Constructor is intentionally empty.
@@ -133,9 +280,10 @@ AcadenceManager::AcadenceManager()
 
 QString AcadenceManager::login(const QString &username, const QString &password, int &userId)
 {
+    ACADENCE_PROFILE("AcadenceManager::login");
     // 1. Check Admins
-    QVector<QStringList> admins = readCsv("admins.csv");
     // Format: ID,Username,Password,Name,Email
+    QVector<QStringList> admins = rowsWhere("admins.csv", 1, username);
     for (const auto &row : admins)
     {
         if (row.size() >= 3 && row[1] == username && row[2] == password)
@@ -146,8 +294,8 @@ QString AcadenceManager::login(const QString &username, const QString &password,
     }
 
     // 2. Check Students
-    QVector<QStringList> students = readCsv("students.csv");
     // Format: ID,Name,Email,Username,Password,...
+    QVector<QStringList> students = rowsWhere("students.csv", 3, username);
     for (const auto &row : students)
     {
         if (row.size() >= 5 && row[3] == username && row[4] == password)
@@ -158,8 +306,8 @@ QString AcadenceManager::login(const QString &username, const QString &password,
     }
 
     // 3. Check Teachers
-    QVector<QStringList> teachers = readCsv("teachers.csv");
     // Format: ID,Name,Email,Username,Password,...
+    QVector<QStringList> teachers = rowsWhere("teachers.csv", 3, username);
     for (const auto &row : teachers)
     {
         if (row.size() >= 5 && row[3] == username && row[4] == password)
@@ -173,6 +321,7 @@ QString AcadenceManager::login(const QString &username, const QString &password,
 
 bool AcadenceManager::changePassword(int userId, const QString &role, const QString &oldPass, const QString &newPass)
 {
+    ACADENCE_PROFILE("AcadenceManager::changePassword");
     QString filename;
     int passIndex = 4; // Default for Student/Teacher (ID, Name, Email, Username, Password)
 
@@ -194,39 +343,34 @@ bool AcadenceManager::changePassword(int userId, const QString &role, const QStr
         return false;
     }
 
-    QVector<QStringList> data = readCsv(filename);
-    bool found = false;
-
-    for (auto &row : data)
-    {
-        if (row.size() > passIndex && row[0].toInt() == userId)
+    // Throwing inside the commit aborts it, so nothing is written on failure
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        for (auto &row : batch.rows(filename))
         {
-            if (row[passIndex] == oldPass)
+            if (row.size() > passIndex && row[0].toInt() == userId)
             {
+                if (row[passIndex] != oldPass)
+                    throw Acadence::Exception("Old password does not match.");
                 row[passIndex] = newPass;
-                found = true;
-            }
-            else
-            {
-                throw Acadence::Exception("Old password does not match.");
+                return;
             }
-            break;
         }
-    }
-
-    if (found)
-    {
-        writeCsv(filename, data);
-        return true;
-    }
-    throw Acadence::Exception("User not found.");
+        throw Acadence::Exception("User not found."); });
+    return true;
 }
 
 // Dashboard
 QVector<Notice> AcadenceManager::getNotices()
 {
+    ACADENCE_PROFILE("AcadenceManager::getNotices");
+    return getNotices(table("notices.csv"));
+}
+
+QVector<Notice> AcadenceManager::getNotices(const QVector<QStringList> &data)
+{
+    ACADENCE_PROFILE("AcadenceManager::getNotices(rows)");
     QVector<Notice> notices;
-    QVector<QStringList> data = readCsv("notices.csv");
     // Format: Date,Author,Content
     for (const auto &row : data)
     {
@@ -240,12 +384,15 @@ QVector<Notice> AcadenceManager::getNotices()
 
 void AcadenceManager::addNotice(const QString &content, const QString &author)
 {
+    ACADENCE_PROFILE("AcadenceManager::addNotice");
     QString date = QDate::currentDate().toString("yyyy-MM-dd");
-    appendCsv("notices.csv", {date, author, content});
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 { batch.append("notices.csv", {date, author, content}); });
 }
 
 QString AcadenceManager::getNextClass(int userId)
 {
+    ACADENCE_PROFILE("AcadenceManager::getNextClass");
     // Simple logic: Get routine for today, find first class after current time
     Student *s = getStudent(userId);
     if (!s)
@@ -271,10 +418,15 @@ QString AcadenceManager::getNextClass(int userId)
 
 QString AcadenceManager::getDashboardStats(int userId, QString role)
 {
+    ACADENCE_PROFILE("AcadenceManager::getDashboardStats");
     if (role == "Student")
     {
-        // Calculate GPA or Attendance
-        return "GPA: " + QString::number(3.5); // Placeholder calculation
+        Student *s = getStudent(userId);
+        if (!s)
+            return "GPA: N/A";
+        double gpa = s->calculateGPA();
+        delete s;
+        return "GPA: " + QString::number(gpa, 'f', 2);
     }
     else if (role == "Teacher")
     {
@@ -286,7 +438,8 @@ QString AcadenceManager::getDashboardStats(int userId, QString role)
 // Users
 Student *AcadenceManager::getStudent(int id)
 {
-    QVector<QStringList> data = readCsv("students.csv");
+    ACADENCE_PROFILE("AcadenceManager::getStudent");
+    QVector<QStringList> data = rowsWhere("students.csv", 0, QString::number(id));
     // Format: ID,Name,Email,Username,Password,Dept,Batch,Sem,DateAdmission,CGPA
     for (const auto &row : data)
     {
@@ -310,7 +463,8 @@ Student *AcadenceManager::getStudent(int id)
 
 Teacher *AcadenceManager::getTeacher(int id)
 {
-    QVector<QStringList> data = readCsv("teachers.csv");
+    ACADENCE_PROFILE("AcadenceManager::getTeacher");
+    QVector<QStringList> data = rowsWhere("teachers.csv", 0, QString::number(id));
     // Format: ID,Name,Email,Username,Password,Dept,Designation,Salary
     for (const auto &row : data)
     {
@@ -332,9 +486,10 @@ Teacher *AcadenceManager::getTeacher(int id)
 // Planner
 QVector<Task> AcadenceManager::getTasks(int userId)
 {
+    ACADENCE_PROFILE("AcadenceManager::getTasks");
     QVector<Task> tasks;
-    QVector<QStringList> data = readCsv("tasks.csv");
     // Format: ID,UserID,Desc,IsCompleted
+    QVector<QStringList> data = rowsWhere("tasks.csv", 1, QString::number(userId));
     for (const auto &row : data)
     {
         if (row.size() >= 4 && row[1].toInt() == userId)
@@ -347,34 +502,34 @@ QVector<Task> AcadenceManager::getTasks(int userId)
 
 void AcadenceManager::addTask(int userId, const QString &description)
 {
-    // Generate ID
-    QVector<QStringList> data = readCsv("tasks.csv");
-    int maxId = 0;
-    for (const auto &row : data)
-        if (row.size() > 0)
-            maxId = std::max(maxId, row[0].toInt());
-
-    appendCsv("tasks.csv", {QString::number(maxId + 1), QString::number(userId), description, "0"});
+    ACADENCE_PROFILE("AcadenceManager::addTask");
+    // Generate ID under the writer lock so concurrent adds cannot collide
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        int maxId = maxIdOf(batch.peek("tasks.csv"));
+        batch.append("tasks.csv", {QString::number(maxId + 1), QString::number(userId), description, "0"}); });
 }
 
 void AcadenceManager::completeTask(int taskId, bool status)
 {
-    QVector<QStringList> data = readCsv("tasks.csv");
-    for (auto &row : data)
-    {
-        if (row.size() >= 4 && row[0].toInt() == taskId)
+    ACADENCE_PROFILE("AcadenceManager::completeTask");
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        for (auto &row : batch.rows("tasks.csv"))
         {
-            row[3] = status ? "1" : "0";
-        }
-    }
-    writeCsv("tasks.csv", data);
+            if (row.size() >= 4 && row[0].toInt() == taskId)
+            {
+                row[3] = status ? "1" : "0";
+            }
+        } });
 }
 
 // Habits
 DailyPrayerStatus AcadenceManager::getDailyPrayers(int userId, QString date)
 {
-    QVector<QStringList> data = readCsv("prayers.csv");
+    ACADENCE_PROFILE("AcadenceManager::getDailyPrayers");
     // Format: UserID,Date,Fajr,Dhuhr,Asr,Maghrib,Isha
+    QVector<QStringList> data = rowsWhere("prayers.csv", 0, QString::number(userId));
     for (const auto &row : data)
     {
         if (row.size() >= 7 && row[0].toInt() == userId && row[1] == date)
@@ -387,9 +542,7 @@ DailyPrayerStatus AcadenceManager::getDailyPrayers(int userId, QString date)
 
 void AcadenceManager::updateDailyPrayer(int userId, QString date, QString prayer, bool status)
 {
-    QVector<QStringList> data = readCsv("prayers.csv");
-    bool found = false;
-
+    ACADENCE_PROFILE("AcadenceManager::updateDailyPrayer");
     int prayerIdx = -1;
     if (prayer == "fajr")
         prayerIdx = 2;
@@ -402,31 +555,35 @@ void AcadenceManager::updateDailyPrayer(int userId, QString date, QString prayer
     else if (prayer == "isha")
         prayerIdx = 6;
 
-    for (auto &row : data)
-    {
-        if (row.size() >= 7 && row[0].toInt() == userId && row[1] == date)
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        CsvTable &data = batch.rows("prayers.csv");
+        bool found = false;
+        for (auto &row : data)
         {
-            if (prayerIdx != -1)
-                row[prayerIdx] = status ? "1" : "0";
-            found = true;
+            if (row.size() >= 7 && row[0].toInt() == userId && row[1] == date)
+            {
+                if (prayerIdx != -1)
+                    row[prayerIdx] = status ? "1" : "0";
+                found = true;
+            }
         }
-    }
 
-    if (!found)
-    {
-        QStringList newRow = {QString::number(userId), date, "0", "0", "0", "0", "0"};
-        if (prayerIdx != -1)
-            newRow[prayerIdx] = status ? "1" : "0";
-        data.append(newRow);
-    }
-    writeCsv("prayers.csv", data);
+        if (!found)
+        {
+            QStringList newRow = {QString::number(userId), date, "0", "0", "0", "0", "0"};
+            if (prayerIdx != -1)
+                newRow[prayerIdx] = status ? "1" : "0";
+            data.append(newRow);
+        } });
 }
 
 QVector<Habit *> AcadenceManager::getHabits(int userId)
 {
+    ACADENCE_PROFILE("AcadenceManager::getHabits");
     QVector<Habit *> habits;
-    QVector<QStringList> data = readCsv("habits.csv");
     // Format: ID,UserID,Name,Type,Freq,Target,Current,Streak,LastDate,IsCompleted,Unit
+    QVector<QStringList> data = rowsWhere("habits.csv", 1, QString::number(userId));
     for (const auto &row : data)
     {
         if (row.size() >= 11 && row[1].toInt() == userId)
@@ -473,13 +630,7 @@ QVector<Habit *> AcadenceManager::getHabits(int userId)
 
 void AcadenceManager::addHabit(Habit *h)
 {
-    QVector<QStringList> data = readCsv("habits.csv");
-    int maxId = 0;
-    for (const auto &row : data)
-        if (row.size() > 0)
-            maxId = std::max(maxId, row[0].toInt());
-    h->id = maxId + 1;
-
+    ACADENCE_PROFILE("AcadenceManager::addHabit");
     QString typeStr = (h->type == HabitType::DURATION) ? "Duration" : "Count";
     QString freqStr = (h->frequency == Frequency::DAILY) ? "Daily" : "Weekly";
     QString unit = "";
@@ -493,51 +644,59 @@ void AcadenceManager::addHabit(Habit *h)
         unit = ch->unit;
     }
 
-    appendCsv("habits.csv", {QString::number(h->id), QString::number(h->studentId), h->name, typeStr, freqStr,
-                             QString::number(target), "0", "0", QDate::currentDate().toString(Qt::ISODate), "0", unit});
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        h->id = maxIdOf(batch.peek("habits.csv")) + 1;
+        batch.append("habits.csv", {QString::number(h->id), QString::number(h->studentId), h->name, typeStr, freqStr,
+                                    QString::number(target), "0", "0", QDate::currentDate().toString(Qt::ISODate), "0", unit}); });
 }
 
 void AcadenceManager::updateHabit(Habit *h)
 {
-    QVector<QStringList> data = readCsv("habits.csv");
-    for (auto &row : data)
-    {
-        if (row.size() >= 11 && row[0].toInt() == h->id)
-        {
-            int current = 0;
-            if (auto *dh = dynamic_cast<DurationHabit *>(h))
-                current = dh->currentMinutes;
-            else if (auto *ch = dynamic_cast<CountHabit *>(h))
-                current = ch->currentCount;
+    ACADENCE_PROFILE("AcadenceManager::updateHabit");
+    int current = 0;
+    if (auto *dh = dynamic_cast<DurationHabit *>(h))
+        current = dh->currentMinutes;
+    else if (auto *ch = dynamic_cast<CountHabit *>(h))
+        current = ch->currentCount;
 
-            row[6] = QString::number(current);
-            row[7] = QString::number(h->streak);
-            row[8] = h->lastUpdated.toString(Qt::ISODate);
-            row[9] = h->isCompleted ? "1" : "0";
-        }
-    }
-    writeCsv("habits.csv", data);
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        for (auto &row : batch.rows("habits.csv"))
+        {
+            if (row.size() >= 11 && row[0].toInt() == h->id)
+            {
+                row[6] = QString::number(current);
+                row[7] = QString::number(h->streak);
+                row[8] = h->lastUpdated.toString(Qt::ISODate);
+                row[9] = h->isCompleted ? "1" : "0";
+            }
+        } });
 }
 
 void AcadenceManager::deleteHabit(int id)
 {
-    QVector<QStringList> data = readCsv("habits.csv");
-    QVector<QStringList> newData;
-    for (const auto &row : data)
-    {
-        if (row.size() > 0 && row[0].toInt() != id)
+    ACADENCE_PROFILE("AcadenceManager::deleteHabit");
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        CsvTable &data = batch.rows("habits.csv");
+        CsvTable newData;
+        for (const auto &row : data)
         {
-            newData.append(row);
+            if (row.size() > 0 && row[0].toInt() != id)
+            {
+                newData.append(row);
+            }
         }
-    }
-    writeCsv("habits.csv", newData);
+        data = newData; });
 }
 
 // Routine
 QVector<RoutineSession> AcadenceManager::getRoutineForDay(QString day, int semester)
 {
+    ACADENCE_PROFILE("AcadenceManager::getRoutineForDay");
     WeeklyRoutine weeklyRoutine;
-    QVector<QStringList> data = readCsv("routine.csv");
+    QVector<QStringList> data = table("routine.csv");
     // Format: Day,Start,End,Code,Name,Room,Instructor,Semester
     for (const auto &row : data)
     {
@@ -554,14 +713,17 @@ QVector<RoutineSession> AcadenceManager::getRoutineForDay(QString day, int semes
 
 void AcadenceManager::addRoutineItem(QString day, QString start, QString end, QString code, QString name, QString room, QString instructor, int semester)
 {
-    appendCsv("routine.csv", {day, start, end, code, name, room, instructor, QString::number(semester)});
+    ACADENCE_PROFILE("AcadenceManager::addRoutineItem");
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 { batch.append("routine.csv", {day, start, end, code, name, room, instructor, QString::number(semester)}); });
 }
 
 // Academics / Teacher Tools
 QVector<Course *> AcadenceManager::getTeacherCourses(int teacherId)
 {
+    ACADENCE_PROFILE("AcadenceManager::getTeacherCourses");
     QVector<Course *> courses;
-    QVector<QStringList> data = readCsv("courses.csv");
+    QVector<QStringList> data = table("courses.csv");
     // Format: ID,Code,Name,TeacherID,Semester,Credits
     for (const auto &row : data)
     {
@@ -575,7 +737,8 @@ QVector<Course *> AcadenceManager::getTeacherCourses(int teacherId)
 
 Course *AcadenceManager::getCourse(int id)
 {
-    QVector<QStringList> data = readCsv("courses.csv");
+    ACADENCE_PROFILE("AcadenceManager::getCourse");
+    QVector<QStringList> data = table("courses.csv");
     for (const auto &row : data)
     {
         if (row.size() >= 6 && row[0].toInt() == id)
@@ -588,22 +751,23 @@ Course *AcadenceManager::getCourse(int id)
 
 QVector<Assessment> AcadenceManager::getAssessments()
 {
+    ACADENCE_PROFILE("AcadenceManager::getAssessments");
     QVector<Assessment> list;
-    QVector<QStringList> data = readCsv("assessments.csv");
+    // Read both tables from one snapshot so names always match the assessments
+    DataSnapshotPtr snap = DataStore::instance().snapshot({"assessments.csv", "courses.csv"});
+    QHash<int, QString> courseNames;
+    for (const auto &row : snap->table("courses.csv")->getRows())
+    {
+        if (row.size() >= 6)
+            courseNames.insert(row[0].toInt(), row[2]);
+    }
+
     // Format: ID,CourseID,Title,Type,Date,MaxMarks
-    for (const auto &row : data)
+    for (const auto &row : snap->table("assessments.csv")->getRows())
     {
         if (row.size() >= 6)
         {
-            // Need course name
-            QString courseName = "Unknown";
-            Course *c = getCourse(row[1].toInt());
-            if (c)
-            {
-                courseName = c->getName();
-                delete c;
-            }
-
+            QString courseName = courseNames.value(row[1].toInt(), "Unknown");
             list.append(Assessment(row[0].toInt(), row[1].toInt(), courseName, row[2], row[3], row[4], row[5].toInt()));
         }
     }
@@ -612,17 +776,31 @@ QVector<Assessment> AcadenceManager::getAssessments()
 
 void AcadenceManager::addAssessment(int courseId, QString title, QString type, QString date, int maxMarks)
 {
-    QVector<QStringList> data = readCsv("assessments.csv");
-    int maxId = 0;
-    for (const auto &row : data)
-        if (row.size() > 0)
-            maxId = std::max(maxId, row[0].toInt());
-
-    appendCsv("assessments.csv", {QString::number(maxId + 1), QString::number(courseId), title, type, date, QString::number(maxMarks)});
+    ACADENCE_PROFILE("AcadenceManager::addAssessment");
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        int maxId = maxIdOf(batch.peek("assessments.csv"));
+        batch.append("assessments.csv", {QString::number(maxId + 1), QString::number(courseId), title, type, date, QString::number(maxMarks)}); });
 }
 
 QVector<AttendanceRecord> AcadenceManager::getStudentAttendance(int studentId)
 {
+    ACADENCE_PROFILE("AcadenceManager::getStudentAttendance");
+    std::shared_ptr<StorageBackend> backend = DataStore::instance().backend();
+    if (backend->isRemote())
+    {
+        // Summarised by the server from tables this client never loads
+        QByteArray request;
+        QDataStream out(&request, QIODevice::WriteOnly);
+        out << qint32(studentId);
+        QByteArray reply = backend->query(Protocol::StudentAttendance, request);
+        QDataStream in(reply);
+        QVector<AttendanceRecord> records = Protocol::readAttendance(in);
+        if (in.status() != QDataStream::Ok)
+            throw Acadence::FileException("Malformed attendance from acadence-server");
+        return records;
+    }
+
     QVector<AttendanceRecord> records;
     Student *s = getStudent(studentId);
     if (!s)
@@ -631,7 +809,7 @@ QVector<AttendanceRecord> AcadenceManager::getStudentAttendance(int studentId)
     delete s;
 
     // Get all courses for this semester
-    QVector<QStringList> courseData = readCsv("courses.csv");
+    QVector<QStringList> courseData = table("courses.csv");
     QVector<int> courseIds;
     QMap<int, QString> courseNames;
     for (const auto &row : courseData)
@@ -645,9 +823,7 @@ QVector<AttendanceRecord> AcadenceManager::getStudentAttendance(int studentId)
     }
 
     // Process each course
-    QVector<QStringList> attData = readCsv("attendance.csv");
-    QVector<QStringList> gradeData = readCsv("grades.csv");
-    QVector<Assessment> assessments = getAssessments();
+    QVector<QStringList> attData = table("attendance.csv");
 
     for (int cid : courseIds)
     {
@@ -670,24 +846,10 @@ QVector<AttendanceRecord> AcadenceManager::getStudentAttendance(int studentId)
         int attendedClasses = attended;
 
         // Grades
-        double totalMarksObtained = 0;
-        double totalMaxMarks = 0;
-        for (const auto &a : assessments)
-        {
-            if (a.getCourseId() == cid)
-            {
-                totalMaxMarks += a.getMaxMarks();
-                // Find grade
-                for (const auto &grow : gradeData)
-                {
-                    if (grow.size() >= 3 && grow[0].toInt() == studentId && grow[1].toInt() == a.getId())
-                    {
-                        totalMarksObtained += grow[2].toDouble();
-                        break;
-                    }
-                }
-            }
-        }
+        std::shared_ptr<const Gradebook> book = Gradebook::forCourse(cid);
+        int row = book->findStudent(studentId);
+        double totalMarksObtained = row >= 0 ? book->totalMarks(row) : 0;
+        double totalMaxMarks = book->totalMaxMarks();
         records.append(AttendanceRecord(courseNames[cid], totalClasses, attendedClasses, totalMarksObtained, totalMaxMarks));
     }
     return records;
@@ -695,8 +857,9 @@ QVector<AttendanceRecord> AcadenceManager::getStudentAttendance(int studentId)
 
 QVector<Student *> AcadenceManager::getStudentsBySemester(int semester)
 {
+    ACADENCE_PROFILE("AcadenceManager::getStudentsBySemester");
     QVector<Student *> list;
-    QVector<QStringList> data = readCsv("students.csv");
+    QVector<QStringList> data = table("students.csv");
     for (const auto &row : data)
     {
         if (row.size() >= 6 && row[5].toInt() == semester)
@@ -709,7 +872,8 @@ QVector<Student *> AcadenceManager::getStudentsBySemester(int semester)
 
 double AcadenceManager::getGrade(int studentId, int assessmentId)
 {
-    QVector<QStringList> data = readCsv("grades.csv");
+    ACADENCE_PROFILE("AcadenceManager::getGrade");
+    QVector<QStringList> data = rowsWhere("grades.csv", 0, QString::number(studentId));
     for (const auto &row : data)
     {
         if (row.size() >= 3 && row[0].toInt() == studentId && row[1].toInt() == assessmentId)
@@ -722,27 +886,44 @@ double AcadenceManager::getGrade(int studentId, int assessmentId)
 
 void AcadenceManager::addGrade(int studentId, int assessmentId, double marks)
 {
-    QVector<QStringList> data = readCsv("grades.csv");
-    bool found = false;
-    for (auto &row : data)
-    {
-        if (row.size() >= 3 && row[0].toInt() == studentId && row[1].toInt() == assessmentId)
+    ACADENCE_PROFILE("AcadenceManager::addGrade");
+    addGrades(assessmentId, {{studentId, marks}});
+}
+
+void AcadenceManager::addGrades(int assessmentId, const QMap<int, double> &marksByStudent)
+{
+    ACADENCE_PROFILE("AcadenceManager::addGrades");
+    quint64 version = DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        CsvTable &data = batch.rows("grades.csv");
+        QSet<int> found;
+        for (auto &row : data)
         {
-            row[2] = QString::number(marks);
-            found = true;
+            if (row.size() >= 3 && row[1].toInt() == assessmentId)
+            {
+                int sid = row[0].toInt();
+                auto it = marksByStudent.constFind(sid);
+                if (it != marksByStudent.constEnd())
+                {
+                    row[2] = QString::number(it.value());
+                    found.insert(sid);
+                }
+            }
         }
-    }
-    if (!found)
-    {
-        data.append({QString::number(studentId), QString::number(assessmentId), QString::number(marks)});
-    }
-    writeCsv("grades.csv", data);
+        for (auto it = marksByStudent.constBegin(); it != marksByStudent.constEnd(); ++it)
+        {
+            if (!found.contains(it.key()))
+                data.append({QString::number(it.key()), QString::number(assessmentId), QString::number(it.value())});
+        } });
+    Gradebook::recordMarks(assessmentId, marksByStudent, version);
+    GpaEngine::instance().recordGrades(assessmentId, marksByStudent, version);
 }
 
 QVector<QString> AcadenceManager::getCourseDates(int courseId)
 {
+    ACADENCE_PROFILE("AcadenceManager::getCourseDates");
     QSet<QString> dates;
-    QVector<QStringList> data = readCsv("attendance.csv");
+    QVector<QStringList> data = table("attendance.csv");
     for (const auto &row : data)
     {
         if (row.size() >= 4 && row[0].toInt() == courseId)
@@ -757,7 +938,8 @@ QVector<QString> AcadenceManager::getCourseDates(int courseId)
 
 bool AcadenceManager::isPresent(int courseId, int studentId, QString date)
 {
-    QVector<QStringList> data = readCsv("attendance.csv");
+    ACADENCE_PROFILE("AcadenceManager::isPresent");
+    QVector<QStringList> data = table("attendance.csv");
     for (const auto &row : data)
     {
         if (row.size() >= 4 && row[0].toInt() == courseId && row[1].toInt() == studentId && row[2] == date)
@@ -770,43 +952,81 @@ bool AcadenceManager::isPresent(int courseId, int studentId, QString date)
 
 void AcadenceManager::markAttendance(int courseId, int studentId, QString date, bool present)
 {
-    QVector<QStringList> data = readCsv("attendance.csv");
-    bool found = false;
-    for (auto &row : data)
-    {
-        if (row.size() >= 4 && row[0].toInt() == courseId && row[1].toInt() == studentId && row[2] == date)
+    ACADENCE_PROFILE("AcadenceManager::markAttendance");
+    saveAttendance(courseId, {AttendanceEntry(studentId, date, present)});
+}
+
+void AcadenceManager::saveAttendance(int courseId, const QVector<AttendanceEntry> &entries)
+{
+    ACADENCE_PROFILE("AcadenceManager::saveAttendance");
+    // Key: "studentId|date" -> index into entries
+    QHash<QString, int> pending;
+    for (int i = 0; i < entries.size(); ++i)
+        pending.insert(QString::number(entries[i].getStudentId()) + "|" + entries[i].getDate(), i);
+
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        CsvTable &data = batch.rows("attendance.csv");
+        QSet<int> found;
+        for (auto &row : data)
         {
-            row[3] = present ? "1" : "0";
-            found = true;
+            if (row.size() >= 4 && row[0].toInt() == courseId)
+            {
+                auto it = pending.constFind(QString::number(row[1].toInt()) + "|" + row[2]);
+                if (it != pending.constEnd())
+                {
+                    row[3] = entries[it.value()].isPresent() ? "1" : "0";
+                    found.insert(it.value());
+                }
+            }
         }
-    }
-    if (!found)
-    {
-        data.append({QString::number(courseId), QString::number(studentId), date, present ? "1" : "0"});
-    }
-    writeCsv("attendance.csv", data);
+        for (int i = 0; i < entries.size(); ++i)
+        {
+            if (!found.contains(i))
+                data.append({QString::number(courseId), QString::number(entries[i].getStudentId()), entries[i].getDate(),
+                             entries[i].isPresent() ? "1" : "0"});
+        } });
 }
 
 // Queries
 QVector<Query> AcadenceManager::getQueries(int userId, QString role)
 {
+    ACADENCE_PROFILE("AcadenceManager::getQueries");
+    // Format: ID,StudentID,Question,Answer; students only see their own
+    if (role == "Student")
+        return getQueries(userId, role, rowsWhere("queries.csv", 1, QString::number(userId)));
+    return getQueries(userId, role, table("queries.csv"));
+}
+
+QVector<Query> AcadenceManager::getQueries(int userId, QString role, const QVector<QStringList> &data)
+{
+    ACADENCE_PROFILE("AcadenceManager::getQueries(rows)");
     QVector<Query> list;
-    QVector<QStringList> data = readCsv("queries.csv");
+    bool everyone = role == "Teacher" || role == "Admin";
+
+    // Names looked up once: a student only sees their own queries
+    QHash<int, QString> names;
+    if (everyone)
+    {
+        // Format: ID,Name,...
+        for (const auto &row : table("students.csv"))
+            if (row.size() >= 2)
+                names.insert(row[0].toInt(), row[1]);
+    }
+    else if (Student *s = getStudent(userId))
+    {
+        names.insert(userId, s->getName());
+        delete s;
+    }
+
     // Format: ID,StudentID,Question,Answer
     for (const auto &row : data)
     {
         if (row.size() >= 4)
         {
-            if (role == "Teacher" || role == "Admin" || row[1].toInt() == userId)
+            if (everyone || row[1].toInt() == userId)
             {
-                QString sName = "Student";
-                Student *s = getStudent(row[1].toInt());
-                if (s)
-                {
-                    sName = s->getName();
-                    delete s;
-                }
-
+                QString sName = names.value(row[1].toInt(), "Student");
                 list.append(Query(row[0].toInt(), row[1].toInt(), sName, row[2], row[3]));
             }
         }
@@ -816,25 +1036,23 @@ QVector<Query> AcadenceManager::getQueries(int userId, QString role)
 
 void AcadenceManager::addQuery(int userId, QString question)
 {
-    QVector<QStringList> data = readCsv("queries.csv");
-    int maxId = 0;
-    for (const auto &row : data)
-        if (row.size() > 0)
-            maxId = std::max(maxId, row[0].toInt());
-
-    appendCsv("queries.csv", {QString::number(maxId + 1), QString::number(userId), question, ""});
+    ACADENCE_PROFILE("AcadenceManager::addQuery");
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        int maxId = maxIdOf(batch.peek("queries.csv"));
+        batch.append("queries.csv", {QString::number(maxId + 1), QString::number(userId), question, ""}); });
 }
 
 void AcadenceManager::answerQuery(int queryId, QString answer)
 {
-    QVector<QStringList> data = readCsv("queries.csv");
-    QVector<QString> lines;
-    for (auto &row : data)
-    {
-        if (row.size() >= 4 && row[0].toInt() == queryId)
+    ACADENCE_PROFILE("AcadenceManager::answerQuery");
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        for (auto &row : batch.rows("queries.csv"))
         {
-            row[3] = answer;
-        }
-    }
-    writeCsv("queries.csv", data);
+            if (row.size() >= 4 && row[0].toInt() == queryId)
+            {
+                row[3] = answer;
+            }
+        } });
 }
\ No newline at end of file
@@ -2,14 +2,17 @@
 #define ACADENCEMANAGER_HPP
 
 #include <QString>
+#include <QIODevice>
 #include <QVector>
 #include <QDate>
+#include <QMap>
 #include "student.hpp"
 #include "teacher.hpp"
 #include "course.hpp"
 #include "habit.hpp"
 #include "routine.hpp"
 #include "exceptions.hpp"
+#include "datastore.hpp"
 
 // Classes replacing structs for OOP compliance
 class Notice
@@ -112,6 +115,21 @@ public:
     QString getAnswer() const { return answer; }
 };
 
+class AttendanceEntry
+{
+private:
+    int studentId;
+    QString date;
+    bool present;
+
+public:
+    AttendanceEntry(int sid, QString d, bool p) : studentId(sid), date(d), present(p) {}
+
+    int getStudentId() const { return studentId; }
+    QString getDate() const { return date; }
+    bool isPresent() const { return present; }
+};
+
 class DailyPrayerStatus
 {
 private:
@@ -137,14 +155,58 @@ class AcadenceManager
 public:
     AcadenceManager();
 
+    static QStringList parseCsvLine(const QString &line);
     static QVector<QStringList> readCsv(const QString &filename);
     static void writeCsv(const QString &filename, const QVector<QStringList> &data);
+    /**
+     * @brief Writes rows to an already open device, e.g. a QSaveFile.
+     */
+    static void writeCsv(QIODevice &device, const QVector<QStringList> &data);
+    static void appendCsv(const QString &filename, const QStringList &fields);
+    static void appendCsv(const QString &filename, const QVector<QStringList> &rows);
+
+    /**
+     * @brief Returns the in-memory rows of a table (loaded from disk on first use).
+     * Cheap: the rows are shared with the store's current snapshot.
+     */
+    static QVector<QStringList> table(const QString &filename);
+
+    /**
+     * @brief Rows of a table whose @p column holds @p value.
+     *
+     * A client of acadence-server that has not loaded the table asks the
+     * server, so only the matching rows cross the socket and none are kept;
+     * otherwise the loaded table is filtered.
+     */
+    static QVector<QStringList> rowsWhere(const QString &filename, int column, const QString &value);
+
+    /**
+     * @brief Like rowsWhere() (every row if @p column is -1), but returns only
+     * @p limit rows from @p offset on, and in @p total how many match.
+     */
+    static QVector<QStringList> selectRows(const QString &filename, int column, const QString &value, int offset, int limit, int &total);
+
+    /**
+     * @brief Replaces a whole table and persists it as one atomic commit.
+     */
+    static void saveTable(const QString &filename, const QVector<QStringList> &data);
+
+    /**
+     * @brief Names of every CSV table the application uses.
+     */
+    static QStringList dataFiles();
+
+    /**
+     * @brief Ensures that the necessary text files exist for data storage.
+     */
+    static void initializeDataFiles();
 
     QString login(const QString &username, const QString &password, int &userId);
     bool changePassword(int userId, const QString &role, const QString &oldPass, const QString &newPass);
 
     // Dashboard
     QVector<Notice> getNotices();
+    QVector<Notice> getNotices(const QVector<QStringList> &rows); ///< Parses the given notices.csv rows only.
     void addNotice(const QString &content, const QString &author);
     QString getNextClass(int userId);
     QString getDashboardStats(int userId, QString role);
@@ -181,13 +243,16 @@ public:
 
     double getGrade(int studentId, int assessmentId);
     void addGrade(int studentId, int assessmentId, double marks);
+    void addGrades(int assessmentId, const QMap<int, double> &marksByStudent); ///< Saves all marks as one batch.
 
     QVector<QString> getCourseDates(int courseId);
     bool isPresent(int courseId, int studentId, QString date);
     void markAttendance(int courseId, int studentId, QString date, bool present);
+    void saveAttendance(int courseId, const QVector<AttendanceEntry> &entries); ///< Saves a whole sheet as one batch.
 
     // Queries
     QVector<Query> getQueries(int userId, QString role);
+    QVector<Query> getQueries(int userId, QString role, const QVector<QStringList> &rows); ///< Parses the given queries.csv rows only.
     void addQuery(int userId, QString question);
     void answerQuery(int queryId, QString answer);
 };
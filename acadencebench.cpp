@@ -0,0 +1,291 @@
+/**
+ * @file acadencebench.cpp
+ * @brief Benchmarks of the data layer on synthetic datasets of several sizes.
+ *
+ * Each benchmark runs once per scale (students / attendance rows); a scale's
+ * dataset is generated on first use into a temporary directory by
+ * DataGenerator, so the benchmarks see the data acadence-gen writes. Select
+ * scales with ACADENCE_BENCH_SCALES (e.g. "1k-100k,10k-1M") and get
+ * machine-readable results with Qt Test's output options, e.g.
+ * "acadence_bench -o results.csv,csv" or "-o results.xml,xml".
+ */
+#include "academicmanager.hpp"
+#include "admintablemodel.hpp"
+#include "attendancemodel.hpp"
+#include "datagenerator.hpp"
+#include "datastore.hpp"
+#include "tableregistry.hpp"
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QtTest>
+#include <iterator>
+
+// Shape of DataGenerator's datasets
+static const int SEMESTERS = 8;                 ///< Student s is in semester (s - 1) % 8 + 1.
+static const int FIRST_COURSE = 1;              ///< First course of semester 1; every semester-1 student takes it.
+static const int FIRST_ASSESSMENT = 1;          ///< First assessment of FIRST_COURSE.
+static const double COURSES_PER_STUDENT = 2.63; ///< Average enrolment: six courses of Zipf-like sizes.
+
+static const int GRID_SAMPLE_STUDENTS = 4; ///< Roster rows built per isPresent() grid iteration.
+static const int ADMIN_SEARCH_ROWS = 500000; ///< Admin table size whose searches must answer within 50 ms.
+static const char *const ADMIN_NEEDLE = "1234"; ///< Matches some course and student IDs.
+static const quint64 SEED = 20240101;
+
+namespace
+{
+    struct Scale
+    {
+        const char *tag;
+        int students;
+        qint64 attendanceRows;
+    };
+
+    const Scale SCALES[] = {{"1k-100k", 1000, 100000}, {"10k-1M", 10000, 1000000}, {"100k-10M", 100000, 10000000}};
+
+    /**
+     * @brief Writes a scale's dataset with DataGenerator (the generator
+     * acadence-gen uses), with a term just long enough for about the
+     * scale's attendance row count: courses meet twice a week.
+     */
+    void generate(const Scale &scale, const QString &directory)
+    {
+        GeneratorOptions options;
+        options.seed = SEED;
+        options.students = scale.students;
+        options.weeks = qMax(1, qRound(scale.attendanceRows / (scale.students * COURSES_PER_STUDENT * 2)));
+        DataGenerator(options).run(directory);
+    }
+
+    /**
+     * @brief Shows up to ADMIN_SEARCH_ROWS attendance rows in @p model and
+     * waits until its search index is built.
+     */
+    bool showIndexedAttendance(AdminTableModel &model)
+    {
+        QSignalSpy ready(&model, &AdminTableModel::indexReady);
+        CsvTable rows = AcadenceManager::table("attendance.csv");
+        model.setTable("attendance", rows.mid(0, ADMIN_SEARCH_ROWS), TableRegistry::find("attendance")->getHeaders());
+        return ready.wait(60000);
+    }
+}
+
+class AcadenceBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void readCsv_data() { addScales(); }
+    void readCsv();
+    void writeCsv_data() { addScales(); }
+    void writeCsv();
+    void login_data() { addScales(); }
+    void login();
+    void studentAttendance_data() { addScales(); }
+    void studentAttendance();
+    void routineForDay_data() { addScales(); }
+    void routineForDay();
+    void attendanceGridIsPresent_data() { addScales(); }
+    void attendanceGridIsPresent();
+    void attendanceSheet_data() { addScales(); }
+    void attendanceSheet();
+    void saveGrades_data() { addScales(); }
+    void saveGrades();
+    void adminTableLoad_data() { addScales(); }
+    void adminTableLoad();
+    void adminSearch_data() { addScales(); }
+    void adminSearch();
+    void adminRemoveRow_data() { addScales(); }
+    void adminRemoveRow();
+
+private:
+    void addScales();
+
+    /**
+     * @brief Switches to the current row's dataset, generating it if needed,
+     * with nothing loaded in the DataStore.
+     */
+    const Scale &useScale();
+
+    QTemporaryDir root;
+    QString current;
+};
+
+void AcadenceBench::initTestCase()
+{
+    QVERIFY(root.isValid());
+}
+
+void AcadenceBench::addScales()
+{
+    QStringList selected = qEnvironmentVariable("ACADENCE_BENCH_SCALES").split(',', Qt::SkipEmptyParts);
+    QTest::addColumn<int>("scale");
+    for (int i = 0; i < int(std::size(SCALES)); ++i)
+        if (selected.isEmpty() || selected.contains(SCALES[i].tag))
+            QTest::newRow(SCALES[i].tag) << i;
+}
+
+const Scale &AcadenceBench::useScale()
+{
+    QFETCH(int, scale);
+    const Scale &s = SCALES[scale];
+    QString dir = root.filePath(s.tag);
+    if (current != dir)
+    {
+        if (!QFile::exists(dir + "/students.csv"))
+            generate(s, dir);
+        QDir::setCurrent(dir);
+        current = dir;
+    }
+    DataStore::instance().reset();
+    return s;
+}
+
+void AcadenceBench::readCsv()
+{
+    useScale();
+    QBENCHMARK
+    {
+        QVector<QStringList> rows = AcadenceManager::readCsv("attendance.csv");
+        QVERIFY(!rows.isEmpty());
+    }
+}
+
+void AcadenceBench::writeCsv()
+{
+    useScale();
+    QVector<QStringList> rows = AcadenceManager::readCsv("attendance.csv");
+    QBENCHMARK
+    {
+        AcadenceManager::writeCsv("attendance-copy.csv", rows);
+    }
+    QFile::remove("attendance-copy.csv");
+}
+
+void AcadenceBench::login()
+{
+    const Scale &s = useScale();
+    AcadenceManager manager;
+    QString last = "s" + QString::number(s.students); // DataGenerator's username and password
+    int userId = -1;
+    manager.login(last, last, userId); // Loads the tables
+    QBENCHMARK
+    {
+        QCOMPARE(manager.login(last, last, userId), QString("Student"));
+    }
+}
+
+void AcadenceBench::studentAttendance()
+{
+    const Scale &s = useScale();
+    AcadenceManager manager;
+    manager.getStudentAttendance(s.students);
+    QBENCHMARK
+    {
+        QVERIFY(!manager.getStudentAttendance(s.students).isEmpty()); // Every student takes their semester's first course
+    }
+}
+
+void AcadenceBench::routineForDay()
+{
+    useScale();
+    AcadenceManager manager;
+    manager.getRoutineForDay("Monday", 1);
+    QBENCHMARK
+    {
+        manager.getRoutineForDay("Monday", 1);
+    }
+}
+
+void AcadenceBench::attendanceGridIsPresent()
+{
+    useScale();
+    AcadenceManager manager;
+    int course = FIRST_COURSE;
+    QVector<QString> dates = manager.getCourseDates(course);
+    QBENCHMARK
+    {
+        int present = 0;
+        for (int i = 0; i < GRID_SAMPLE_STUDENTS; ++i)
+            for (const QString &date : dates)
+                present += manager.isPresent(course, 1 + i * SEMESTERS, date);
+        Q_UNUSED(present);
+    }
+}
+
+void AcadenceBench::attendanceSheet()
+{
+    const Scale &s = useScale();
+    AcadenceManager manager;
+    int course = FIRST_COURSE;
+    QStringList dates = manager.getCourseDates(course);
+    QVector<AttendanceStudent> roster;
+    for (int id = 1; id <= s.students; id += SEMESTERS)
+        roster.append({id, "Student " + QString::number(id)});
+    CsvTable attendance = AcadenceManager::table("attendance.csv");
+    QBENCHMARK
+    {
+        AttendanceTableModel model;
+        model.setSheet(course, roster, dates, attendance);
+        QCOMPARE(model.rowCount(), roster.size());
+    }
+}
+
+void AcadenceBench::saveGrades()
+{
+    const Scale &s = useScale();
+    AcadenceManager manager;
+    int assessment = FIRST_ASSESSMENT;
+    QMap<int, double> marks;
+    for (int id = 1; id <= s.students; id += SEMESTERS)
+        marks.insert(id, id % 21);
+    manager.addGrades(assessment, marks);
+    QBENCHMARK
+    {
+        manager.addGrades(assessment, marks);
+    }
+}
+
+void AcadenceBench::adminTableLoad()
+{
+    useScale();
+    QStringList headers = TableRegistry::find("students")->getHeaders();
+    AdminTableModel model;
+    QBENCHMARK
+    {
+        DataStore::instance().invalidate("students.csv");
+        model.setTable("students", AcadenceManager::table("students.csv"), headers);
+    }
+    QThreadPool::globalInstance()->waitForDone(); // Search index builds
+}
+
+void AcadenceBench::adminSearch()
+{
+    useScale();
+    AdminTableModel model;
+    QVERIFY(showIndexedAttendance(model));
+    QBENCHMARK
+    {
+        model.search(ADMIN_NEEDLE).waitForFinished();
+    }
+}
+
+void AcadenceBench::adminRemoveRow()
+{
+    useScale();
+    AdminTableModel model;
+    QVERIFY(showIndexedAttendance(model));
+    QBENCHMARK
+    {
+        // The first row: every later row moves up, in the table and in the index
+        model.fetchUpTo(1);
+        model.removeRows(0, 1);
+    }
+    QCOMPARE(model.search(ADMIN_NEEDLE).result(), TrigramIndex::scan(model.getRows(), ADMIN_NEEDLE));
+}
+
+QTEST_GUILESS_MAIN(AcadenceBench)
+#include "acadencebench.moc"
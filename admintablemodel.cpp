@@ -0,0 +1,505 @@
+/**
+ * @file admintablemodel.cpp
+ * @brief Table model backing the admin panel.
+ */
+#include "admintablemodel.hpp"
+#include "tablefile.hpp"
+#include "tracer.hpp"
+#include <QtConcurrent>
+#include <algorithm>
+
+static const int FETCH_BATCH = 1000; ///< Rows handed to the view per fetchMore().
+
+AdminTableModel::AdminTableModel(QObject *parent)
+    : QAbstractTableModel(parent), columns(0), fetched(0), pendingRewrite(false), indexStale(false)
+{
+    connect(&indexWatcher, &QFutureWatcherBase::finished, this, &AdminTableModel::onIndexBuilt);
+}
+
+void AdminTableModel::setTable(const QString &name, const CsvTable &data, const QStringList &titles)
+{
+    ACADENCE_TRACE_DETAIL("model", "AdminTableModel::reset", name);
+    beginResetModel();
+    tableName = name;
+    rows = data; // Shares the snapshot's rows; nothing is copied until an edit
+    headers = titles;
+    columns = headers.size();
+    for (const auto &row : rows)
+        columns = std::max(columns, static_cast<int>(row.size()));
+    fetched = std::min(static_cast<int>(rows.size()), FETCH_BATCH);
+    order.clear();
+    rank.clear();
+    sortedColumns.clear();
+    keyColumns = TableFile::keyColumns(name + ".csv");
+    pendingChanges.clear();
+    pendingUpserts.clear();
+    pendingRewrite = false;
+    endResetModel();
+
+    searchIndex.reset();
+    buildIndex();
+}
+
+void AdminTableModel::buildIndex()
+{
+    // One build at a time; a build that saw outdated rows is redone when it ends
+    if (indexWatcher.isRunning())
+    {
+        indexStale = true;
+        return;
+    }
+    indexStale = false;
+    CsvTable data = rows;
+    indexWatcher.setFuture(QtConcurrent::run([data]()
+                                             { return std::make_shared<TrigramIndex>(data); }));
+}
+
+void AdminTableModel::onIndexBuilt()
+{
+    if (indexStale)
+    {
+        buildIndex();
+        return;
+    }
+    searchIndex = indexWatcher.result();
+    emit indexReady();
+}
+
+QFuture<QVector<int>> AdminTableModel::search(const QString &query) const
+{
+    // "column:text" scopes the search when the prefix names a column
+    QString needle = query.trimmed();
+    int column = -1;
+    int colon = needle.indexOf(':');
+    if (colon > 0)
+    {
+        QString title = needle.left(colon).remove(' ').toLower();
+        for (int c = 0; c < headers.size(); ++c)
+        {
+            if (QString(headers[c]).remove(' ').toLower() == title)
+            {
+                column = c;
+                needle = needle.mid(colon + 1).trimmed();
+                break;
+            }
+        }
+    }
+
+    if (searchIndex)
+    {
+        std::shared_ptr<TrigramIndex> idx = searchIndex;
+        return QtConcurrent::run([idx, needle, column]()
+                                 { return idx->search(needle, column); });
+    }
+    CsvTable data = rows; // Index not ready yet
+    return QtConcurrent::run([data, needle, column]()
+                             { return TrigramIndex::scan(data, needle, column); });
+}
+
+void AdminTableModel::recordUpsert(const QStringList &before, const QStringList &after)
+{
+    if (keyColumns.isEmpty())
+    {
+        // Rows without a key can only be appended; anything else needs a full save
+        if (before.isEmpty())
+            pendingChanges.append(TableChange(TableChange::Append, after));
+        else
+            pendingRewrite = true;
+        return;
+    }
+
+    QString key = TableChange::rowKey(after, keyColumns);
+    if (!before.isEmpty() && TableChange::rowKey(before, keyColumns) != key)
+        recordDelete(before); // The key itself was edited
+
+    // Repeated edits of one row collapse into a single Upsert
+    auto it = pendingUpserts.constFind(key);
+    if (it != pendingUpserts.constEnd())
+    {
+        pendingChanges[it.value()] = TableChange(TableChange::Upsert, after);
+        return;
+    }
+    pendingUpserts.insert(key, pendingChanges.size());
+    pendingChanges.append(TableChange(TableChange::Upsert, after));
+}
+
+void AdminTableModel::recordDelete(const QStringList &row)
+{
+    if (keyColumns.isEmpty())
+    {
+        pendingRewrite = true;
+        return;
+    }
+
+    QString key = TableChange::rowKey(row, keyColumns);
+    auto it = pendingUpserts.find(key);
+    if (it != pendingUpserts.end())
+    {
+        pendingChanges[it.value()] = TableChange(TableChange::None);
+        pendingUpserts.erase(it);
+    }
+    QStringList keyValues;
+    for (int c : keyColumns)
+        keyValues << row.value(c).trimmed();
+    pendingChanges.append(TableChange(TableChange::Delete, keyValues));
+}
+
+QVector<TableChange> AdminTableModel::takePendingChanges(bool &rewrite)
+{
+    rewrite = pendingRewrite;
+    QVector<TableChange> changes;
+    changes.swap(pendingChanges);
+    pendingUpserts.clear();
+    pendingRewrite = false;
+    return changes;
+}
+
+int AdminTableModel::findRow(int column, const QString &value, int exceptRow) const
+{
+    int except = exceptRow >= 0 ? storageRow(exceptRow) : -1;
+    for (int i = 0; i < rows.size(); ++i)
+    {
+        if (i != except && rows[i].value(column) == value)
+            return viewRow(i);
+    }
+    return -1;
+}
+
+void AdminTableModel::sort(int column, Qt::SortOrder sortOrder)
+{
+    QVector<int> next;
+    if (column >= 0 && column < columns)
+    {
+        auto it = sortedColumns.find(column);
+        if (it == sortedColumns.end())
+        {
+            const TableDescriptor *schema = TableRegistry::find(tableName);
+            const ColumnDescriptor *desc = schema ? schema->column(column) : nullptr;
+            SortedColumn sorted;
+            sorted.rows = SortKeys::sort(rows, column, desc ? desc->type : ColumnType::Text, sorted.present);
+            it = sortedColumns.insert(column, sorted);
+        }
+        next = it->rows;
+        if (sortOrder == Qt::DescendingOrder)
+            std::reverse(next.begin(), next.begin() + it->present); // Blank cells stay last
+    }
+    setOrder(next);
+}
+
+void AdminTableModel::setOrder(const QVector<int> &viewOrder)
+{
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    // Selection and current cell follow their rows to the new positions
+    const QModelIndexList before = persistentIndexList();
+    QVector<int> stored;
+    stored.reserve(before.size());
+    for (const QModelIndex &idx : before)
+        stored.append(storageRow(idx.row()));
+
+    order = viewOrder;
+    rank.clear();
+    if (!order.isEmpty())
+    {
+        rank.resize(order.size());
+        for (int i = 0; i < order.size(); ++i)
+            rank[order[i]] = i;
+    }
+
+    QModelIndexList after;
+    after.reserve(before.size());
+    for (int i = 0; i < before.size(); ++i)
+    {
+        int row = viewRow(stored[i]);
+        after.append(row < fetched ? index(row, before[i].column()) : QModelIndex());
+    }
+    changePersistentIndexList(before, after);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void AdminTableModel::appendRow(const QStringList &row)
+{
+    columns = std::max(columns, static_cast<int>(row.size()));
+    recordUpsert({}, row);
+    if (searchIndex)
+        searchIndex->appendRow(row);
+    else
+        indexStale = true;
+
+    // Every column gained a value; sorted rows stay put and the new one goes last
+    sortedColumns.clear();
+    auto store = [this, &row]()
+    {
+        rows.append(row);
+        if (!order.isEmpty())
+        {
+            rank.append(order.size());
+            order.append(rows.size() - 1);
+        }
+    };
+
+    // The new row is the last one in any order, so the rest are fetched first:
+    // added past the fetched rows, it would not show until the view got there
+    fetchUpTo(static_cast<int>(rows.size()));
+    beginInsertRows(QModelIndex(), fetched, fetched);
+    store();
+    fetched++;
+    endInsertRows();
+    emit edited();
+}
+
+void AdminTableModel::fetchUpTo(int count)
+{
+    count = std::min(count, static_cast<int>(rows.size()));
+    if (count <= fetched)
+        return;
+    beginInsertRows(QModelIndex(), fetched, count - 1);
+    fetched = count;
+    endInsertRows();
+}
+
+int AdminTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : fetched;
+}
+
+int AdminTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : columns;
+}
+
+QVariant AdminTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+        return QVariant();
+    return rows[storageRow(index.row())].value(index.column());
+}
+
+bool AdminTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || role != Qt::EditRole)
+        return false;
+
+    int stored = storageRow(index.row());
+    QStringList &row = rows[stored];
+    QString text = value.toString();
+    if (row.value(index.column()) == text)
+        return false;
+    QStringList before = row;
+    while (row.size() < columns)
+        row.append(""); // Edited rows are saved at full width
+    row[index.column()] = text;
+    recordUpsert(before, row);
+    if (searchIndex)
+        searchIndex->updateRow(stored, row);
+    else
+        indexStale = true;
+    sortedColumns.remove(index.column()); // The edited row keeps its place until the next sort
+
+    emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
+    emit edited();
+    return true;
+}
+
+QVariant AdminTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section < headers.size())
+        return headers[section];
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+Qt::ItemFlags AdminTableModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    return QAbstractTableModel::flags(index) | Qt::ItemIsEditable;
+}
+
+bool AdminTableModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+    if (parent.isValid() || row < 0 || count <= 0 || row + count > fetched)
+        return false;
+    QVector<int> removed;
+    for (int i = row; i < row + count; ++i)
+    {
+        removed.append(storageRow(i));
+        recordDelete(rows[removed.last()]);
+    }
+    std::sort(removed.begin(), removed.end());
+
+    beginRemoveRows(parent, row, row + count - 1);
+    if (order.isEmpty())
+    {
+        rows.remove(row, count);
+    }
+    else
+    {
+        // Sorted rows may be scattered in storage; the rest shift down past them
+        for (int i = removed.size() - 1; i >= 0; --i)
+            rows.remove(removed[i]);
+        order.remove(row, count);
+        rank.resize(order.size());
+        for (int i = 0; i < order.size(); ++i)
+        {
+            order[i] -= static_cast<int>(std::lower_bound(removed.begin(), removed.end(), order[i]) - removed.begin());
+            rank[order[i]] = i;
+        }
+    }
+    fetched -= count;
+    endRemoveRows();
+    sortedColumns.clear();
+
+    if (searchIndex)
+        searchIndex->removeRows(removed);
+    else
+        indexStale = true;
+    emit edited();
+    return true;
+}
+
+bool AdminTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && fetched < rows.size();
+}
+
+void AdminTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
+    int count = std::min(static_cast<int>(rows.size()) - fetched, FETCH_BATCH);
+    if (count <= 0)
+        return;
+    beginInsertRows(QModelIndex(), fetched, fetched + count - 1);
+    fetched += count;
+    endInsertRows();
+}
+
+// ========================== FILTER PROXY ==========================
+
+AdminFilterProxyModel::AdminFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent), table(nullptr), lastMatch(-2), active(false) {}
+
+void AdminFilterProxyModel::setSourceModel(QAbstractItemModel *model)
+{
+    table = qobject_cast<AdminTableModel *>(model);
+    QSortFilterProxyModel::setSourceModel(model);
+    if (table)
+    {
+        connect(table, &QAbstractItemModel::rowsAboutToBeRemoved, this, &AdminFilterProxyModel::onRowsAboutToBeRemoved);
+        connect(table, &QAbstractItemModel::rowsRemoved, this, &AdminFilterProxyModel::onRowsRemoved);
+        connect(table, &QAbstractItemModel::layoutChanged, this, [this]()
+                { lastMatch = -2; });
+    }
+}
+
+void AdminFilterProxyModel::setMatches(const QVector<int> &rows)
+{
+    matchRows = rows;
+    lastMatch = -2;
+    int size = rows.isEmpty() ? 0 : rows.last() + 1;
+    matches = QBitArray(size);
+    for (int row : rows)
+        matches.setBit(row);
+    active = true;
+    invalidateFilter();
+    if (canFetchMore(QModelIndex()))
+        fetchMore(QModelIndex());
+}
+
+void AdminFilterProxyModel::clearMatches()
+{
+    if (!active)
+        return;
+    matchRows.clear();
+    matches.clear();
+    active = false;
+    invalidateFilter();
+}
+
+void AdminFilterProxyModel::sort(int column, Qt::SortOrder order)
+{
+    if (sourceModel())
+        sourceModel()->sort(column, order);
+}
+
+bool AdminFilterProxyModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!active || !table)
+        return QSortFilterProxyModel::canFetchMore(parent);
+    if (parent.isValid())
+        return false;
+    if (lastMatch == -2)
+    {
+        lastMatch = -1;
+        for (int row : matchRows)
+            lastMatch = std::max(lastMatch, table->viewRow(row));
+    }
+    return lastMatch >= table->rowCount();
+}
+
+void AdminFilterProxyModel::fetchMore(const QModelIndex &parent)
+{
+    if (!active || !table)
+    {
+        QSortFilterProxyModel::fetchMore(parent);
+        return;
+    }
+    if (parent.isValid())
+        return;
+
+    // Expose rows up to the FETCH_BATCH-th match not shown yet, and no further
+    int fetched = table->rowCount();
+    QVector<int> pending;
+    for (int row : matchRows)
+    {
+        int view = table->viewRow(row);
+        if (view >= fetched)
+            pending.append(view);
+    }
+    if (pending.isEmpty())
+        return;
+    auto page = pending.begin() + std::min<qsizetype>(pending.size(), FETCH_BATCH) - 1;
+    std::nth_element(pending.begin(), page, pending.end());
+    table->fetchUpTo(*page + 1);
+}
+
+void AdminFilterProxyModel::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    // Model rows are view rows; the matches refer to stored rows, which shift too
+    removing.clear();
+    if (parent.isValid() || !active)
+        return;
+    for (int i = first; i <= last; ++i)
+        removing.append(table->storageRow(i));
+    std::sort(removing.begin(), removing.end());
+}
+
+void AdminFilterProxyModel::onRowsRemoved()
+{
+    if (removing.isEmpty())
+        return;
+    QVector<int> kept;
+    kept.reserve(matchRows.size());
+    for (int row : matchRows)
+    {
+        auto below = std::lower_bound(removing.begin(), removing.end(), row);
+        if (below == removing.end() || *below != row)
+            kept.append(row - static_cast<int>(below - removing.begin()));
+    }
+    removing.clear();
+
+    matchRows = kept;
+    lastMatch = -2;
+    matches = QBitArray(kept.isEmpty() ? 0 : kept.last() + 1);
+    for (int row : kept)
+        matches.setBit(row);
+}
+
+bool AdminFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &) const
+{
+    if (!active)
+        return true;
+    int row = table ? table->storageRow(sourceRow) : sourceRow;
+    return row < matches.size() && matches.testBit(row);
+}
@@ -0,0 +1,225 @@
+#ifndef ADMINTABLEMODEL_HPP
+#define ADMINTABLEMODEL_HPP
+
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+#include <QStringList>
+#include <QBitArray>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QHash>
+#include <memory>
+#include "datastore.hpp"
+#include "trigramindex.hpp"
+#include "sortkeys.hpp"
+
+/**
+ * @brief Editable table model over the rows of one CSV table.
+ *
+ * Cells are served straight from the table's rows (shared with the
+ * DataStore snapshot until the first edit), so no per-cell objects are
+ * created. Rows are exposed to views in batches through canFetchMore() /
+ * fetchMore(), which keeps switching to a very large table instant.
+ *
+ * A TrigramIndex of the table is built in the background and kept up to
+ * date as cells are edited, so search() does not scan the table.
+ *
+ * sort() orders the whole table (not only the fetched rows) by typed keys
+ * and only permutes the rows shown; the stored order, which is what gets
+ * saved, never changes. Model rows are therefore "view rows", mapped to
+ * positions in getRows() by storageRow().
+ */
+class AdminTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit AdminTableModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Shows another table.
+     * @param tableName Table name without extension (e.g. "students").
+     * @param rows The table's rows.
+     * @param headers Column titles; missing ones are numbered.
+     */
+    void setTable(const QString &tableName, const CsvTable &rows, const QStringList &headers);
+
+    QString getTableName() const { return tableName; }
+
+    /**
+     * @brief All rows in stored order, including those not fetched by the view yet.
+     */
+    const CsvTable &getRows() const { return rows; }
+
+    /**
+     * @brief Position in getRows() of the row shown at model row @p viewRow.
+     */
+    int storageRow(int viewRow) const { return order.isEmpty() ? viewRow : order[viewRow]; }
+
+    /**
+     * @brief Model row showing the row at position @p storageRow of getRows().
+     */
+    int viewRow(int storageRow) const { return rank.isEmpty() ? storageRow : rank[storageRow]; }
+
+    /**
+     * @brief Finds the first row (in stored order) whose column equals @p value.
+     * @param exceptRow Model row to skip, e.g. the one being edited.
+     * @return Its model row, or -1.
+     */
+    int findRow(int column, const QString &value, int exceptRow = -1) const;
+
+    /**
+     * @brief Appends a row at the end of the table and exposes every row up
+     * to it, so views show it straight away (as their last row).
+     */
+    void appendRow(const QStringList &row);
+
+    /**
+     * @brief Makes sure at least @p count rows are exposed to views.
+     */
+    void fetchUpTo(int count);
+
+    /**
+     * @brief True if cells, rows or deletions have not been taken for saving yet.
+     */
+    bool hasPendingChanges() const { return !pendingChanges.isEmpty() || pendingRewrite; }
+
+    /**
+     * @brief Hands over the edits made since the last call, coalesced per row,
+     * in the form DataBatch::apply() accepts.
+     * @param rewrite Set to true if they cannot be described row by row
+     * (tables without key columns); the caller must then save all rows.
+     */
+    QVector<TableChange> takePendingChanges(bool &rewrite);
+
+    /**
+     * @brief Starts a search on a worker thread.
+     *
+     * "column:text" (column title, case and spaces ignored, e.g. "dept:CSE")
+     * searches one column; anything else searches all of them.
+     * @return Future yielding the matching positions in getRows(), ascending.
+     */
+    QFuture<QVector<int>> search(const QString &query) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+
+    /**
+     * @brief Shows the rows ordered by @p column, or in stored order if it is -1.
+     *
+     * The ascending order of a column is kept until a cell of it changes,
+     * so flipping the direction or returning to a column costs no sorting.
+     */
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+signals:
+    /**
+     * @brief Emitted after a cell was changed or a row added or removed.
+     */
+    void edited();
+
+    /**
+     * @brief Emitted when the search index has been (re)built.
+     */
+    void indexReady();
+
+private slots:
+    void onIndexBuilt();
+
+private:
+    void buildIndex();
+    void recordUpsert(const QStringList &before, const QStringList &after);
+    void recordDelete(const QStringList &row);
+    void setOrder(const QVector<int> &viewOrder);
+
+    QString tableName;
+    CsvTable rows;
+    QStringList headers;
+    int columns; ///< Widest row or header count, whichever is larger.
+    int fetched; ///< Rows exposed to views so far.
+
+    QVector<int> order; ///< View row -> storage row; empty when shown in stored order.
+    QVector<int> rank;  ///< Storage row -> view row; empty when shown in stored order.
+
+    /**
+     * @brief Ascending order of one column, blank cells last.
+     */
+    struct SortedColumn
+    {
+        QVector<int> rows;
+        int present; ///< Rows with a value, at the front of rows.
+    };
+    QHash<int, SortedColumn> sortedColumns; ///< Dropped when the column changes.
+
+    QVector<int> keyColumns;             ///< Empty for tables without a key.
+    QVector<TableChange> pendingChanges; ///< Unsaved changes in order.
+    QHash<QString, int> pendingUpserts;  ///< Row key -> its Upsert in pendingChanges.
+    bool pendingRewrite;                 ///< An edit that only a full save can persist.
+
+    std::shared_ptr<TrigramIndex> searchIndex; ///< Null while being built.
+    QFutureWatcher<std::shared_ptr<TrigramIndex>> indexWatcher;
+    bool indexStale; ///< Rows changed while the index was being built.
+};
+
+/**
+ * @brief Shows only the rows found by the last AdminTableModel::search().
+ *
+ * Matches are kept as stored positions, so the source model only has to
+ * expose the rows up to the next page of matches: fetching through the
+ * proxy asks the AdminTableModel for just enough rows to show that many
+ * more matches, however far down the table they are.
+ */
+class AdminFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit AdminFilterProxyModel(QObject *parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel *model) override;
+
+    /**
+     * @brief Shows only the given rows, fetching the first page of them.
+     * @param rows Ascending positions in AdminTableModel::getRows(), as
+     * returned by AdminTableModel::search(); they stay valid when the
+     * table is re-sorted.
+     */
+    void setMatches(const QVector<int> &rows);
+
+    /**
+     * @brief Shows every row again.
+     */
+    void clearMatches();
+
+    /**
+     * @brief Passes sorting on to the AdminTableModel, which sees every
+     * row rather than just the fetched ones.
+     */
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private slots:
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onRowsRemoved();
+
+private:
+    AdminTableModel *table;
+    QVector<int> matchRows;   ///< Matching stored rows, ascending.
+    QBitArray matches;        ///< One bit per stored row.
+    QVector<int> removing;    ///< Stored rows being removed, ascending.
+    mutable int lastMatch;    ///< Highest model row of a match; -2 until computed.
+    bool active;
+};
+
+#endif // ADMINTABLEMODEL_HPP
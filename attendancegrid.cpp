@@ -0,0 +1,178 @@
+/**
+ * @file attendancegrid.cpp
+ * @brief Attendance sheet view painted from the model's bit matrix.
+ */
+#include "attendancegrid.hpp"
+#include "attendancemodel.hpp"
+#include <QHeaderView>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QRect>
+
+static const int MARK_SIZE = 16;   ///< Check box mark, logical pixels.
+static const int DATE_WIDTH = 100; ///< Fits a yyyy-MM-dd header.
+
+// ---------------------------------------------------------------------------
+// AttendanceDelegate
+// ---------------------------------------------------------------------------
+
+AttendanceDelegate::AttendanceDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
+
+QPixmap AttendanceDelegate::mark(bool present, const QColor &color, qreal dpr) const
+{
+    quint64 key = (quint64(present) << 48) | (quint64(color.rgba()) << 16) | quint16(qRound(dpr * 100));
+    auto it = marks.constFind(key);
+    if (it != marks.constEnd())
+        return *it;
+
+    QPixmap pixmap(QSize(MARK_SIZE, MARK_SIZE) * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+    QPainter p(&pixmap);
+    p.setRenderHint(QPainter::Antialiasing);
+    QColor box = color;
+    box.setAlphaF(present ? 1.0 : 0.4);
+    p.setPen(QPen(box, 1.5));
+    p.setBrush(Qt::NoBrush);
+    p.drawRoundedRect(QRectF(1, 1, MARK_SIZE - 2, MARK_SIZE - 2), 3, 3);
+    if (present)
+    {
+        p.setPen(QPen(color, 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+        p.drawPolyline(QPolygonF({QPointF(4, 8.5), QPointF(7, 11.5), QPointF(12, 5)}));
+    }
+    p.end();
+
+    marks.insert(key, pixmap);
+    return pixmap;
+}
+
+void AttendanceDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    auto sheet = qobject_cast<const AttendanceTableModel *>(index.model());
+    if (!sheet || index.column() < AttendanceTableModel::FIRST_DATE_COLUMN)
+    {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    bool selected = option.state & QStyle::State_Selected;
+    if (selected)
+        painter->fillRect(option.rect, option.palette.highlight());
+    QColor color = selected ? option.palette.highlightedText().color() : option.palette.text().color();
+    QPixmap pixmap = mark(sheet->isPresent(index.row(), index.column() - AttendanceTableModel::FIRST_DATE_COLUMN),
+                          color, painter->device()->devicePixelRatioF());
+    QRect target(0, 0, MARK_SIZE, MARK_SIZE);
+    target.moveCenter(option.rect.center());
+    painter->drawPixmap(target.topLeft(), pixmap);
+}
+
+QSize AttendanceDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if (index.column() >= AttendanceTableModel::FIRST_DATE_COLUMN)
+        return QSize(DATE_WIDTH, MARK_SIZE + 8);
+    return QStyledItemDelegate::sizeHint(option, index);
+}
+
+bool AttendanceDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (index.column() < AttendanceTableModel::FIRST_DATE_COLUMN)
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+
+    // The view only reports a release on the cell that was pressed; Shift and Ctrl clicks just select
+    if (event->type() == QEvent::MouseButtonRelease)
+    {
+        auto mouse = static_cast<QMouseEvent *>(event);
+        if (mouse->button() != Qt::LeftButton || (mouse->modifiers() & (Qt::ShiftModifier | Qt::ControlModifier)))
+            return false;
+        bool present = index.data(Qt::CheckStateRole).toInt() == Qt::Checked;
+        return model->setData(index, int(present ? Qt::Unchecked : Qt::Checked), Qt::CheckStateRole);
+    }
+    return event->type() == QEvent::MouseButtonDblClick; // Two quick clicks toggle twice, nothing more
+}
+
+// ---------------------------------------------------------------------------
+// AttendanceGrid
+// ---------------------------------------------------------------------------
+
+AttendanceGrid::AttendanceGrid(QWidget *parent) : QTableView(parent)
+{
+    setItemDelegate(new AttendanceDelegate(this));
+    setSelectionBehavior(QAbstractItemView::SelectItems);
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setWordWrap(false);
+
+    verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    verticalHeader()->setDefaultSectionSize(qMax(MARK_SIZE, fontMetrics().height()) + 12);
+    horizontalHeader()->setDefaultSectionSize(DATE_WIDTH);
+}
+
+void AttendanceGrid::setModel(QAbstractItemModel *model)
+{
+    QTableView::setModel(model);
+    sizeInfoColumns();
+    if (model)
+        connect(model, &QAbstractItemModel::modelReset, this, &AttendanceGrid::sizeInfoColumns);
+}
+
+void AttendanceGrid::sizeInfoColumns()
+{
+    // ID, Name, %, Total
+    setColumnWidth(0, 70);
+    setColumnWidth(1, 220);
+    setColumnWidth(2, 80);
+    setColumnWidth(3, 80);
+}
+
+void AttendanceGrid::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_Space && qobject_cast<AttendanceTableModel *>(model()))
+    {
+        toggleSelection(event->modifiers().testFlag(Qt::ControlModifier), event->modifiers().testFlag(Qt::ShiftModifier));
+        event->accept();
+        return;
+    }
+    QTableView::keyPressEvent(event);
+}
+
+void AttendanceGrid::toggleSelection(bool wholeColumns, bool wholeRows)
+{
+    auto sheet = qobject_cast<AttendanceTableModel *>(model());
+    int rows = sheet->rowCount();
+    int dates = sheet->getDates().size();
+    if (rows == 0 || dates == 0)
+        return;
+
+    // Blocks as (date, row) rectangles; the selection, or the current cell if nothing is selected
+    QVector<QRect> blocks;
+    QItemSelection selection = selectionModel()->selection();
+    if (selection.isEmpty() && currentIndex().isValid())
+        selection.select(currentIndex(), currentIndex());
+    for (const QItemSelectionRange &range : selection)
+    {
+        int top = wholeColumns ? 0 : range.top();
+        int bottom = wholeColumns ? rows - 1 : range.bottom();
+        int left = wholeRows ? 0 : range.left() - AttendanceTableModel::FIRST_DATE_COLUMN;
+        int right = wholeRows ? dates - 1 : range.right() - AttendanceTableModel::FIRST_DATE_COLUMN;
+        left = qMax(left, 0);
+        if (right >= left)
+            blocks.append(QRect(QPoint(left, top), QPoint(right, bottom)));
+    }
+    if (blocks.isEmpty())
+        return;
+
+    // Everything present already: clear it; otherwise mark it all present
+    qint64 cells = 0;
+    qint64 present = 0;
+    for (const QRect &b : blocks)
+    {
+        cells += qint64(b.width()) * b.height();
+        present += sheet->countPresent(b.top(), b.bottom(), b.left(), b.right());
+    }
+    bool mark = present < cells;
+    for (const QRect &b : blocks)
+        sheet->setRange(b.top(), b.bottom(), b.left(), b.right(), mark);
+}
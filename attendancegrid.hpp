@@ -0,0 +1,55 @@
+#ifndef ATTENDANCEGRID_HPP
+#define ATTENDANCEGRID_HPP
+
+#include <QHash>
+#include <QPixmap>
+#include <QStyledItemDelegate>
+#include <QTableView>
+
+/**
+ * @brief Paints the date cells of an AttendanceTableModel straight from
+ * its bit matrix: one cached pixmap per mark, color and pixel ratio,
+ * instead of a styled check box per cell. A click on a cell toggles it.
+ */
+class AttendanceDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit AttendanceDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+private:
+    QPixmap mark(bool present, const QColor &color, qreal dpr) const;
+
+    mutable QHash<quint64, QPixmap> marks; ///< (present, color, dpr) -> pixmap.
+};
+
+/**
+ * @brief Table view for the attendance sheet.
+ *
+ * Rows have a fixed height and columns a default width, so scrolling
+ * never measures cells. Any block of cells can be selected (clicking a header selects a
+ * whole date or student); Space marks the selection present, or absent if
+ * it already is, Ctrl+Space does the same for the whole date columns of
+ * the selection and Shift+Space for the whole student rows.
+ */
+class AttendanceGrid : public QTableView
+{
+    Q_OBJECT
+public:
+    explicit AttendanceGrid(QWidget *parent = nullptr);
+
+    void setModel(QAbstractItemModel *model) override;
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    void toggleSelection(bool wholeColumns, bool wholeRows);
+    void sizeInfoColumns();
+};
+
+#endif // ATTENDANCEGRID_HPP
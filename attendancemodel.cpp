@@ -0,0 +1,363 @@
+/**
+ * @file attendancemodel.cpp
+ * @brief Attendance sheet model over a bit matrix.
+ */
+#include "attendancemodel.hpp"
+#include "tracer.hpp"
+#include <QHash>
+#include <QSet>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <utility>
+
+void AttendanceTableModel::Sheet::set(int row, int date, bool on)
+{
+    quint64 &word = bits[row * stride + date / 64];
+    quint64 mask = quint64(1) << (date % 64);
+    if (bool(word & mask) == on)
+        return;
+    word ^= mask;
+    present[row] += on ? 1 : -1;
+}
+
+void AttendanceTableModel::Sheet::insertDates(int at, const QStringList &added)
+{
+    int count = added.size();
+    int nextStride = strideFor(dates.size() + count);
+    QVector<quint64> next(students.size() * nextStride, 0);
+    for (int r = 0; r < students.size(); ++r)
+    {
+        for (int d = 0; d < dates.size(); ++d)
+        {
+            if (!get(r, d))
+                continue;
+            int moved = d < at ? d : d + count;
+            next[r * nextStride + moved / 64] |= quint64(1) << (moved % 64);
+        }
+    }
+    for (int i = 0; i < count; ++i)
+        dates.insert(at + i, added[i]);
+    stride = nextStride;
+    bits = std::move(next);
+}
+
+void AttendanceTableModel::Sheet::removeStudents(int at, int count)
+{
+    students.remove(at, count);
+    bits.remove(at * stride, count * stride);
+    present.remove(at, count);
+}
+
+void AttendanceTableModel::Sheet::insertStudents(int at, const Sheet &from, int first, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        students.insert(at + i, from.students[first + i]);
+        present.insert(at + i, from.present[first + i]);
+    }
+    bits.insert(at * stride, count * stride, 0);
+    std::copy(from.bits.begin() + first * stride, from.bits.begin() + (first + count) * stride, bits.begin() + at * stride);
+}
+
+AttendanceTableModel::AttendanceTableModel(QObject *parent) : QAbstractTableModel(parent), courseId(0) {}
+
+void AttendanceTableModel::setSheet(int id, const QVector<AttendanceStudent> &students, const QStringList &dates, const CsvTable &attendance)
+{
+    ACADENCE_TRACE("model", "AttendanceTableModel::setSheet");
+    Sheet next;
+    next.students = students;
+    next.dates = dates;
+    next.stride = strideFor(dates.size());
+    next.bits.fill(0, students.size() * next.stride);
+    next.present.fill(0, students.size());
+
+    QHash<int, int> rowOf;
+    for (int r = 0; r < students.size(); ++r)
+        rowOf.insert(students[r].id, r);
+    QHash<QString, int> columnOf;
+    for (int d = 0; d < dates.size(); ++d)
+        columnOf.insert(dates[d], d);
+
+    // Format: CourseID,StudentID,Date,Present
+    for (const auto &row : attendance)
+    {
+        if (row.size() < 4 || row[3] != "1" || row[0].toInt() != id)
+            continue;
+        int r = rowOf.value(row[1].toInt(), -1);
+        int d = columnOf.value(row[2], -1);
+        if (r >= 0 && d >= 0)
+            next.set(r, d, true);
+    }
+
+    if (id != courseId)
+    {
+        courseId = id;
+        reset(std::move(next));
+        return;
+    }
+
+    // Dates: new ones are inserted; a date that disappeared or moved resets
+    int kept = 0;
+    for (const QString &date : next.dates)
+        if (kept < sheet.dates.size() && sheet.dates[kept] == date)
+            ++kept;
+    if (kept != sheet.dates.size())
+    {
+        reset(std::move(next));
+        return;
+    }
+    bool totalsChanged = next.dates.size() != sheet.dates.size();
+    for (int d = 0; d < next.dates.size();)
+    {
+        if (d < sheet.dates.size() && sheet.dates[d] == next.dates[d])
+        {
+            ++d;
+            continue;
+        }
+        int end = d;
+        while (end + 1 < next.dates.size() && !(d < sheet.dates.size() && sheet.dates[d] == next.dates[end + 1]))
+            ++end;
+        beginInsertColumns(QModelIndex(), FIRST_DATE_COLUMN + d, FIRST_DATE_COLUMN + end);
+        sheet.insertDates(d, next.dates.mid(d, end - d + 1));
+        endInsertColumns();
+        d = end + 1;
+    }
+
+    // Students who left are removed, one signal per run
+    QSet<int> nextIds;
+    for (const AttendanceStudent &s : next.students)
+        nextIds.insert(s.id);
+    for (int end = sheet.students.size() - 1; end >= 0;)
+    {
+        if (nextIds.contains(sheet.students[end].id))
+        {
+            --end;
+            continue;
+        }
+        int begin = end;
+        while (begin > 0 && !nextIds.contains(sheet.students[begin - 1].id))
+            --begin;
+        beginRemoveRows(QModelIndex(), begin, end);
+        sheet.removeStudents(begin, end - begin + 1);
+        endRemoveRows();
+        end = begin - 1;
+    }
+
+    // The students who stayed must be in the same order; the roster is sorted by ID
+    QSet<int> shown;
+    for (const AttendanceStudent &s : sheet.students)
+        shown.insert(s.id);
+    int k = 0;
+    for (const AttendanceStudent &s : next.students)
+    {
+        if (!shown.contains(s.id))
+            continue;
+        if (sheet.students[k++].id != s.id)
+        {
+            reset(std::move(next));
+            return;
+        }
+    }
+
+    // New students are inserted with their cells
+    for (int r = 0; r < next.students.size();)
+    {
+        if (r < sheet.students.size() && sheet.students[r].id == next.students[r].id)
+        {
+            ++r;
+            continue;
+        }
+        int end = r;
+        while (end + 1 < next.students.size() && !shown.contains(next.students[end + 1].id))
+            ++end;
+        beginInsertRows(QModelIndex(), r, end);
+        sheet.insertStudents(r, next, r, end - r + 1);
+        endInsertRows();
+        r = end + 1;
+    }
+
+    for (int r = 0; r < sheet.students.size(); ++r)
+        updateRow(r, next, totalsChanged);
+}
+
+void AttendanceTableModel::reset(Sheet next)
+{
+    ACADENCE_TRACE("model", "AttendanceTableModel::reset");
+    beginResetModel();
+    sheet = std::move(next);
+    endResetModel();
+}
+
+void AttendanceTableModel::updateRow(int row, const Sheet &next, bool totalsChanged)
+{
+    int first = -1;
+    int last = -1;
+    auto touch = [&](int column)
+    {
+        if (first < 0 || column < first)
+            first = column;
+        last = qMax(last, column);
+    };
+
+    if (sheet.students[row].name != next.students[row].name)
+    {
+        sheet.students[row].name = next.students[row].name;
+        touch(1);
+    }
+    for (int w = 0; w < sheet.stride; ++w)
+    {
+        quint64 &word = sheet.bits[row * sheet.stride + w];
+        quint64 changed = word ^ next.bits[row * next.stride + w];
+        if (!changed)
+            continue;
+        touch(FIRST_DATE_COLUMN + w * 64 + qCountTrailingZeroBits(changed));
+        touch(FIRST_DATE_COLUMN + w * 64 + 63 - qCountLeadingZeroBits(changed));
+        word ^= changed;
+    }
+    if (totalsChanged || sheet.present[row] != next.present[row])
+    {
+        sheet.present[row] = next.present[row];
+        touch(2);
+        touch(3);
+    }
+    if (first >= 0)
+        emit dataChanged(index(row, first), index(row, last));
+}
+
+void AttendanceTableModel::addDate(const QString &date)
+{
+    int at = sheet.dates.size();
+    beginInsertColumns(QModelIndex(), FIRST_DATE_COLUMN + at, FIRST_DATE_COLUMN + at);
+    sheet.insertDates(at, {date});
+    endInsertColumns();
+    if (!sheet.students.isEmpty())
+        emit dataChanged(index(0, 2), index(sheet.students.size() - 1, 3));
+}
+
+QVector<AttendanceEntry> AttendanceTableModel::entries() const
+{
+    QVector<AttendanceEntry> list;
+    list.reserve(sheet.dates.size() * sheet.students.size());
+    for (int d = 0; d < sheet.dates.size(); ++d)
+        for (int r = 0; r < sheet.students.size(); ++r)
+            list.append(AttendanceEntry(sheet.students[r].id, sheet.dates[d], sheet.get(r, d)));
+    return list;
+}
+
+int AttendanceTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : sheet.students.size();
+}
+
+int AttendanceTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : FIRST_DATE_COLUMN + sheet.dates.size();
+}
+
+QVariant AttendanceTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= sheet.students.size())
+        return QVariant();
+    int row = index.row();
+    int column = index.column();
+
+    if (column >= FIRST_DATE_COLUMN)
+    {
+        if (role == Qt::CheckStateRole)
+            return int(sheet.get(row, column - FIRST_DATE_COLUMN) ? Qt::Checked : Qt::Unchecked);
+        return QVariant();
+    }
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    int total = sheet.dates.size();
+    switch (column)
+    {
+    case 0:
+        return QString::number(sheet.students[row].id);
+    case 1:
+        return sheet.students[row].name;
+    case 2:
+        return QString::number(total == 0 ? 0.0 : (double)sheet.present[row] / total * 100.0, 'f', 1) + "%";
+    default:
+        return QString::number(sheet.present[row]) + "/" + QString::number(total);
+    }
+}
+
+QVariant AttendanceTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+        return QAbstractTableModel::headerData(section, orientation, role);
+    static const QStringList info = {"ID", "Name", "%", "Total"};
+    return section < FIRST_DATE_COLUMN ? info[section] : sheet.dates.value(section - FIRST_DATE_COLUMN);
+}
+
+Qt::ItemFlags AttendanceTableModel::flags(const QModelIndex &index) const
+{
+    Qt::ItemFlags f = QAbstractTableModel::flags(index);
+    if (index.isValid() && index.column() >= FIRST_DATE_COLUMN)
+        f |= Qt::ItemIsUserCheckable;
+    return f;
+}
+
+quint64 AttendanceTableModel::wordMask(int word, int firstDate, int lastDate)
+{
+    int from = qMax(firstDate - word * 64, 0);
+    int to = qMin(lastDate - word * 64, 63);
+    if (from > to)
+        return 0;
+    quint64 high = to == 63 ? ~quint64(0) : (quint64(1) << (to + 1)) - 1;
+    return high & ~((quint64(1) << from) - 1);
+}
+
+int AttendanceTableModel::countPresent(int firstRow, int lastRow, int firstDate, int lastDate) const
+{
+    int count = 0;
+    for (int r = firstRow; r <= lastRow; ++r)
+        for (int w = firstDate / 64; w <= lastDate / 64; ++w)
+            count += qPopulationCount(sheet.bits[r * sheet.stride + w] & wordMask(w, firstDate, lastDate));
+    return count;
+}
+
+void AttendanceTableModel::setRange(int firstRow, int lastRow, int firstDate, int lastDate, bool present)
+{
+    int changedFirst = -1;
+    int changedLast = -1;
+    for (int r = firstRow; r <= lastRow; ++r)
+    {
+        int delta = 0;
+        for (int w = firstDate / 64; w <= lastDate / 64; ++w)
+        {
+            quint64 &word = sheet.bits[r * sheet.stride + w];
+            quint64 mask = wordMask(w, firstDate, lastDate);
+            quint64 flipped = present ? (~word & mask) : (word & mask);
+            word ^= flipped;
+            delta += qPopulationCount(flipped);
+        }
+        if (delta == 0)
+            continue;
+        sheet.present[r] += present ? delta : -delta;
+        if (changedFirst < 0)
+            changedFirst = r;
+        changedLast = r;
+    }
+    if (changedFirst < 0)
+        return;
+    emit dataChanged(index(changedFirst, FIRST_DATE_COLUMN + firstDate), index(changedLast, FIRST_DATE_COLUMN + lastDate), {Qt::CheckStateRole});
+    emit dataChanged(index(changedFirst, 2), index(changedLast, 3), {Qt::DisplayRole});
+}
+
+bool AttendanceTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || role != Qt::CheckStateRole || index.column() < FIRST_DATE_COLUMN)
+        return false;
+    int row = index.row();
+    int date = index.column() - FIRST_DATE_COLUMN;
+    bool on = value.toInt() == Qt::Checked;
+    if (sheet.get(row, date) == on)
+        return true;
+    sheet.set(row, date, on);
+    emit dataChanged(index, index, {Qt::CheckStateRole});
+    emit dataChanged(this->index(row, 2), this->index(row, 3), {Qt::DisplayRole});
+    return true;
+}
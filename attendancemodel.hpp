@@ -0,0 +1,124 @@
+#ifndef ATTENDANCEMODEL_HPP
+#define ATTENDANCEMODEL_HPP
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+#include "academicmanager.hpp"
+#include "datastore.hpp"
+
+/**
+ * @brief A student listed on an attendance sheet.
+ */
+struct AttendanceStudent
+{
+    int id;
+    QString name;
+};
+
+/**
+ * @brief Attendance sheet of one course: ID, Name, %, Total, then one
+ * checkable column per class date.
+ *
+ * Presence is kept in a bit matrix (one row of 64-bit words per student)
+ * with a running count of classes attended per student, so toggling a
+ * cell or a block of cells (setRange()) updates the rows' % and Total
+ * with a population count of the changed bits instead of a recount.
+ *
+ * setSheet() for the course already shown is applied as differences:
+ * new dates and students are inserted, students who left are removed and
+ * cells that changed are reported with dataChanged(), so the view keeps
+ * its selection and scroll position. Another course resets the model.
+ */
+class AttendanceTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    static const int FIRST_DATE_COLUMN = 4;
+
+    explicit AttendanceTableModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Shows a course's sheet.
+     * @param dates Class dates, in column order.
+     * @param attendance Rows of attendance.csv; read once.
+     */
+    void setSheet(int courseId, const QVector<AttendanceStudent> &students, const QStringList &dates, const CsvTable &attendance);
+
+    /**
+     * @brief Appends a class date with nobody marked present.
+     */
+    void addDate(const QString &date);
+
+    int getCourseId() const { return courseId; }
+    const QStringList &getDates() const { return sheet.dates; }
+
+    bool isPresent(int row, int date) const { return sheet.get(row, date); }
+
+    /**
+     * @brief Number of students marked present in a block of the sheet.
+     * @param firstDate Date index (not column); the block is inclusive.
+     */
+    int countPresent(int firstRow, int lastRow, int firstDate, int lastDate) const;
+
+    /**
+     * @brief Marks a block of the sheet present or absent, with one
+     * dataChanged() for the cells and one for their rows' % and Total.
+     */
+    void setRange(int firstRow, int lastRow, int firstDate, int lastDate, bool present);
+
+    /**
+     * @brief Every cell of the sheet, date by date.
+     */
+    QVector<AttendanceEntry> entries() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+
+private:
+    struct Sheet
+    {
+        QVector<AttendanceStudent> students;
+        QStringList dates;
+        int stride = 1;        ///< Words per student row.
+        QVector<quint64> bits; ///< students x stride words.
+        QVector<int> present;  ///< Classes attended, per student.
+
+        bool get(int row, int date) const { return (bits[row * stride + date / 64] >> (date % 64)) & 1; }
+        void set(int row, int date, bool on);
+
+        /**
+         * @brief Inserts the @p added dates before column @p at, nobody present.
+         */
+        void insertDates(int at, const QStringList &added);
+        void removeStudents(int at, int count);
+
+        /**
+         * @brief Inserts @p count students of @p from, starting at @p first, before @p at.
+         */
+        void insertStudents(int at, const Sheet &from, int first, int count);
+    };
+
+    static int strideFor(int dates) { return qMax(1, (dates + 63) / 64); }
+
+    /**
+     * @brief Bits of word @p word that fall between two date indexes.
+     */
+    static quint64 wordMask(int word, int firstDate, int lastDate);
+    void reset(Sheet next);
+
+    /**
+     * @brief Takes a row's cells from @p next and reports those that changed.
+     * @param totalsChanged The number of dates changed, so % and Total did.
+     */
+    void updateRow(int row, const Sheet &next, bool totalsChanged);
+
+    int courseId;
+    Sheet sheet;
+};
+
+#endif // ATTENDANCEMODEL_HPP
@@ -0,0 +1,232 @@
+/**
+ * @file bulkimporter.cpp
+ * @brief Streaming, parallel-validated import of CSV files into admin tables.
+ */
+#include "bulkimporter.hpp"
+#include "academicmanager.hpp"
+#include "datastore.hpp"
+#include "exceptions.hpp"
+#include "tablefile.hpp"
+#include "tableregistry.hpp"
+#include <QDate>
+#include <QFile>
+#include <QSet>
+#include <QTextStream>
+#include <QTime>
+#include <QtConcurrent>
+#include <algorithm>
+
+static const int CHUNK_LINES = 4096; ///< Lines read and validated together.
+
+namespace
+{
+    struct ParsedLine
+    {
+        QStringList fields;
+        QString error;
+    };
+
+    struct Candidate
+    {
+        int line;
+        QStringList fields;
+    };
+
+    struct Issue
+    {
+        int line;
+        QString message;
+    };
+}
+
+BulkImporter::BulkImporter(const QString &tableName)
+    : tableName(tableName), schema(TableRegistry::find(tableName)),
+      usernameColumn(schema ? schema->columnWithRole(ColumnRole::Username) : -1),
+      idColumn(schema ? schema->columnWithRole(ColumnRole::Id) : -1)
+{
+}
+
+QString BulkImporter::parse(const QString &line, QStringList &fields) const
+{
+    fields = AcadenceManager::parseCsvLine(line);
+    for (QString &field : fields)
+        field = field.trimmed();
+    if (fields.size() != schema->columnCount)
+        return QString("Expected %1 fields, found %2.").arg(schema->columnCount).arg(fields.size());
+
+    for (int c = 0; c < fields.size(); ++c)
+    {
+        if (c == idColumn && fields[c].isEmpty())
+            continue; // Allocated on commit
+        QString error = schema->columns[c].validate(fields[c]);
+        if (!error.isEmpty())
+            return QString(schema->columns[c].title) + ": " + error;
+    }
+    return "";
+}
+
+bool BulkImporter::isHeader(const QStringList &fields) const
+{
+    // Titles fail to parse in every typed column; data rows parse in all of them
+    bool typed = false;
+    for (int c = 0; c < fields.size(); ++c)
+    {
+        const ColumnDescriptor *column = schema->column(c);
+        ColumnType type = column ? column->type : ColumnType::Text;
+        if (type == ColumnType::Text)
+            continue;
+        typed = true;
+        QString field = fields[c].trimmed();
+        bool ok = false;
+        if (type == ColumnType::Integer || type == ColumnType::Real)
+            field.toDouble(&ok);
+        else if (type == ColumnType::Date)
+            ok = QDate::fromString(field, Qt::ISODate).isValid();
+        else
+            ok = QTime::fromString(field, Qt::ISODate).isValid();
+        if (ok || field.isEmpty())
+            return false;
+    }
+    return typed;
+}
+
+ImportReport BulkImporter::run(const QString &path, const std::function<bool(int)> &progress)
+{
+    ImportReport report;
+    if (!schema || schema->columnCount == 0)
+        throw Acadence::Exception("Importing into " + tableName + " is not supported.");
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        throw Acadence::FileException("Failed to open file for reading: " + path);
+    QTextStream in(&file);
+    qint64 size = std::max<qint64>(1, file.size());
+
+    // --- Read and validate chunk by chunk ---
+    QVector<Candidate> candidates;
+    QVector<Issue> issues;
+    int lineNo = 0;
+    bool firstLine = true;
+    while (!in.atEnd())
+    {
+        QStringList lines;
+        QVector<int> numbers;
+        while (!in.atEnd() && lines.size() < CHUNK_LINES)
+        {
+            QString line = in.readLine();
+            ++lineNo;
+            if (line.trimmed().isEmpty())
+                continue;
+            lines.append(line);
+            numbers.append(lineNo);
+        }
+
+        QVector<ParsedLine> parsed = QtConcurrent::blockingMapped<QVector<ParsedLine>>(lines, [this](const QString &line)
+                                                                                       {
+            ParsedLine result;
+            result.error = parse(line, result.fields);
+            return result; });
+
+        for (int i = 0; i < parsed.size(); ++i)
+        {
+            if (firstLine)
+            {
+                firstLine = false;
+                if (isHeader(parsed[i].fields))
+                    continue;
+            }
+            if (parsed[i].error.isEmpty())
+                candidates.append({numbers[i], parsed[i].fields});
+            else
+                issues.append({numbers[i], parsed[i].error});
+        }
+
+        if (progress && !progress(static_cast<int>(file.pos() * 90 / size)))
+        {
+            report.cancelled = true;
+            return report;
+        }
+    }
+
+    // --- Check uniqueness, allocate IDs and commit in one transaction ---
+    QString fileName = tableName + ".csv";
+    QVector<int> keyColumns = TableFile::keyColumns(fileName);
+    QVector<Issue> conflicts;
+    if (!candidates.isEmpty())
+    {
+        DataStore::instance().commit([&](DataBatch &batch)
+                                     {
+            // Re-run on a conflicting commit, so everything starts over
+            conflicts.clear();
+            report.imported = 0;
+
+            const CsvTable &existing = batch.peek(fileName);
+            QSet<QString> keys;
+            if (!keyColumns.isEmpty())
+            {
+                keys.reserve(existing.size() + candidates.size());
+                for (const auto &row : existing)
+                    keys.insert(TableChange::rowKey(row, keyColumns));
+            }
+
+            // Usernames are unique across every table that has them
+            QSet<QString> usernames;
+            if (usernameColumn >= 0)
+            {
+                for (const TableDescriptor *users : TableRegistry::tables())
+                {
+                    int col = users->columnWithRole(ColumnRole::Username);
+                    if (col < 0)
+                        continue;
+                    for (const auto &row : batch.peek(users->getFileName()))
+                        usernames.insert(row.value(col));
+                }
+            }
+
+            // One block of IDs after the highest ID already used or given in the file
+            int nextId = 1;
+            if (idColumn >= 0)
+            {
+                for (const auto &row : existing)
+                    nextId = std::max(nextId, row.value(idColumn).toInt() + 1);
+                for (const auto &c : candidates)
+                    nextId = std::max(nextId, c.fields[idColumn].toInt() + 1);
+            }
+
+            for (const auto &c : candidates)
+            {
+                QStringList row = c.fields;
+                if (usernameColumn >= 0 && usernames.contains(row[usernameColumn]))
+                {
+                    conflicts.append({c.line, "Username '" + row[usernameColumn] + "' already taken."});
+                    continue;
+                }
+                if (idColumn >= 0 && row[idColumn].isEmpty())
+                    row[idColumn] = QString::number(nextId++);
+                else if (!keyColumns.isEmpty() && keys.contains(TableChange::rowKey(row, keyColumns)))
+                {
+                    QStringList key;
+                    for (int col : keyColumns)
+                        key << row[col];
+                    conflicts.append({c.line, "Duplicate of an existing row (" + key.join(", ") + ")."});
+                    continue;
+                }
+
+                if (!keyColumns.isEmpty())
+                    keys.insert(TableChange::rowKey(row, keyColumns));
+                if (usernameColumn >= 0)
+                    usernames.insert(row[usernameColumn]);
+                batch.append(fileName, row);
+                report.imported++;
+            } });
+    }
+    if (progress)
+        progress(100);
+
+    issues += conflicts;
+    std::sort(issues.begin(), issues.end(), [](const Issue &a, const Issue &b)
+              { return a.line < b.line; });
+    for (const auto &issue : issues)
+        report.errors.append(QString("Line %1: %2").arg(issue.line).arg(issue.message));
+    return report;
+}
@@ -0,0 +1,67 @@
+#ifndef BULKIMPORTER_HPP
+#define BULKIMPORTER_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "tableregistry.hpp"
+
+/**
+ * @brief Outcome of one BulkImporter::run().
+ */
+struct ImportReport
+{
+    int imported = 0;       ///< Rows committed.
+    QStringList errors;     ///< One "Line N: reason" per rejected row, in file order.
+    bool cancelled = false; ///< Stopped before anything was committed.
+    QString failure;        ///< Set by callers when the import could not run at all.
+};
+
+/**
+ * @brief Adds the rows of an external CSV file (e.g. a new batch's roster)
+ * to one admin table as a single commit.
+ *
+ * The file is read as a stream in chunks; each chunk is parsed and its
+ * fields checked on the global thread pool against the table's
+ * TableRegistry descriptor, the same rules the admin panel's editors
+ * enforce. Duplicate keys and usernames, against the stored tables and
+ * within the file, are found with hash sets. Rows with a blank ID get IDs
+ * from one block after the highest ID in use. Invalid rows are skipped and
+ * listed in the report; the rest are appended in one DataStore commit.
+ */
+class BulkImporter
+{
+public:
+    /**
+     * @param tableName Table name without extension (e.g. "students").
+     */
+    explicit BulkImporter(const QString &tableName);
+
+    /**
+     * @brief Imports a file. Blocks; run it off the GUI thread.
+     *
+     * A first line that looks like column titles is skipped.
+     * @param progress Called with 0-100 as the import advances; returning
+     * false cancels it, which is possible until the commit starts.
+     * @throws Acadence::FileException if the file cannot be read.
+     * @throws Acadence::Exception if the commit fails.
+     */
+    ImportReport run(const QString &path, const std::function<bool(int)> &progress = {});
+
+private:
+    /**
+     * @brief Parses and validates one line.
+     * @return The reason it is rejected, or an empty string.
+     */
+    QString parse(const QString &line, QStringList &fields) const;
+
+    bool isHeader(const QStringList &fields) const;
+
+    QString tableName;
+    const TableDescriptor *schema; ///< Null for an unknown table.
+    int usernameColumn;            ///< -1 unless the table holds user accounts.
+    int idColumn;                  ///< ID column that may be left blank, or -1.
+};
+
+#endif // BULKIMPORTER_HPP
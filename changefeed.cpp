@@ -0,0 +1,153 @@
+/**
+ * @file changefeed.cpp
+ * @brief In-process and cross-process delivery of table change events.
+ */
+#include "changefeed.hpp"
+#include "datastore.hpp"
+#include "protocol.hpp"
+#include "exceptions.hpp"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaMethod>
+
+static const int CONNECT_TIMEOUT_MS = 1000;
+static const QString SEQ_SUFFIX = ".seq";
+
+ChangeFeed &ChangeFeed::instance()
+{
+    static ChangeFeed feed;
+    return feed;
+}
+
+ChangeFeed::ChangeFeed() : watcher(new QFileSystemWatcher(this)), server(nullptr)
+{
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, &ChangeFeed::onFileChanged);
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, &ChangeFeed::onDirectoryChanged);
+}
+
+bool ChangeFeed::isObserved() const
+{
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&ChangeFeed::tableChanged);
+    return isSignalConnected(signal);
+}
+
+void ChangeFeed::publish(const QString &table, const QVector<TableChange> &changes, quint64 sequence)
+{
+    // Always deliver through the event loop: receivers may read the store,
+    // and the publisher may still hold its writer lock.
+    QMetaObject::invokeMethod(this, [this, table, changes, sequence]()
+                              { emit tableChanged(table, changes, sequence); }, Qt::QueuedConnection);
+}
+
+void ChangeFeed::refresh(const QString &table)
+{
+    try
+    {
+        DataStore::instance().refresh(table);
+    }
+    catch (const Acadence::Exception &)
+    {
+        // Table busy or server gone; the next notification retries
+    }
+}
+
+// ========================== FILES ==========================
+
+void ChangeFeed::watchFiles(const QStringList &tables)
+{
+    for (const QString &table : tables)
+        if (!watchedTables.contains(table))
+            watchedTables.append(table);
+    watchMissing();
+}
+
+void ChangeFeed::watchMissing()
+{
+    // A ".seq" file only exists after the first commit; until then watch the
+    // directory so we notice it being created.
+    bool missing = false;
+    QStringList watched = watcher->files();
+    for (const QString &table : watchedTables)
+    {
+        QString path = QDir::current().absoluteFilePath(table + SEQ_SUFFIX);
+        if (watched.contains(path))
+            continue;
+        if (QFile::exists(path))
+        {
+            watcher->addPath(path);
+            refresh(table);
+        }
+        else
+        {
+            missing = true;
+        }
+    }
+
+    QString dir = QDir::currentPath();
+    if (missing && !watcher->directories().contains(dir))
+        watcher->addPath(dir);
+    else if (!missing && watcher->directories().contains(dir))
+        watcher->removePath(dir);
+}
+
+void ChangeFeed::onFileChanged(const QString &path)
+{
+    QString table = QFileInfo(path).fileName();
+    table.chop(SEQ_SUFFIX.size());
+
+    // Our own commits land here too; refreshing is a no-op when the sequence matches
+    refresh(table);
+
+    if (!watcher->files().contains(path))
+        watchMissing(); // Some platforms drop the watch when a file is rewritten
+}
+
+void ChangeFeed::onDirectoryChanged(const QString &)
+{
+    watchMissing();
+}
+
+// ========================== SERVER ==========================
+
+bool ChangeFeed::watchServer(const QString &serverName)
+{
+    if (!server)
+    {
+        server = new QLocalSocket(this);
+        connect(server, &QLocalSocket::readyRead, this, &ChangeFeed::onServerReadyRead);
+    }
+    server->abort();
+    serverBuffer.clear();
+    server->connectToServer(serverName);
+    if (!server->waitForConnected(CONNECT_TIMEOUT_MS))
+        return false;
+    server->write(Protocol::frame(0, Protocol::Subscribe, QByteArray()));
+    return true;
+}
+
+void ChangeFeed::onServerReadyRead()
+{
+    serverBuffer += server->readAll();
+
+    quint32 id;
+    Protocol::Op op;
+    QByteArray body;
+    try
+    {
+        while (Protocol::takeFrame(serverBuffer, Protocol::MAX_REPLY_SIZE, id, op, body))
+        {
+            if (op != Protocol::Notify || body.isEmpty())
+                continue; // Subscription acknowledgement
+            QDataStream in(body);
+            QString table = Protocol::readString(in);
+            refresh(table);
+        }
+    }
+    catch (const Acadence::Exception &)
+    {
+        // The stream cannot be resynchronised; stop listening rather than misparse it
+        server->abort();
+        serverBuffer.clear();
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef CHANGEFEED_HPP
+#define CHANGEFEED_HPP
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+#include <QFileSystemWatcher>
+#include <QLocalSocket>
+#include "tablefile.hpp"
+
+/**
+ * @brief Row-level change notifications for the CSV tables.
+ *
+ * DataStore publishes the rows each commit or catch-up changed; views
+ * connect to tableChanged() and patch their widgets instead of re-reading
+ * whole tables. Changes made by other instances are noticed either by
+ * watching the tables' ".seq" files or, in client mode, by subscribing to
+ * acadence-server's push notifications.
+ *
+ * Create the feed from the GUI thread (call instance() early) so its
+ * signals are delivered by that thread's event loop.
+ */
+class ChangeFeed : public QObject
+{
+    Q_OBJECT
+public:
+    static ChangeFeed &instance();
+
+    /**
+     * @brief True if anything is connected to tableChanged(); when false the
+     * store skips computing row diffs.
+     */
+    bool isObserved() const;
+
+    /**
+     * @brief Queues a change event; safe to call from any thread, including
+     * under the store's writer lock.
+     * @param sequence Storage sequence of the table after the changes.
+     */
+    void publish(const QString &table, const QVector<TableChange> &changes, quint64 sequence);
+
+    /**
+     * @brief Picks up commits by other instances sharing the data directory.
+     */
+    void watchFiles(const QStringList &tables);
+
+    /**
+     * @brief Subscribes to acadence-server's notifications.
+     * @return False if the server cannot be reached.
+     */
+    bool watchServer(const QString &serverName);
+
+signals:
+    /**
+     * @brief Emitted after a table changed. Delete changes carry the key
+     * columns only (see TableFile::keyColumns); a Rewrite change means the
+     * table must be re-read.
+     */
+    void tableChanged(const QString &table, const QVector<TableChange> &changes, quint64 sequence);
+
+private slots:
+    void onFileChanged(const QString &path);
+    void onDirectoryChanged(const QString &path);
+    void onServerReadyRead();
+
+private:
+    ChangeFeed();
+
+    void watchMissing();
+    void refresh(const QString &table);
+
+    QFileSystemWatcher *watcher;
+    QStringList watchedTables;
+    QLocalSocket *server;
+    QByteArray serverBuffer; ///< Bytes received but not yet parsed into frames.
+};
+
+#endif // CHANGEFEED_HPP
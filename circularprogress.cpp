@@ -2,75 +2,180 @@
  * @file circularprogress.cpp
  * @brief Implementation of the custom CircularProgress widget.
  *
- * Draws a circular progress bar using QPainter with antialiasing.
+ * Draws a circular progress bar using QPainter with antialiasing. The static
+ * track is cached in a pixmap; updates repaint only the changed arc and text.
  */
 
 #include "circularprogress.hpp"
+#include <QFontMetrics>
 #include <QPainter>
-#include <QPainterPath>
+#include <QPaintEvent>
+#include <QScreen>
+#include <QtMath>
+#include <cmath>
+
+static const int MARGIN = 15;       ///< Space around the ring so the pens are not clipped.
+static const int ARC_WIDTH = 12;
+static const int TRACK_WIDTH = 6;
+static const int FALLBACK_FRAME_MS = 16;
 
 CircularProgress::CircularProgress(QWidget *parent) : QWidget(parent), m_progress(0.0)
 {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setMinimumSize(200, 200);
+
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    connect(m_frameTimer, &QTimer::timeout, this, [this]()
+            {
+                update(m_dirty);
+                m_dirty = QRegion(); });
 }
 
 void CircularProgress::setProgress(float value)
 {
+    value = qBound(0.0f, value, 1.0f);
+    if (value == m_progress)
+        return;
+    scheduleRepaint(arcBounds(m_progress, value));
     m_progress = value;
-    update();
 }
 
 //! Sets the text displayed in the center of the ring
 void CircularProgress::setTimeText(const QString &text)
 {
+    if (text == m_text)
+        return;
+    scheduleRepaint(textBounds(m_text).united(textBounds(text)));
     m_text = text;
-    update();
 }
 
-void CircularProgress::paintEvent(QPaintEvent *event)
+QRectF CircularProgress::ringRect() const
 {
-    Q_UNUSED(event);
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
-
     // Calculate the size of the circle based on the widget dimensions
     int side = qMin(width(), height());
-    QRectF rect(15, 15, side - 30, side - 30); // Apply a margin to avoid clipping
+    return QRectF(MARGIN, MARGIN, side - 2 * MARGIN, side - 2 * MARGIN);
+}
+
+QRect CircularProgress::arcBounds(float from, float to) const
+{
+    QRectF rect = ringRect();
+    QPointF center = rect.center();
+    qreal radius = rect.width() / 2;
+
+    // Progress runs clockwise from 12 o'clock; in math angles that is 90° downwards
+    qreal a0 = 90.0 - 360.0 * qMin(from, to);
+    qreal a1 = 90.0 - 360.0 * qMax(from, to);
+    auto point = [&](qreal degrees)
+    { return center + QPointF(radius * qCos(qDegreesToRadians(degrees)), -radius * qSin(qDegreesToRadians(degrees))); };
+
+    QRectF bounds(point(a0), point(a1));
+    bounds = bounds.normalized();
+    // The arc bulges past its end points wherever it crosses an axis
+    for (qreal axis = std::floor(a0 / 90.0) * 90.0; axis > a1; axis -= 90.0)
+        if (axis < a0)
+            bounds = bounds.united(QRectF(point(axis), QSizeF(0, 0)));
+
+    int pad = ARC_WIDTH / 2 + 2; // Pen half-width, round caps and antialiasing
+    return bounds.toAlignedRect().adjusted(-pad, -pad, pad, pad);
+}
+
+QRect CircularProgress::textBounds(const QString &text) const
+{
+    if (text.isEmpty())
+        return QRect();
+    QFontMetrics metrics(m_textFont);
+    QRect box(0, 0, metrics.horizontalAdvance(text) + 4, metrics.height() + 4);
+    box.moveCenter(ringRect().center().toPoint());
+    return box;
+}
+
+void CircularProgress::scheduleRepaint(const QRect &area)
+{
+    m_dirty += area;
+    if (m_frameTimer->isActive())
+        return;
+
+    // At most one repaint per display frame
+    qreal rate = screen() ? screen()->refreshRate() : 0;
+    int frame = rate > 0 ? qMax(1, qRound(1000.0 / rate)) : FALLBACK_FRAME_MS;
+    qint64 since = m_lastPaint.isValid() ? m_lastPaint.elapsed() : frame;
+    m_frameTimer->start(int(qMax<qint64>(0, frame - since)));
+}
 
+void CircularProgress::rebuildCache()
+{
     // Fetch colors from the current application palette (Theme aware)
     QColor ringColor = palette().highlight().color(); // Use theme secondary color
-    QColor textColor = palette().text().color();      // Use theme text color
+    m_textColor = palette().text().color();            // Use theme text color
+    m_arcPen = QPen(ringColor, ARC_WIDTH, Qt::SolidLine, Qt::RoundCap);
+
+    m_textFont = font();
+    m_textFont.setPixelSize(qMax(1, qMin(width(), height()) / 5)); // Dynamic font size based on widget size
+    m_textFont.setBold(true);
+    m_textFont.setFamily("monospace");
+
+    // --- Track, at device resolution ---
+    qreal dpr = devicePixelRatioF();
+    m_track = QPixmap((QSizeF(size()) * dpr).toSize());
+    m_track.setDevicePixelRatio(dpr);
+    m_track.fill(Qt::transparent);
 
-    // --- Draw Background Track ---
     // Create a lighter version of the accent color for the empty track
-    QPen trackPen(ringColor.lighter(160), 6, Qt::SolidLine, Qt::RoundCap);
+    QPen trackPen(ringColor.lighter(160), TRACK_WIDTH, Qt::SolidLine, Qt::RoundCap);
     if (ringColor.value() > 200)
         trackPen.setColor(ringColor.darker(120)); // If accent is already light, darken the track
 
+    QPainter painter(&m_track);
+    painter.setRenderHint(QPainter::Antialiasing);
     painter.setPen(trackPen);
-    painter.drawEllipse(rect);
+    painter.drawEllipse(ringRect());
+}
 
-    // --- Draw Progress Arc ---
-    QPen progressPen;
-    progressPen.setWidth(12);
-    progressPen.setCapStyle(Qt::RoundCap);
-    progressPen.setColor(ringColor);
-    painter.setPen(progressPen);
+void CircularProgress::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    m_track = QPixmap();
+}
 
+void CircularProgress::changeEvent(QEvent *event)
+{
+    QWidget::changeEvent(event);
+    if (event->type() == QEvent::PaletteChange || event->type() == QEvent::StyleChange ||
+        event->type() == QEvent::FontChange)
+    {
+        m_track = QPixmap();
+        update();
+    }
+}
+
+void CircularProgress::paintEvent(QPaintEvent *event)
+{
+    if (m_track.isNull() || m_track.devicePixelRatio() != devicePixelRatioF())
+        rebuildCache();
+
+    // Qt clips the painter to the repainted region, so only that much is blitted and rasterized
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_track);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // --- Progress Arc ---
     // QPainter uses 1/16th of a degree units.
     // Start at 90 degrees (12 o'clock).
-    int startAngle = 90 * 16;
-    int spanAngle = -m_progress * 360 * 16; // Negative for clockwise direction
-    painter.drawArc(rect, startAngle, spanAngle);
-
-    // --- Draw Center Text ---
-    painter.setPen(textColor);
-    QFont f = font();
-    f.setPixelSize(side / 5); // Dynamic font size based on widget size
-    f.setBold(true);
-    f.setFamily("monospace");
-    painter.setFont(f);
-
-    painter.drawText(rect, Qt::AlignCenter, m_text);
-}
\ No newline at end of file
+    if (m_progress > 0 && event->region().intersects(arcBounds(0, m_progress)))
+    {
+        painter.setPen(m_arcPen);
+        int startAngle = 90 * 16;
+        int spanAngle = -m_progress * 360 * 16; // Negative for clockwise direction
+        painter.drawArc(ringRect(), startAngle, spanAngle);
+    }
+
+    // --- Center Text ---
+    if (event->region().intersects(textBounds(m_text)))
+    {
+        painter.setPen(m_textColor);
+        painter.setFont(m_textFont);
+        painter.drawText(ringRect(), Qt::AlignCenter, m_text);
+    }
+    m_lastPaint.restart();
+}
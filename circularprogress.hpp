@@ -3,7 +3,21 @@
 
 #include <QWidget>
 #include <QColor>
+#include <QElapsedTimer>
+#include <QPen>
+#include <QPixmap>
+#include <QRegion>
+#include <QTimer>
 
+/**
+ * @brief Progress ring with a countdown text in the middle.
+ *
+ * The track ring is rendered once into a QPixmap at the screen's device
+ * pixel ratio and redrawn only after a resize, palette or style change.
+ * A progress change repaints just the part of the ring between the old
+ * and new end, a text change just the text, and repaints are held back
+ * to at most one per display frame.
+ */
 class CircularProgress : public QWidget
 {
     Q_OBJECT
@@ -15,10 +29,26 @@ public:
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
 
 private:
+    QRectF ringRect() const;
+    QRect arcBounds(float from, float to) const; ///< Area the arc covers between two progress values.
+    QRect textBounds(const QString &text) const;
+    void scheduleRepaint(const QRect &area);
+    void rebuildCache();
+
     float m_progress;
     QString m_text;
+
+    QPixmap m_track;  ///< Track ring at device resolution; null when stale.
+    QPen m_arcPen;    ///< Derived from the palette with the track.
+    QColor m_textColor;
+    QFont m_textFont; ///< Sized to the ring.
+    QRegion m_dirty;  ///< Waiting for the next frame.
+    QTimer *m_frameTimer;
+    QElapsedTimer m_lastPaint;
 };
 
-#endif // CIRCULARPROGRESS_HPP
\ No newline at end of file
+#endif // CIRCULARPROGRESS_HPP
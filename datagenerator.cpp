@@ -0,0 +1,531 @@
+/**
+ * @file datagenerator.cpp
+ * @brief Seeded synthetic tables, generated in parallel chunks and streamed to disk.
+ */
+#include "datagenerator.hpp"
+#include "academicmanager.hpp"
+#include "exceptions.hpp"
+#include "tableregistry.hpp"
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QTime>
+#include <QtConcurrent>
+#include <cmath>
+#include <initializer_list>
+
+static const double ZIPF_EXPONENT = 0.9;
+static const double HABIT_KEEPERS = 0.25;   ///< Share of students with habits.
+static const double PRAYER_KEEPERS = 0.15;  ///< Share of students logging prayers.
+static const double TASK_KEEPERS = 0.6;
+static const double QUERY_ASKERS = 0.05;
+static const double NOTICE_DAYS = 0.3;      ///< Share of days with a notice.
+static const int MAX_HABITS = 3;
+static const int MAX_TASKS = 5;
+static const int MAX_QUERIES = 2;
+static const int CLASS_MINUTES = 80;
+
+namespace
+{
+    const char *const FIRST_NAMES[] = {"Aisha", "Arif", "Bilal", "Chloe", "David", "Elena", "Farhan", "Fatima", "Grace", "Hasan",
+                                       "Imran", "Jamal", "Karim", "Laila", "Maya", "Nadia", "Omar", "Priya", "Rahim", "Sadia",
+                                       "Samuel", "Tanvir", "Yusuf", "Zara"};
+    const char *const LAST_NAMES[] = {"Ahmed", "Ali", "Begum", "Chowdhury", "Das", "Evans", "Hossain", "Islam", "Khan", "Lee",
+                                      "Miah", "Nguyen", "Patel", "Rahman", "Roy", "Sarkar", "Sheikh", "Singh", "Smith", "Uddin"};
+    const char *const SUBJECTS[] = {"Structured Programming", "Discrete Mathematics", "Calculus", "Physics", "Data Structures",
+                                    "Digital Logic", "Linear Algebra", "Object Oriented Programming", "Algorithms",
+                                    "Computer Architecture", "Probability and Statistics", "Database Systems",
+                                    "Operating Systems", "Theory of Computation", "Numerical Methods", "Computer Networks",
+                                    "Software Engineering", "Compiler Design", "Artificial Intelligence", "Computer Graphics",
+                                    "Machine Learning", "Distributed Systems", "Information Security", "Project Management"};
+    const char *const DAYS[] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday"};
+    const char *const DESIGNATIONS[] = {"Lecturer", "Assistant Professor", "Associate Professor", "Professor"};
+    const char *const ASSESSMENT_TITLES[] = {"Quiz 1", "Assignment 1", "Quiz 2", "Assignment 2"};
+    const char *const ASSESSMENT_TYPES[] = {"Quiz", "Assignment", "Quiz", "Assignment"};
+
+    struct HabitKind
+    {
+        const char *name;
+        const char *type;
+        const char *frequency;
+        int target;
+        const char *unit;
+    };
+
+    const HabitKind HABIT_KINDS[] = {{"Reading", "Count", "Daily", 20, "pages"},
+                                     {"Exercise", "Duration", "Daily", 30, "min"},
+                                     {"Meditation", "Duration", "Daily", 15, "min"},
+                                     {"Drink water", "Count", "Daily", 8, "glasses"},
+                                     {"Coding practice", "Duration", "Weekly", 300, "min"},
+                                     {"Flashcards", "Count", "Daily", 50, "cards"},
+                                     {"Journal", "Count", "Weekly", 5, "entries"}};
+
+    template <typename T, std::size_t N>
+    int countOf(const T (&)[N]) { return int(N); }
+
+    quint64 splitMix(quint64 x)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    QByteArray num(qint64 value) { return QByteArray::number(value); }
+
+    QByteArray isoDate(const QDate &date) { return date.toString("yyyy-MM-dd").toLatin1(); }
+
+    QByteArray clock(int minutes) { return QTime(minutes / 60, minutes % 60).toString("HH:mm").toLatin1(); }
+
+    /**
+     * @brief Appends one CSV line; generated text never needs quoting.
+     */
+    void line(QByteArray &out, std::initializer_list<QByteArray> fields)
+    {
+        bool first = true;
+        for (const QByteArray &field : fields)
+        {
+            if (!first)
+                out += ',';
+            out += field;
+            first = false;
+        }
+        out += '\n';
+    }
+}
+
+DataGenerator::DataGenerator(const GeneratorOptions &options) : options(options)
+{
+    this->options.students = qMax(0, this->options.students);
+    this->options.coursesPerSemester = qMax(1, this->options.coursesPerSemester);
+    this->options.weeks = qMax(1, this->options.weeks);
+    teacherCount = this->options.teachers > 0 ? this->options.teachers : qMax(qMax(1, courseCount() / 2), this->options.students / 25);
+    adminCount = qMax(1, this->options.students / 5000);
+    termStart = this->options.termStart.addDays(-(this->options.termStart.dayOfWeek() % 7));
+
+    // Format: ID,Name,Email,Username,Password,Dept,...
+    for (const QString &dept : TableRegistry::find("students")->column(5)->getChoices())
+        departments.append(dept.toLatin1());
+}
+
+quint64 DataGenerator::draw(Stream stream, quint64 a, quint64 b, quint64 c) const
+{
+    return splitMix(splitMix(splitMix(splitMix(options.seed ^ (quint64(stream) << 56)) ^ a) ^ b) ^ c);
+}
+
+double DataGenerator::uniform(Stream stream, quint64 a, quint64 b, quint64 c) const
+{
+    return (draw(stream, a, b, c) >> 11) * (1.0 / 9007199254740992.0); // 53 bits
+}
+
+QByteArray DataGenerator::personName(quint64 person) const
+{
+    return QByteArray(FIRST_NAMES[pick(FirstName, countOf(FIRST_NAMES), person)]) + ' ' +
+           LAST_NAMES[pick(LastName, countOf(LAST_NAMES), person)];
+}
+
+QByteArray DataGenerator::department(quint64 person) const
+{
+    return departments[pick(Department, departments.size(), person)];
+}
+
+QByteArray DataGenerator::courseCode(int course) const
+{
+    return department(COURSE_PERSON + course) + num(semesterOfCourse(course) * 100 + slotOfCourse(course) + 1);
+}
+
+QByteArray DataGenerator::courseName(int course) const
+{
+    int round = (course - 1) / countOf(SUBJECTS);
+    QByteArray name = SUBJECTS[(course - 1) % countOf(SUBJECTS)];
+    return round == 0 ? name : name + ' ' + num(round + 1);
+}
+
+int DataGenerator::courseTeacher(int course) const
+{
+    return 1 + pick(Teacher, teacherCount, course);
+}
+
+bool DataGenerator::isEnrolled(int course, int student) const
+{
+    // Zipf-like: the k-th course of a semester takes about 1/k^s of its students
+    int rank = slotOfCourse(course) + 1;
+    return rank == 1 || uniform(Enrolment, course, student) < std::pow(rank, -ZIPF_EXPONENT);
+}
+
+double DataGenerator::ability(int student) const
+{
+    return 0.35 + 0.6 * std::sqrt(uniform(Ability, student));
+}
+
+int DataGenerator::meetingDay(int course, int meeting) const
+{
+    int slot = slotOfCourse(course);
+    int a = slot % 5;
+    int b = (slot + 2) % 5;
+    return meeting % 2 == 0 ? qMin(a, b) : qMax(a, b);
+}
+
+int DataGenerator::meetingStart(int course) const
+{
+    return 8 * 60 + (slotOfCourse(course) % 7) * 90;
+}
+
+QDate DataGenerator::meetingDate(int course, int meeting) const
+{
+    return termStart.addDays((meeting / 2) * 7 + meetingDay(course, meeting));
+}
+
+// ---------------------------------------------------------------------------
+// Tables, one chunk at a time
+// ---------------------------------------------------------------------------
+
+QByteArray DataGenerator::adminRows(qint64) const
+{
+    // Format: ID,Username,Password,Name,Email
+    QByteArray out;
+    line(out, {"1", "admin", "admin", "System Admin", "admin@school.edu"});
+    for (int id = 2; id <= adminCount; ++id)
+        line(out, {num(id), "admin" + num(id), "admin" + num(id), "Admin " + num(id), "admin" + num(id) + "@school.edu"});
+    return out;
+}
+
+QByteArray DataGenerator::studentRows(qint64 chunk) const
+{
+    // Format: ID,Name,Email,Username,Password,Dept,Batch,Sem,DateAdmission,CGPA
+    QByteArray out;
+    int last = int(qMin<qint64>(options.students, (chunk + 1) * STUDENTS_PER_CHUNK));
+    for (int id = int(chunk * STUDENTS_PER_CHUNK) + 1; id <= last; ++id)
+    {
+        int semester = semesterOfStudent(id);
+        QDate admitted = QDate(termStart.year(), termStart.month(), 1).addMonths(-6 * (semester - 1));
+        double cgpa = semester == 1 ? 0.0 : qBound(0.0, 4.0 * ability(id) + 0.4 * (uniform(Ability, id, 1) - 0.5), 4.0);
+        QByteArray name = personName(id);
+        QByteArray username = "s" + num(id);
+        line(out, {num(id), name, name.toLower().replace(' ', '.') + num(id) + "@school.edu", username, username,
+                   department(id), num(admitted.year()), num(semester), isoDate(admitted), QByteArray::number(cgpa, 'f', 2)});
+    }
+    return out;
+}
+
+QByteArray DataGenerator::teacherRows(qint64 chunk) const
+{
+    // Format: ID,Name,Email,Username,Password,Dept,Designation,Salary
+    QByteArray out;
+    int last = int(qMin<qint64>(teacherCount, (chunk + 1) * STUDENTS_PER_CHUNK));
+    for (int id = int(chunk * STUDENTS_PER_CHUNK) + 1; id <= last; ++id)
+    {
+        double u = uniform(Designation, id);
+        int rank = u < 0.4 ? 0 : u < 0.7 ? 1 : u < 0.9 ? 2 : 3;
+        QByteArray name = personName(TEACHER_PERSON + id);
+        QByteArray username = "t" + num(id);
+        line(out, {num(id), name, name.toLower().replace(' ', '.') + num(id) + "@school.edu", username, username,
+                   department(TEACHER_PERSON + id), DESIGNATIONS[rank], num(40000 + rank * 20000 + pick(Designation, 20, id, 1) * 1000)});
+    }
+    return out;
+}
+
+QByteArray DataGenerator::courseRows(qint64) const
+{
+    // Format: ID,Code,Name,TeacherID,Semester,Credits
+    QByteArray out;
+    for (int course = 1; course <= courseCount(); ++course)
+    {
+        bool lab = options.coursesPerSemester > 1 && slotOfCourse(course) == options.coursesPerSemester - 1;
+        line(out, {num(course), courseCode(course), courseName(course), num(courseTeacher(course)),
+                   num(semesterOfCourse(course)), lab ? "1" : "3"});
+    }
+    return out;
+}
+
+QByteArray DataGenerator::routineRows(qint64) const
+{
+    // Format: Day,Start,End,Code,Name,Room,Instructor,Semester
+    QByteArray out;
+    for (int course = 1; course <= courseCount(); ++course)
+        for (int meeting = 0; meeting < 2; ++meeting)
+            line(out, {DAYS[meetingDay(course, meeting)], clock(meetingStart(course)), clock(meetingStart(course) + CLASS_MINUTES),
+                       courseCode(course), courseName(course), "Room " + num(101 + pick(Teacher, 40, course, 1)),
+                       personName(TEACHER_PERSON + courseTeacher(course)), num(semesterOfCourse(course))});
+    return out;
+}
+
+QByteArray DataGenerator::assessmentRows(qint64) const
+{
+    // Format: ID,CourseID,Title,Type,Date,MaxMarks
+    QByteArray out;
+    for (int course = 1; course <= courseCount(); ++course)
+        for (int a = 0; a < ASSESSMENTS_PER_COURSE; ++a)
+            line(out, {num((course - 1) * ASSESSMENTS_PER_COURSE + a + 1), num(course), ASSESSMENT_TITLES[a], ASSESSMENT_TYPES[a],
+                       isoDate(termStart.addDays((a + 1) * termDays() / (ASSESSMENTS_PER_COURSE + 1))), "20"});
+    return out;
+}
+
+QByteArray DataGenerator::gradeRows(qint64 chunk) const
+{
+    // Format: StudentID,AssessmentID,Marks; one chunk per assessment
+    QByteArray out;
+    int assessment = int(chunk) + 1;
+    int course = int(chunk / ASSESSMENTS_PER_COURSE) + 1;
+    for (int student = semesterOfCourse(course); student <= options.students; student += SEMESTERS)
+    {
+        if (!isEnrolled(course, student))
+            continue;
+        double share = qBound(0.0, ability(student) + 0.3 * (uniform(Marks, assessment, student) - 0.5), 1.0);
+        line(out, {num(student), num(assessment), QByteArray::number(std::round(share * 40) / 2)});
+    }
+    return out;
+}
+
+QByteArray DataGenerator::attendanceRows(qint64 chunk) const
+{
+    // Format: CourseID,StudentID,Date,Present; one chunk per class meeting
+    QByteArray out;
+    int meetings = 2 * options.weeks;
+    int course = int(chunk / meetings) + 1;
+    int meeting = int(chunk % meetings);
+    QByteArray date = isoDate(meetingDate(course, meeting));
+    for (int student = semesterOfCourse(course); student <= options.students; student += SEMESTERS)
+    {
+        if (!isEnrolled(course, student))
+            continue;
+        // Most students attend nearly always; a tail of them misses up to 40%
+        double punctuality = 1.0 - 0.4 * std::pow(uniform(Punctuality, student), 3);
+        bool present = uniform(Presence, course, meeting, student) < punctuality;
+        line(out, {num(course), num(student), date, present ? "1" : "0"});
+    }
+    return out;
+}
+
+QByteArray DataGenerator::habitRows(qint64 chunk) const
+{
+    // Format: ID,UserID,Name,Type,Freq,Target,Current,Streak,LastDate,IsCompleted,Unit
+    QByteArray out;
+    QDate termEnd = termStart.addDays(termDays() - 1);
+    int last = int(qMin<qint64>(options.students, (chunk + 1) * STUDENTS_PER_CHUNK));
+    for (int student = int(chunk * STUDENTS_PER_CHUNK) + 1; student <= last; ++student)
+    {
+        if (uniform(Habits, student) >= HABIT_KEEPERS)
+            continue;
+        int count = 1 + pick(Habits, MAX_HABITS, student, 1);
+        int first = pick(Habits, countOf(HABIT_KINDS), student, 2);
+        for (int k = 0; k < count; ++k)
+        {
+            const HabitKind &kind = HABIT_KINDS[(first + k * 3) % countOf(HABIT_KINDS)]; // 3 is coprime to 7: distinct kinds
+            int current = pick(Habits, kind.target + 1, student, 10 + k);
+            line(out, {num((student - 1) * MAX_HABITS + k + 1), num(student), kind.name, kind.type, kind.frequency, num(kind.target),
+                       num(current), num(pick(Habits, 31, student, 20 + k)), isoDate(termEnd.addDays(-pick(Habits, 7, student, 30 + k))),
+                       current >= kind.target ? "1" : "0", kind.unit});
+        }
+    }
+    return out;
+}
+
+QByteArray DataGenerator::prayerRows(qint64 chunk) const
+{
+    // Format: UserID,Date,Fajr,Dhuhr,Asr,Maghrib,Isha
+    QByteArray out;
+    int last = int(qMin<qint64>(options.students, (chunk + 1) * STUDENTS_PER_CHUNK));
+    for (int student = int(chunk * STUDENTS_PER_CHUNK) + 1; student <= last; ++student)
+    {
+        if (uniform(Prayers, student) >= PRAYER_KEEPERS)
+            continue;
+        double diligence = 0.5 + 0.45 * uniform(Prayers, student, 1);
+        for (int day = 0; day < termDays(); ++day)
+        {
+            if (uniform(Prayers, student, 2, day) >= 0.75) // Days without an entry
+                continue;
+            QByteArray flags[5];
+            for (int p = 0; p < 5; ++p)
+                flags[p] = uniform(Prayers, student, 10 + p, day) < diligence ? "1" : "0";
+            line(out, {num(student), isoDate(termStart.addDays(day)), flags[0], flags[1], flags[2], flags[3], flags[4]});
+        }
+    }
+    return out;
+}
+
+QByteArray DataGenerator::taskRows(qint64 chunk) const
+{
+    // Format: ID,UserID,Desc,IsCompleted
+    QByteArray out;
+    int last = int(qMin<qint64>(options.students, (chunk + 1) * STUDENTS_PER_CHUNK));
+    for (int student = int(chunk * STUDENTS_PER_CHUNK) + 1; student <= last; ++student)
+    {
+        if (uniform(Tasks, student) >= TASK_KEEPERS)
+            continue;
+        int count = 1 + pick(Tasks, MAX_TASKS, student, 1);
+        for (int k = 0; k < count; ++k)
+        {
+            int course = (semesterOfStudent(student) - 1) * options.coursesPerSemester + pick(Tasks, options.coursesPerSemester, student, 10 + k) + 1;
+            QByteArray description;
+            switch (pick(Tasks, 3, student, 20 + k))
+            {
+            case 0:
+                description = "Revise " + courseName(course);
+                break;
+            case 1:
+                description = "Finish " + courseCode(course) + " assignment";
+                break;
+            default:
+                description = "Read chapter " + num(1 + pick(Tasks, 12, student, 30 + k)) + " of " + courseName(course);
+            }
+            line(out, {num((student - 1) * MAX_TASKS + k + 1), num(student), description, uniform(Tasks, student, 40 + k) < 0.5 ? "1" : "0"});
+        }
+    }
+    return out;
+}
+
+QByteArray DataGenerator::noticeRows(qint64) const
+{
+    // Format: Date,Author,Content
+    QByteArray out;
+    for (int day = 0; day < termDays(); ++day)
+    {
+        if (uniform(Notices, day) >= NOTICE_DAYS)
+            continue;
+        int course = 1 + pick(Notices, courseCount(), day, 1);
+        QByteArray content;
+        switch (pick(Notices, 3, day, 2))
+        {
+        case 0:
+            content = courseCode(course) + " class moved to Room " + num(101 + pick(Notices, 40, day, 3));
+            break;
+        case 1:
+            content = "Quiz of " + courseCode(course) + " rescheduled to next week";
+            break;
+        default:
+            content = "Semester " + num(semesterOfCourse(course)) + " registration closes on " + isoDate(termStart.addDays(day + 7));
+        }
+        line(out, {isoDate(termStart.addDays(day)), personName(TEACHER_PERSON + courseTeacher(course)), content});
+    }
+    return out;
+}
+
+QByteArray DataGenerator::queryRows(qint64 chunk) const
+{
+    // Format: ID,StudentID,Question,Answer
+    QByteArray out;
+    int last = int(qMin<qint64>(options.students, (chunk + 1) * STUDENTS_PER_CHUNK));
+    for (int student = int(chunk * STUDENTS_PER_CHUNK) + 1; student <= last; ++student)
+    {
+        if (uniform(Queries, student) >= QUERY_ASKERS)
+            continue;
+        int count = 1 + pick(Queries, MAX_QUERIES, student, 1);
+        for (int k = 0; k < count; ++k)
+        {
+            int course = (semesterOfStudent(student) - 1) * options.coursesPerSemester + pick(Queries, options.coursesPerSemester, student, 10 + k) + 1;
+            bool answered = uniform(Queries, student, 20 + k) < 0.6;
+            line(out, {num((student - 1) * MAX_QUERIES + k + 1), num(student), "When is the next quiz of " + courseCode(course) + "?",
+                       answered ? QByteArray("Check the notice board for the date.") : QByteArray()});
+        }
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+
+qint64 DataGenerator::writeTable(const QString &path, qint64 chunks, const std::function<QByteArray(qint64)> &make) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        throw Acadence::FileException("Failed to open file for writing: " + path);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(options.threads > 0 ? options.threads : QThread::idealThreadCount());
+    const qint64 window = 2 * pool.maxThreadCount(); // Chunks in memory: at most two windows
+
+    qint64 rows = 0;
+    auto write = [&](const QFuture<QByteArray> &future)
+    {
+        for (const QByteArray &chunk : future.results())
+        {
+            if (file.write(chunk) != chunk.size())
+                throw Acadence::FileException("Failed to write file: " + path);
+            rows += chunk.count('\n');
+        }
+    };
+
+    // Write one window of chunks while the next one is generated
+    QFuture<QByteArray> pending;
+    bool hasPending = false;
+    for (qint64 first = 0; first < chunks; first += window)
+    {
+        QVector<qint64> ids;
+        for (qint64 c = first; c < qMin(chunks, first + window); ++c)
+            ids.append(c);
+        QFuture<QByteArray> next = QtConcurrent::mapped(&pool, std::move(ids), make);
+        if (hasPending)
+            write(pending);
+        pending = next;
+        hasPending = true;
+    }
+    if (hasPending)
+        write(pending);
+
+    if (!file.flush())
+        throw Acadence::FileException("Failed to write file: " + path);
+    return rows;
+}
+
+void DataGenerator::run(const QString &directory, const Progress &progress) const
+{
+    if (!QDir().mkpath(directory))
+        throw Acadence::FileException("Failed to create directory: " + directory);
+    QDir dir(directory);
+
+    using Make = QByteArray (DataGenerator::*)(qint64) const;
+    struct Job
+    {
+        const char *fileName;
+        qint64 chunks;
+        Make make;
+    };
+    qint64 studentChunks = (options.students + STUDENTS_PER_CHUNK - 1) / STUDENTS_PER_CHUNK;
+    const Job jobs[] = {
+        {"admins.csv", 1, &DataGenerator::adminRows},
+        {"students.csv", studentChunks, &DataGenerator::studentRows},
+        {"teachers.csv", (teacherCount + STUDENTS_PER_CHUNK - 1) / STUDENTS_PER_CHUNK, &DataGenerator::teacherRows},
+        {"courses.csv", 1, &DataGenerator::courseRows},
+        {"routine.csv", 1, &DataGenerator::routineRows},
+        {"assessments.csv", 1, &DataGenerator::assessmentRows},
+        {"grades.csv", qint64(courseCount()) * ASSESSMENTS_PER_COURSE, &DataGenerator::gradeRows},
+        {"attendance.csv", qint64(courseCount()) * 2 * options.weeks, &DataGenerator::attendanceRows},
+        {"habits.csv", studentChunks, &DataGenerator::habitRows},
+        {"prayers.csv", studentChunks, &DataGenerator::prayerRows},
+        {"tasks.csv", studentChunks, &DataGenerator::taskRows},
+        {"notices.csv", 1, &DataGenerator::noticeRows},
+        {"queries.csv", studentChunks, &DataGenerator::queryRows}};
+
+    QSet<QString> written;
+    for (const Job &job : jobs)
+    {
+        Make make = job.make;
+        qint64 rows = writeTable(dir.filePath(job.fileName), job.chunks, [this, make](qint64 chunk)
+                                 { return (this->*make)(chunk); });
+        written.insert(job.fileName);
+        if (progress)
+            progress(job.fileName, rows);
+    }
+
+    // The remaining tables start empty
+    for (const QString &fileName : AcadenceManager::dataFiles())
+    {
+        if (written.contains(fileName))
+            continue;
+        writeTable(dir.filePath(fileName), 0, {});
+        if (progress)
+            progress(fileName, 0);
+    }
+
+    // Sequence numbers and change logs of an earlier dataset no longer apply
+    for (const QString &fileName : AcadenceManager::dataFiles())
+    {
+        QFile::remove(dir.filePath(fileName + ".seq"));
+        QFile::remove(dir.filePath(fileName + ".log"));
+        QFile::remove(dir.filePath(fileName + ".base"));
+    }
+}
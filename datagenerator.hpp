@@ -0,0 +1,138 @@
+#ifndef DATAGENERATOR_HPP
+#define DATAGENERATOR_HPP
+
+#include <QByteArray>
+#include <QDate>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief Size and shape of a generated dataset.
+ */
+struct GeneratorOptions
+{
+    quint64 seed = 1;
+    int students = 1000;
+    int teachers = 0;            ///< 0: one per 25 students, and at least one per two courses.
+    int coursesPerSemester = 6;
+    int weeks = 14;              ///< Term length; courses meet twice a week.
+    QDate termStart = QDate(2025, 1, 5); ///< Moved back to a Sunday.
+    int threads = 0;             ///< 0: QThread::idealThreadCount().
+};
+
+/**
+ * @brief Writes a consistent synthetic set of every CSV table for load testing.
+ *
+ * Every value is a pure function of the seed and the entity's IDs (a
+ * SplitMix64 hash), so a dataset is identical whatever the thread count,
+ * and no table needs another in memory. Tables are produced in chunks on
+ * a thread pool; chunks are written in order while the next window of
+ * chunks is generated, so memory stays bounded at any scale.
+ *
+ * Students are spread evenly over eight semesters. Course sizes within a
+ * semester follow a Zipf-like law (the first course takes everyone, the
+ * k-th about 1/k^0.9 of the semester), every class meeting has an
+ * attendance row per enrolled student, and habits, prayers, tasks and
+ * queries are kept by a minority of students only.
+ */
+class DataGenerator
+{
+public:
+    /**
+     * @brief Called after each table with its file name and row count.
+     */
+    using Progress = std::function<void(const QString &fileName, qint64 rows)>;
+
+    explicit DataGenerator(const GeneratorOptions &options);
+
+    /**
+     * @brief Writes every table into @p directory, replacing existing files.
+     * @throws Acadence::FileException if a file cannot be written.
+     */
+    void run(const QString &directory, const Progress &progress = Progress()) const;
+
+private:
+    /// Independent random streams; each draw also hashes in the entity IDs.
+    enum Stream : quint64
+    {
+        FirstName = 1,
+        LastName,
+        Department,
+        Ability,
+        Teacher,
+        Designation,
+        Enrolment,
+        Punctuality,
+        Presence,
+        Marks,
+        Habits,
+        Prayers,
+        Tasks,
+        Queries,
+        Notices
+    };
+
+    quint64 draw(Stream stream, quint64 a, quint64 b = 0, quint64 c = 0) const;
+    double uniform(Stream stream, quint64 a, quint64 b = 0, quint64 c = 0) const; ///< In [0, 1).
+    int pick(Stream stream, int count, quint64 a, quint64 b = 0, quint64 c = 0) const { return int(draw(stream, a, b, c) % quint64(count)); }
+
+    int courseCount() const { return SEMESTERS * options.coursesPerSemester; }
+    int semesterOfStudent(int student) const { return (student - 1) % SEMESTERS + 1; }
+    int semesterOfCourse(int course) const { return (course - 1) / options.coursesPerSemester + 1; }
+    int slotOfCourse(int course) const { return (course - 1) % options.coursesPerSemester; }
+    int termDays() const { return options.weeks * 7; }
+
+    /**
+     * @brief Name and department of a person: student IDs are used as they
+     * are, teachers are offset by TEACHER_PERSON and courses by COURSE_PERSON.
+     */
+    QByteArray personName(quint64 person) const;
+    QByteArray department(quint64 person) const;
+    QByteArray courseCode(int course) const;
+    QByteArray courseName(int course) const;
+    int courseTeacher(int course) const;
+    bool isEnrolled(int course, int student) const;
+    double ability(int student) const; ///< Share of the marks the student tends to get.
+
+    /**
+     * @brief Weekday (0 = Sunday) and start time of a course's class meetings.
+     */
+    int meetingDay(int course, int meeting) const;
+    int meetingStart(int course) const; ///< Minutes after midnight.
+    QDate meetingDate(int course, int meeting) const;
+
+    QByteArray adminRows(qint64 chunk) const;
+    QByteArray studentRows(qint64 chunk) const;
+    QByteArray teacherRows(qint64 chunk) const;
+    QByteArray courseRows(qint64 chunk) const;
+    QByteArray routineRows(qint64 chunk) const;
+    QByteArray assessmentRows(qint64 chunk) const;
+    QByteArray gradeRows(qint64 chunk) const;
+    QByteArray attendanceRows(qint64 chunk) const;
+    QByteArray habitRows(qint64 chunk) const;
+    QByteArray prayerRows(qint64 chunk) const;
+    QByteArray taskRows(qint64 chunk) const;
+    QByteArray noticeRows(qint64 chunk) const;
+    QByteArray queryRows(qint64 chunk) const;
+
+    /**
+     * @brief Generates @p chunks chunks in parallel and writes them to @p path in order.
+     * @return Rows written.
+     */
+    qint64 writeTable(const QString &path, qint64 chunks, const std::function<QByteArray(qint64)> &make) const;
+
+    static const int SEMESTERS = 8;
+    static const int ASSESSMENTS_PER_COURSE = 4;
+    static const int STUDENTS_PER_CHUNK = 5000;
+    static const quint64 TEACHER_PERSON = quint64(1) << 32;
+    static const quint64 COURSE_PERSON = quint64(2) << 32;
+
+    GeneratorOptions options;
+    int teacherCount;
+    int adminCount;
+    QDate termStart;
+    QVector<QByteArray> departments;
+};
+
+#endif // DATAGENERATOR_HPP
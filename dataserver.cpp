@@ -0,0 +1,318 @@
+/**
+ * @file dataserver.cpp
+ * @brief Local socket server exposing the in-memory tables to many clients.
+ */
+#include "dataserver.hpp"
+#include "datastore.hpp"
+#include "tablefile.hpp"
+#include "changefeed.hpp"
+#include "exceptions.hpp"
+#include "academicmanager.hpp"
+#include "gpaengine.hpp"
+#include <climits>
+
+DataServer::DataServer(QObject *parent) : QObject(parent), server(new QLocalServer(this))
+{
+    connect(server, &QLocalServer::newConnection, this, &DataServer::onNewConnection);
+    connect(&ChangeFeed::instance(), &ChangeFeed::tableChanged, this, &DataServer::onTableChanged);
+}
+
+bool DataServer::listen(const QString &name)
+{
+    QLocalServer::removeServer(name);
+    return server->listen(name);
+}
+
+QString DataServer::errorString() const
+{
+    return server->errorString();
+}
+
+void DataServer::preload(const QStringList &tables)
+{
+    DataStore::instance().snapshot(tables);
+}
+
+void DataServer::onNewConnection()
+{
+    while (QLocalSocket *socket = server->nextPendingConnection())
+    {
+        buffers.insert(socket, QByteArray());
+        connect(socket, &QLocalSocket::readyRead, this, &DataServer::onReadyRead);
+        connect(socket, &QLocalSocket::disconnected, this, &DataServer::onDisconnected);
+    }
+}
+
+void DataServer::onDisconnected()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    buffers.remove(socket);
+    subscribers.remove(socket);
+    socket->deleteLater();
+}
+
+void DataServer::onReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    QByteArray &buffer = buffers[socket];
+    buffer += socket->readAll();
+
+    // Answer every complete request; pipelined requests arrive in one read
+    QByteArray out;
+    quint32 id;
+    Protocol::Op op;
+    QByteArray body;
+    for (;;)
+    {
+        try
+        {
+            if (!Protocol::takeFrame(buffer, Protocol::MAX_REQUEST_SIZE, id, op, body))
+                break;
+        }
+        catch (const Acadence::Exception &)
+        {
+            // A bad length leaves no way to find the next frame; the client is dropped
+            socket->abort();
+            return;
+        }
+
+        Protocol::Op replyOp = Protocol::Error;
+        QByteArray reply;
+        try
+        {
+            reply = handle(socket, op, body, replyOp);
+        }
+        catch (const std::exception &e)
+        {
+            replyOp = Protocol::Error;
+            reply.clear();
+            QDataStream err(&reply, QIODevice::WriteOnly);
+            Protocol::writeString(err, QString::fromUtf8(e.what()));
+        }
+        out += Protocol::frame(id, replyOp, reply);
+    }
+    if (!out.isEmpty())
+        socket->write(out);
+}
+
+QByteArray DataServer::handle(QLocalSocket *socket, Protocol::Op op, const QByteArray &body, Protocol::Op &replyOp)
+{
+    switch (op)
+    {
+    case Protocol::Subscribe:
+        subscribers.insert(socket);
+        replyOp = Protocol::Notify;
+        return QByteArray();
+    case Protocol::FetchTables:
+        replyOp = Protocol::Tables;
+        return fetchTables(body);
+    case Protocol::FetchChanges:
+        replyOp = Protocol::Changes;
+        return fetchChanges(body);
+    case Protocol::Commit:
+        return commit(body, replyOp);
+    case Protocol::Select:
+        replyOp = Protocol::Rows;
+        return select(body);
+    case Protocol::StudentGpa:
+        replyOp = Protocol::Gpa;
+        return studentGpa(body);
+    case Protocol::StudentAttendance:
+        replyOp = Protocol::Attendance;
+        return studentAttendance(body);
+    default:
+        throw Acadence::Exception("Unknown request " + QString::number(op));
+    }
+}
+
+void DataServer::onTableChanged(const QString &table, const QVector<TableChange> &, quint64 sequence)
+{
+    // Clients fetch the rows themselves, so they only pull tables they hold
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    Protocol::writeString(out, table);
+    out << sequence;
+    QByteArray notification = Protocol::frame(0, Protocol::Notify, body);
+    for (QLocalSocket *socket : subscribers)
+        socket->write(notification);
+}
+
+QByteArray DataServer::fetchTables(const QByteArray &body)
+{
+    QDataStream in(body);
+    QStringList names = Protocol::readStringList(in);
+    if (in.status() != QDataStream::Ok)
+        throw Acadence::Exception("Malformed table request");
+
+    DataSnapshotPtr snap = DataStore::instance().snapshot(names);
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    out << quint32(names.size());
+    for (const QString &name : names)
+    {
+        TableSnapshotPtr t = snap->table(name);
+        Protocol::writeString(out, name);
+        out << t->getSequence();
+        Protocol::writeRows(out, t->getRows());
+    }
+    return reply;
+}
+
+QByteArray DataServer::fetchChanges(const QByteArray &body)
+{
+    QDataStream in(body);
+    QString name = Protocol::readString(in);
+    quint64 clientSeq = 0;
+    in >> clientSeq;
+    if (in.status() != QDataStream::Ok)
+        throw Acadence::Exception("Malformed change request");
+
+    TableSnapshotPtr t = DataStore::instance().table(name);
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+
+    // The change log only matches our rows if nobody else wrote the file since
+    TableFile file(name);
+    bool complete = false;
+    QVector<TableChange> changes;
+    if (file.readSequence() == t->getSequence())
+        changes = file.readChangesSince(clientSeq, complete);
+
+    out << t->getSequence() << complete;
+    if (complete)
+        Protocol::writeChanges(out, changes);
+    else
+        Protocol::writeRows(out, t->getRows());
+    return reply;
+}
+
+QByteArray DataServer::commit(const QByteArray &body, Protocol::Op &replyOp)
+{
+    struct IncomingWrite
+    {
+        QString name;
+        quint64 baseSequence;
+        quint8 mode; ///< 0 = appended rows, 1 = row changes, 2 = full rows.
+        CsvTable rows;
+        QVector<TableChange> changes;
+    };
+
+    QDataStream in(body);
+    quint32 count = 0;
+    in >> count;
+    QVector<IncomingWrite> writes;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        IncomingWrite w;
+        w.name = Protocol::readString(in);
+        in >> w.baseSequence >> w.mode;
+        if (w.mode == 1)
+            w.changes = Protocol::readChanges(in);
+        else if (w.mode == 0 || w.mode == 2)
+            w.rows = Protocol::readRows(in);
+        else
+            in.setStatus(QDataStream::ReadCorruptData);
+        writes.append(w);
+    }
+    // Nothing of a damaged request is committed
+    if (in.status() != QDataStream::Ok)
+        throw Acadence::Exception("Malformed commit request");
+
+    // Compare-and-swap against our copy: the client must have seen the latest rows
+    QStringList stale;
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 {
+        stale.clear();
+        for (const auto &w : writes)
+            if (batch.sequence(w.name) != w.baseSequence)
+                stale.append(w.name);
+        if (!stale.isEmpty())
+            return;
+
+        for (const auto &w : writes)
+        {
+            if (w.mode == 0)
+            {
+                for (const auto &row : w.rows)
+                    batch.append(w.name, row);
+            }
+            else if (w.mode == 1)
+            {
+                batch.apply(w.name, w.changes);
+            }
+            else
+            {
+                batch.rows(w.name) = w.rows;
+            }
+        } });
+
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    if (!stale.isEmpty())
+    {
+        replyOp = Protocol::Conflict;
+        out << stale;
+        return reply;
+    }
+
+    replyOp = Protocol::Committed;
+    DataSnapshotPtr snap = DataStore::instance().snapshot();
+    out << quint32(writes.size());
+    for (const auto &w : writes)
+    {
+        Protocol::writeString(out, w.name);
+        out << snap->table(w.name)->getSequence();
+    }
+    return reply;
+}
+
+QByteArray DataServer::select(const QByteArray &body)
+{
+    QDataStream in(body);
+    QString name = Protocol::readString(in);
+    qint32 column = 0;
+    in >> column;
+    QString value = Protocol::readString(in);
+    quint32 offset = 0;
+    quint32 limit = 0;
+    in >> offset >> limit;
+    if (in.status() != QDataStream::Ok || column < -1 || !AcadenceManager::dataFiles().contains(name))
+        throw Acadence::Exception("Malformed select request");
+
+    int total = 0;
+    CsvTable rows = AcadenceManager::selectRows(name, column, value, int(qMin<quint32>(offset, INT_MAX)),
+                                                int(qMin<quint32>(limit, INT_MAX)), total);
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    out << quint32(total);
+    Protocol::writeRows(out, rows);
+    return reply;
+}
+
+QByteArray DataServer::studentGpa(const QByteArray &body)
+{
+    QDataStream in(body);
+    qint32 studentId = 0;
+    in >> studentId;
+    if (in.status() != QDataStream::Ok)
+        throw Acadence::Exception("Malformed GPA request");
+
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    Protocol::writeGpa(out, GpaEngine::instance().forStudent(studentId));
+    return reply;
+}
+
+QByteArray DataServer::studentAttendance(const QByteArray &body)
+{
+    QDataStream in(body);
+    qint32 studentId = 0;
+    in >> studentId;
+    if (in.status() != QDataStream::Ok)
+        throw Acadence::Exception("Malformed attendance request");
+
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    Protocol::writeAttendance(out, AcadenceManager().getStudentAttendance(studentId));
+    return reply;
+}
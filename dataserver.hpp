@@ -0,0 +1,59 @@
+#ifndef DATASERVER_HPP
+#define DATASERVER_HPP
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QHash>
+#include <QSet>
+#include "protocol.hpp"
+
+/**
+ * @brief Serves the process-wide DataStore to Acadence clients over QLocalSocket.
+ *
+ * Run by acadence-server: the tables are parsed once per machine and every
+ * GUI instance started with --server talks to this process through a
+ * RemoteBackend. Requests are answered in arrival order, so clients may
+ * pipeline them. Subscribed clients are told about every table change.
+ * Besides whole tables, it answers the per-user queries of Protocol
+ * (matching rows, a student's GPA and attendance summary) from its own
+ * tables, so clients showing them need not load those tables.
+ */
+class DataServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DataServer(QObject *parent = nullptr);
+
+    /**
+     * @brief Starts listening; removes a stale socket left by a crashed server.
+     */
+    bool listen(const QString &name);
+    QString errorString() const;
+
+    /**
+     * @brief Loads the given tables so the first client does not wait for parsing.
+     */
+    void preload(const QStringList &tables);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void onTableChanged(const QString &table, const QVector<TableChange> &changes, quint64 sequence);
+
+private:
+    QByteArray handle(QLocalSocket *socket, Protocol::Op op, const QByteArray &body, Protocol::Op &replyOp);
+    QByteArray fetchTables(const QByteArray &body);
+    QByteArray fetchChanges(const QByteArray &body);
+    QByteArray commit(const QByteArray &body, Protocol::Op &replyOp);
+    QByteArray select(const QByteArray &body);
+    QByteArray studentGpa(const QByteArray &body);
+    QByteArray studentAttendance(const QByteArray &body);
+
+    QLocalServer *server;
+    QHash<QLocalSocket *, QByteArray> buffers; ///< Unparsed bytes per client.
+    QSet<QLocalSocket *> subscribers;          ///< Clients receiving Notify frames.
+};
+
+#endif // DATASERVER_HPP
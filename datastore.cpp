@@ -0,0 +1,372 @@
+/**
+ * @file datastore.cpp
+ * @brief Copy-on-write, snapshot-based in-memory store for the CSV tables.
+ */
+#include "datastore.hpp"
+#include "storagebackend.hpp"
+#include "changefeed.hpp"
+#include "tablefile.hpp"
+#include <QMutexLocker>
+#include <atomic>
+
+TableSnapshot::TableSnapshot(QString name, CsvTable rows, quint64 version, quint64 sequence)
+    : name(name), rows(rows), version(version), sequence(sequence) {}
+
+// ========================== BATCH ==========================
+
+DataBatch::DataBatch(DataSnapshotPtr base) : base(base) {}
+
+DataBatch::Pending &DataBatch::touch(const QString &table)
+{
+    auto it = pending.find(table);
+    if (it == pending.end())
+    {
+        TableSnapshotPtr snap = base->table(table);
+        // Tables not in memory yet are loaded here; we already hold the writer lock.
+        if (!snap)
+            snap = DataStore::instance().m_backend->load({table}, base->getVersion()).first();
+
+        Pending p;
+        p.baseRows = snap->getRows();
+        p.rows = p.baseRows;
+        p.rewritten = false;
+        p.patched = false;
+        p.sequence = snap->getSequence();
+        p.snapshot = snap;
+        it = pending.insert(table, p);
+        order.append(table);
+    }
+    return it.value();
+}
+
+const CsvTable &DataBatch::peek(const QString &table)
+{
+    return touch(table).rows;
+}
+
+CsvTable &DataBatch::rows(const QString &table)
+{
+    Pending &p = touch(table);
+    p.rewritten = true;
+    p.keyIndex.reset(); // Would no longer follow the rows
+    return p.rows;
+}
+
+void DataBatch::append(const QString &table, const QStringList &row)
+{
+    Pending &p = touch(table);
+    if (p.keyIndex)
+        p.keyIndex->index.insert(TableChange::rowKey(row, TableFile::keyColumns(table)), p.rows.size());
+    p.rows.append(row);
+    p.appended.append(row);
+    p.changes.append(TableChange(TableChange::Append, row));
+}
+
+bool DataBatch::apply(const QString &table, const QVector<TableChange> &changes)
+{
+    Pending &p = touch(table);
+    QVector<int> keys = TableFile::keyColumns(table);
+    // Once rows() was handed out the index cannot follow the rows any more
+    if (!p.keyIndex && !p.rewritten && !keys.isEmpty())
+        p.keyIndex = DataStore::instance().keyIndex(table, p.snapshot, p.rows);
+    if (!TableChange::apply(p.rows, changes, keys, p.keyIndex ? &p.keyIndex->index : nullptr))
+        return false;
+    for (const auto &change : changes)
+    {
+        // Pure appends keep the cheaper append-to-file path
+        if (change.getType() == TableChange::Append && !p.patched)
+            p.appended.append(change.getRow());
+        else if (change.getType() != TableChange::None)
+            p.patched = true;
+    }
+    p.changes += changes;
+    return true;
+}
+
+quint64 DataBatch::sequence(const QString &table)
+{
+    return touch(table).sequence;
+}
+
+// ========================== STORE ==========================
+
+DataStore &DataStore::instance()
+{
+    static DataStore store;
+    return store;
+}
+
+DataStore::DataStore() : m_current(std::make_shared<const DataSnapshot>()), m_generation(1), m_resets(0), m_backend(new FileBackend) {}
+
+DataStore::~DataStore() = default;
+
+DataSnapshotPtr DataStore::current() const
+{
+    // Each thread keeps the snapshot it last read; while nothing new was
+    // published, a read is one atomic load and touches no shared cache line
+    struct Cached
+    {
+        quint64 generation = 0;
+        DataSnapshotPtr snapshot;
+    };
+    static thread_local Cached cached;
+
+    if (cached.generation != m_generation.load(std::memory_order_acquire))
+    {
+        QMutexLocker locker(&m_publishMutex);
+        cached.snapshot = m_current;
+        cached.generation = m_generation.load(std::memory_order_relaxed);
+    }
+    return cached.snapshot;
+}
+
+void DataStore::publish(DataSnapshotPtr next, const DataSnapshotPtr &base)
+{
+    QMutexLocker locker(&m_publishMutex);
+    if (base && m_current != base)
+    {
+        // Tables loaded by readers (loadMissing()) while the writer worked from base
+        auto merged = std::make_shared<DataSnapshot>(*next);
+        for (auto it = m_current->tables.constBegin(); it != m_current->tables.constEnd(); ++it)
+            if (!base->tables.contains(it.key()) && !merged->tables.contains(it.key()))
+                merged->tables.insert(it.key(), it.value());
+        next = merged;
+    }
+    else if (!base)
+    {
+        ++m_resets;
+    }
+    m_current = next;
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+DataSnapshotPtr DataStore::loadMissing(const QStringList &tables)
+{
+    // Not under the writer lock: a reader waits for the file, never for a commit
+    QMutexLocker locker(&m_loadMutex);
+
+    // Another thread may have loaded them while we waited for the lock
+    DataSnapshotPtr base = current();
+    QStringList missing;
+    for (const QString &name : tables)
+        if (!base->table(name))
+            missing.append(name);
+    if (missing.isEmpty())
+        return base;
+
+    quint64 resets = 0;
+    {
+        QMutexLocker publishLocker(&m_publishMutex);
+        resets = m_resets;
+    }
+    // One call for all tables lets a remote backend pipeline the requests
+    QVector<TableSnapshotPtr> loaded = backend()->load(missing, base->version);
+
+    // Added to whatever was published meanwhile; a table a commit wrote in
+    // the meantime keeps the committed rows
+    QMutexLocker publishLocker(&m_publishMutex);
+    auto next = std::make_shared<DataSnapshot>(*m_current);
+    for (const TableSnapshotPtr &t : loaded)
+        if (!next->tables.contains(t->getName()))
+            next->tables.insert(t->getName(), t);
+    if (resets == m_resets) // Not for a store that was reset or given another backend
+    {
+        m_current = next;
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
+    return next;
+}
+
+std::shared_ptr<TableKeyIndex> DataStore::keyIndex(const QString &name, const TableSnapshotPtr &snapshot, const CsvTable &rows)
+{
+    // Reused if it maps the snapshot the batch started from and the batch
+    // has not appended to it yet; only a new or reloaded table is indexed
+    std::shared_ptr<TableKeyIndex> &entry = m_keyIndexes[name];
+    if (!entry || entry->rows != snapshot || rows.size() != snapshot->getRows().size())
+    {
+        QVector<int> keys = TableFile::keyColumns(name);
+        entry = std::make_shared<TableKeyIndex>();
+        entry->index.reserve(rows.size());
+        for (int i = 0; i < rows.size(); ++i)
+            entry->index.insert(TableChange::rowKey(rows[i], keys), i);
+    }
+    entry->rows = nullptr; // Maps the batch's rows until they are published
+    return entry;
+}
+
+DataSnapshotPtr DataStore::catchUp(DataSnapshotPtr base, const QStringList &tables)
+{
+    auto next = std::make_shared<DataSnapshot>(*base);
+    next->version = base->version + 1;
+
+    for (const QString &name : tables)
+        next->tables.insert(name, m_backend->refresh(base->table(name), name, next->version));
+    return next;
+}
+
+void DataStore::notify(const TableSnapshotPtr &before, const TableSnapshotPtr &after)
+{
+    ChangeFeed &feed = ChangeFeed::instance();
+    if (!before || before == after || !feed.isObserved())
+        return;
+    QString name = after->getName();
+    QVector<TableChange> changes = TableChange::diff(before->getRows(), after->getRows(), TableFile::keyColumns(name));
+    if (!changes.isEmpty())
+        feed.publish(name, changes, after->getSequence());
+}
+
+DataSnapshotPtr DataStore::snapshot(const QStringList &tables)
+{
+    DataSnapshotPtr snap = current();
+    for (const QString &name : tables)
+    {
+        if (!snap->table(name))
+            return loadMissing(tables);
+    }
+    return snap;
+}
+
+TableSnapshotPtr DataStore::table(const QString &name)
+{
+    TableSnapshotPtr t = current()->table(name);
+    if (t)
+        return t;
+    return loadMissing({name})->table(name);
+}
+
+quint64 DataStore::commit(const std::function<void(DataBatch &)> &apply, QHash<QString, quint64> *sequences)
+{
+    QMutexLocker locker(&m_writeMutex);
+    DataSnapshotPtr base = current();
+
+    for (;;)
+    {
+        DataBatch batch(base);
+        apply(batch);
+
+        QVector<TableWrite> writes;
+        for (const QString &name : batch.order)
+        {
+            const DataBatch::Pending &p = batch.pending[name];
+            if (!p.isWritten())
+                continue;
+            // Changes are only exact if rows() was never handed out
+            writes.append({name, p.sequence, p.baseRows, p.rows, p.appended, p.rewritten || p.patched, p.sequence,
+                           p.rewritten ? QVector<TableChange>() : p.changes, !p.rewritten});
+        }
+
+        QStringList stale = writes.isEmpty() ? QStringList() : m_backend->write(writes);
+        if (stale.isEmpty())
+        {
+            auto next = std::make_shared<DataSnapshot>(*base);
+            next->version = base->version + 1;
+            // Tables the batch only read keep their snapshot, so readers can
+            // tell by identity that they did not change
+            for (const QString &name : batch.order)
+                if (!base->table(name))
+                    next->tables.insert(name, batch.pending[name].snapshot);
+            for (const auto &w : writes)
+                next->tables.insert(w.name, std::make_shared<const TableSnapshot>(w.name, w.rows, next->version, w.newSequence));
+
+            // A client of acadence-server keeps no table it only loaded for this commit
+            if (m_backend->isRemote())
+                for (const QString &name : batch.order)
+                    if (!base->table(name))
+                        next->tables.remove(name);
+            publish(next, base);
+
+            // The batch kept the key indexes in step with the rows it published
+            for (const auto &w : writes)
+            {
+                const DataBatch::Pending &p = batch.pending[w.name];
+                if (!p.keyIndex)
+                    continue;
+                p.keyIndex->rows = next->table(w.name);
+                if (!p.keyIndex->rows)
+                    m_keyIndexes.remove(w.name);
+            }
+            if (sequences)
+                for (const auto &w : writes)
+                    sequences->insert(w.name, w.newSequence);
+
+            ChangeFeed &feed = ChangeFeed::instance();
+            if (feed.isObserved())
+                for (const auto &w : writes)
+                    if (!w.changes.isEmpty())
+                        feed.publish(w.name, w.changes, w.newSequence);
+            return next->version;
+        }
+
+        // Keep tables the batch loaded so the retry does not load them again
+        auto merged = std::make_shared<DataSnapshot>(*base);
+        for (const QString &name : batch.order)
+            if (!base->table(name))
+                merged->tables.insert(name, batch.pending[name].snapshot);
+
+        // Conflict: pull in the other writers' rows and re-apply the batch on top
+        DataSnapshotPtr previous = base;
+        base = catchUp(merged, stale);
+        publish(base, previous);
+        for (const QString &name : stale)
+            notify(merged->table(name), base->table(name));
+    }
+}
+
+void DataStore::refresh(const QString &name)
+{
+    QMutexLocker locker(&m_writeMutex);
+    DataSnapshotPtr base = current();
+    TableSnapshotPtr old = base->table(name);
+    if (!old)
+        return;
+
+    TableSnapshotPtr fresh = m_backend->refresh(old, name, base->version + 1);
+    if (fresh == old)
+        return;
+
+    auto next = std::make_shared<DataSnapshot>(*base);
+    next->version = base->version + 1;
+    next->tables.insert(name, fresh);
+    publish(next, base);
+    notify(old, fresh);
+}
+
+void DataStore::invalidate(const QString &name)
+{
+    QMutexLocker locker(&m_writeMutex);
+    DataSnapshotPtr base = current();
+    if (!base->table(name))
+        return;
+    auto next = std::make_shared<DataSnapshot>(*base);
+    next->tables.remove(name);
+    publish(next, base);
+    m_keyIndexes.remove(name);
+}
+
+void DataStore::reset()
+{
+    QMutexLocker locker(&m_writeMutex);
+    auto next = std::make_shared<DataSnapshot>();
+    next->version = current()->version + 1;
+    publish(next, nullptr);
+    m_keyIndexes.clear();
+}
+
+void DataStore::setBackend(std::unique_ptr<StorageBackend> backend)
+{
+    QMutexLocker locker(&m_writeMutex);
+    {
+        QMutexLocker backendLocker(&m_backendMutex);
+        m_backend = std::move(backend);
+    }
+    auto next = std::make_shared<DataSnapshot>();
+    next->version = current()->version + 1;
+    publish(next, nullptr);
+    m_keyIndexes.clear();
+}
+
+std::shared_ptr<StorageBackend> DataStore::backend() const
+{
+    QMutexLocker locker(&m_backendMutex);
+    return m_backend;
+}
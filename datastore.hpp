@@ -0,0 +1,252 @@
+#ifndef DATASTORE_HPP
+#define DATASTORE_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "tablechange.hpp"
+
+class StorageBackend;
+
+/**
+ * @brief An immutable, versioned copy of a single CSV table.
+ *
+ * A snapshot is never modified after it has been published, so any number of
+ * threads may read it without synchronisation.
+ */
+class TableSnapshot
+{
+private:
+    QString name;     ///< Table file name (e.g. "grades.csv").
+    CsvTable rows;    ///< Parsed rows.
+    quint64 version;  ///< Store version that produced this snapshot.
+    quint64 sequence; ///< On-disk commit sequence the rows correspond to.
+
+public:
+    TableSnapshot(QString name, CsvTable rows, quint64 version, quint64 sequence = 0);
+
+    QString getName() const { return name; }
+    const CsvTable &getRows() const { return rows; }
+    quint64 getVersion() const { return version; }
+    quint64 getSequence() const { return sequence; }
+};
+
+using TableSnapshotPtr = std::shared_ptr<const TableSnapshot>;
+
+/**
+ * @brief A consistent view of every loaded table at one store version.
+ *
+ * All tables touched by a single commit appear together in the next view, so
+ * readers never observe a half-applied batch.
+ */
+class DataSnapshot
+{
+private:
+    QHash<QString, TableSnapshotPtr> tables;
+    quint64 version;
+
+    friend class DataStore;
+
+public:
+    DataSnapshot() : version(0) {}
+
+    /**
+     * @brief Returns the snapshot of a table, or nullptr if it is not loaded.
+     */
+    TableSnapshotPtr table(const QString &name) const { return tables.value(name); }
+    quint64 getVersion() const { return version; }
+};
+
+using DataSnapshotPtr = std::shared_ptr<const DataSnapshot>;
+
+/**
+ * @brief Key index of a table, kept by the DataStore from one commit to
+ * the next so keyed edits (DataBatch::apply()) do not index the whole
+ * table again every time.
+ */
+struct TableKeyIndex
+{
+    TableSnapshotPtr rows; ///< Published snapshot the index maps; nullptr while a batch changes it.
+    KeyIndex index;
+};
+
+/**
+ * @brief Working copy of the tables modified by one DataStore::commit().
+ *
+ * Tables are copied on first access (cheaply, through Qt's implicit sharing)
+ * and only become visible to readers once the whole batch is published.
+ */
+class DataBatch
+{
+private:
+    struct Pending
+    {
+        CsvTable baseRows;            ///< Rows as first seen by the batch.
+        CsvTable rows;                ///< Working copy of the table.
+        CsvTable appended;            ///< Rows added through append() only.
+        QVector<TableChange> changes; ///< Changes made through append()/apply().
+        bool rewritten;               ///< True if rows were accessed for modification.
+        bool patched;                 ///< True if apply() changed existing rows.
+        quint64 sequence;             ///< On-disk sequence baseRows correspond to.
+        TableSnapshotPtr snapshot;    ///< Snapshot the batch started from.
+        std::shared_ptr<TableKeyIndex> keyIndex; ///< The store's index of rows, once apply() needed it.
+
+        bool isWritten() const { return rewritten || patched || !appended.isEmpty(); }
+    };
+
+    DataSnapshotPtr base;
+    QHash<QString, Pending> pending;
+    QStringList order; ///< Tables in first-touch order.
+
+    Pending &touch(const QString &table);
+
+    friend class DataStore;
+
+public:
+    explicit DataBatch(DataSnapshotPtr base);
+
+    /**
+     * @brief Read-only view of a table inside the batch (includes pending edits).
+     */
+    const CsvTable &peek(const QString &table);
+
+    /**
+     * @brief Mutable access to a table; the whole table is rewritten on commit.
+     */
+    CsvTable &rows(const QString &table);
+
+    /**
+     * @brief Appends a row; if a table only receives appends it is persisted
+     * by appending to the file instead of rewriting it.
+     */
+    void append(const QString &table, const QStringList &row);
+
+    /**
+     * @brief Applies row-level changes (matched by the table's key columns).
+     *
+     * Unlike rows(), the batch knows exactly what changed, so the change
+     * log and remote backends receive just these rows instead of a diff
+     * of the whole table.
+     * @return False if a change cannot be applied row by row (a Rewrite).
+     */
+    bool apply(const QString &table, const QVector<TableChange> &changes);
+
+    /**
+     * @brief Storage sequence the batch's copy of a table was read at.
+     */
+    quint64 sequence(const QString &table);
+};
+
+/**
+ * @brief Process-wide in-memory store for the CSV tables.
+ *
+ * Readers never block on writers: each thread keeps the DataSnapshot it
+ * last read and checks a publication counter, so while nothing new was
+ * published a read is a single atomic load. Tables that are not loaded yet
+ * are read outside the writer lock. Writers are serialised, build a new
+ * version with copy-on-write, persist it, and publish it atomically.
+ *
+ * Several instances may share one data directory. Each commit hands the
+ * tables it writes to the StorageBackend, which only writes them if their
+ * storage sequence still matches the one the batch read. On a mismatch the
+ * changed rows are pulled in and the batch is re-applied on top of them.
+ */
+class DataStore
+{
+public:
+    static DataStore &instance();
+
+    /**
+     * @brief Current consistent view of all tables; never waits for writers.
+     * @param tables Tables that must be present in the view; missing ones are
+     * loaded from disk first.
+     */
+    DataSnapshotPtr snapshot(const QStringList &tables = {});
+
+    /**
+     * @brief Current snapshot of a single table, loading it on first use.
+     * @throws Acadence::FileException if the file cannot be read.
+     */
+    TableSnapshotPtr table(const QString &name);
+
+    /**
+     * @brief Applies a batch of edits atomically.
+     *
+     * The callback runs under the writer lock. Changed tables are written to
+     * disk and then published together as one new version. If the callback or
+     * the write throws, nothing is published. The callback may run more than
+     * once if another instance committed to the same tables in the meantime,
+     * so it must derive everything it writes from the batch.
+     * @param sequences If given, receives the new storage sequence of each
+     * table the commit wrote.
+     * @return The new store version.
+     */
+    quint64 commit(const std::function<void(DataBatch &)> &apply, QHash<QString, quint64> *sequences = nullptr);
+
+    /**
+     * @brief Pulls in changes other instances made to a loaded table.
+     *
+     * Does nothing if the table is not loaded or already current. Changed rows
+     * are published on the ChangeFeed.
+     */
+    void refresh(const QString &name);
+
+    /**
+     * @brief Drops a table from memory so the next access reloads it from disk.
+     */
+    void invalidate(const QString &name);
+
+    /**
+     * @brief Drops all tables from memory.
+     */
+    void reset();
+
+    /**
+     * @brief Replaces the storage backend (FileBackend by default) and drops all tables.
+     */
+    void setBackend(std::unique_ptr<StorageBackend> backend);
+
+    /**
+     * @brief The storage backend, for queries that bypass the tables
+     * (StorageBackend::query()). Does not wait for writers.
+     */
+    std::shared_ptr<StorageBackend> backend() const;
+
+private:
+    DataStore();
+    ~DataStore();
+    DataStore(const DataStore &) = delete;
+    DataStore &operator=(const DataStore &) = delete;
+
+    DataSnapshotPtr current() const;
+
+    /**
+     * @brief Makes @p next the current snapshot.
+     * @param base Snapshot the writer derived @p next from; tables loaded
+     * since then are kept. nullptr drops them (reset()).
+     */
+    void publish(DataSnapshotPtr next, const DataSnapshotPtr &base);
+    DataSnapshotPtr loadMissing(const QStringList &tables);
+    DataSnapshotPtr catchUp(DataSnapshotPtr base, const QStringList &tables);
+    std::shared_ptr<TableKeyIndex> keyIndex(const QString &name, const TableSnapshotPtr &snapshot, const CsvTable &rows);
+    static void notify(const TableSnapshotPtr &before, const TableSnapshotPtr &after);
+
+    friend class DataBatch;
+
+    DataSnapshotPtr m_current;                ///< Guarded by m_publishMutex; readers use their thread's copy.
+    std::atomic<quint64> m_generation;        ///< Bumped on every publish, after m_current changed.
+    quint64 m_resets;                         ///< Counts reset()/setBackend(); guarded by m_publishMutex.
+    mutable QMutex m_publishMutex;            ///< Held only to swap or copy m_current.
+    QMutex m_writeMutex;                      ///< Serialises writers.
+    QMutex m_loadMutex;                       ///< Serialises loading of missing tables.
+    std::shared_ptr<StorageBackend> m_backend; ///< Used under m_writeMutex; replaced under both mutexes.
+    mutable QMutex m_backendMutex;            ///< Guards handing out m_backend through backend().
+    QHash<QString, std::shared_ptr<TableKeyIndex>> m_keyIndexes; ///< Guarded by m_writeMutex.
+};
+
+#endif // DATASTORE_HPP
@@ -0,0 +1,281 @@
+/**
+ * @file datastoretest.cpp
+ * @brief Concurrency tests of the DataStore's snapshot reads and batched commits.
+ *
+ * Writers move balance between accounts and record each transfer in two
+ * more tables, all in one commit. Readers check that every snapshot they
+ * take is a whole number of commits: the balances must follow from the
+ * journal, and the ledger must have exactly one line per journal entry.
+ */
+#include "datastore.hpp"
+#include "exceptions.hpp"
+#include "storagebackend.hpp"
+#include <QDir>
+#include <QFile>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtTest>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+static const int ACCOUNTS = 16;
+static const int START_BALANCE = 1000;
+static const int WRITERS = 4;
+static const int COMMITS_PER_WRITER = 200;
+static const int READERS = 8;
+static const int READER_WAIT_MS = 5000;
+
+static const char *const ACCOUNTS_TABLE = "accounts.csv"; // Format: ID,Balance
+static const char *const JOURNAL_TABLE = "journal.csv";   // Format: ID,From,To (upserted)
+static const char *const LEDGER_TABLE = "ledger.csv";     // Format: ID,Writer (appended)
+static const char *const NOTES_TABLE = "notes.csv";       // Format: ID,Text (read, never written)
+
+namespace
+{
+    QStringList tables() { return {ACCOUNTS_TABLE, JOURNAL_TABLE, LEDGER_TABLE}; }
+
+    /**
+     * @brief Why @p snap is not a whole number of commits, or an empty string.
+     */
+    QString checkConsistent(const DataSnapshotPtr &snap)
+    {
+        const CsvTable &accounts = snap->table(ACCOUNTS_TABLE)->getRows();
+        const CsvTable &journal = snap->table(JOURNAL_TABLE)->getRows();
+        const CsvTable &ledger = snap->table(LEDGER_TABLE)->getRows();
+        if (accounts.size() != ACCOUNTS)
+            return QString("%1 accounts").arg(accounts.size());
+        if (journal.size() != ledger.size())
+            return QString("%1 journal entries but %2 ledger lines").arg(journal.size()).arg(ledger.size());
+
+        QVector<int> expected(ACCOUNTS, START_BALANCE);
+        for (const QStringList &entry : journal)
+        {
+            expected[entry.value(1).toInt()]--;
+            expected[entry.value(2).toInt()]++;
+        }
+        for (int i = 0; i < ACCOUNTS; ++i)
+            if (accounts[i].value(1).toInt() != expected[i])
+                return QString("account %1 holds %2, journal says %3").arg(i).arg(accounts[i].value(1)).arg(expected[i]);
+        return QString();
+    }
+
+    /**
+     * @brief One transfer, written to all three tables through the three
+     * kinds of batch edit (rows(), apply() and append()).
+     */
+    void transfer(DataBatch &batch, int writer)
+    {
+        int n = batch.peek(JOURNAL_TABLE).size();
+        int from = n % ACCOUNTS;
+        int to = (n * 7 + 3) % ACCOUNTS;
+        if (to == from)
+            to = (to + 1) % ACCOUNTS;
+
+        CsvTable &accounts = batch.rows(ACCOUNTS_TABLE);
+        accounts[from][1] = QString::number(accounts[from][1].toInt() - 1);
+        accounts[to][1] = QString::number(accounts[to][1].toInt() + 1);
+        QString id = QString::number(n + 1);
+        if (!batch.apply(JOURNAL_TABLE, {TableChange(TableChange::Upsert, {id, QString::number(from), QString::number(to)})}))
+            throw Acadence::FileException("Journal entry not applied row by row");
+        batch.append(LEDGER_TABLE, {id, QString::number(writer)});
+    }
+}
+
+class DataStoreTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void readersNeverSeeTornBatches();
+    void readersDoNotWaitForWriters();
+    void failedCommitPublishesNothing();
+    void unwrittenTablesKeepTheirSnapshot();
+
+private:
+    std::unique_ptr<QTemporaryDir> dir;
+    QString previousDir;
+};
+
+void DataStoreTest::init()
+{
+    dir.reset(new QTemporaryDir);
+    QVERIFY(dir->isValid());
+    previousDir = QDir::currentPath();
+    QDir::setCurrent(dir->path());
+
+    QFile accounts(ACCOUNTS_TABLE);
+    QVERIFY(accounts.open(QIODevice::WriteOnly | QIODevice::Text));
+    for (int i = 0; i < ACCOUNTS; ++i)
+        accounts.write(QByteArray::number(i) + "," + QByteArray::number(START_BALANCE) + "\n");
+    accounts.close();
+    for (const char *name : {JOURNAL_TABLE, LEDGER_TABLE})
+    {
+        QFile empty(name);
+        QVERIFY(empty.open(QIODevice::WriteOnly));
+    }
+    QFile notes(NOTES_TABLE);
+    QVERIFY(notes.open(QIODevice::WriteOnly | QIODevice::Text));
+    notes.write("1,Not loaded until a reader asks\n");
+    // A fresh backend forgets what it parsed in the previous test's directory
+    DataStore::instance().setBackend(std::make_unique<FileBackend>());
+}
+
+void DataStoreTest::cleanup()
+{
+    DataStore::instance().reset();
+    QDir::setCurrent(previousDir);
+    dir.reset();
+}
+
+void DataStoreTest::readersNeverSeeTornBatches()
+{
+    DataStore &store = DataStore::instance();
+    QCOMPARE(checkConsistent(store.snapshot(tables())), QString());
+
+    std::atomic<bool> writing{true};
+    std::atomic<int> snapshots{0};
+    std::atomic<int> torn{0};
+    QString firstProblem; // Written once, by the reader that saw torn == 0 -> 1
+    std::vector<std::unique_ptr<QThread>> readers;
+    for (int r = 0; r < READERS; ++r)
+    {
+        readers.emplace_back(QThread::create([&]()
+                                             {
+            quint64 lastVersion = 0;
+            while (writing.load())
+            {
+                DataSnapshotPtr snap = store.snapshot(tables());
+                if (snap->getVersion() == lastVersion)
+                    continue;
+                lastVersion = snap->getVersion();
+                snapshots++;
+                QString problem = checkConsistent(snap);
+                if (!problem.isEmpty() && torn.fetch_add(1) == 0)
+                    firstProblem = problem;
+            } }));
+        readers.back()->start();
+    }
+
+    std::vector<std::unique_ptr<QThread>> writers;
+    for (int w = 0; w < WRITERS; ++w)
+    {
+        writers.emplace_back(QThread::create([&store, w]()
+                                             {
+            for (int i = 0; i < COMMITS_PER_WRITER; ++i)
+                store.commit([w](DataBatch &batch)
+                             { transfer(batch, w); }); }));
+        writers.back()->start();
+    }
+    for (auto &writer : writers)
+        writer->wait();
+    writing = false;
+    for (auto &reader : readers)
+        reader->wait();
+
+    QVERIFY2(torn == 0, qPrintable(firstProblem));
+    QVERIFY(snapshots > 0);
+    DataSnapshotPtr last = store.snapshot(tables());
+    QCOMPARE(int(last->table(JOURNAL_TABLE)->getRows().size()), WRITERS * COMMITS_PER_WRITER);
+    QCOMPARE(checkConsistent(last), QString());
+
+    // What reached the disk is the same whole number of commits
+    store.reset();
+    DataSnapshotPtr reloaded = store.snapshot(tables());
+    QCOMPARE(int(reloaded->table(LEDGER_TABLE)->getRows().size()), WRITERS * COMMITS_PER_WRITER);
+    QCOMPARE(checkConsistent(reloaded), QString());
+}
+
+void DataStoreTest::readersDoNotWaitForWriters()
+{
+    DataStore &store = DataStore::instance();
+    store.snapshot(tables());
+
+    // A commit that stays inside the writer lock until the readers are done
+    QSemaphore inside;
+    QSemaphore release;
+    std::unique_ptr<QThread> writer(QThread::create([&]()
+                                                    {
+        store.commit([&](DataBatch &batch)
+                     {
+            transfer(batch, 0);
+            inside.release();
+            release.acquire(); }); }));
+    writer->start();
+    bool entered = inside.tryAcquire(1, READER_WAIT_MS);
+    if (!entered)
+    {
+        release.release();
+        writer->wait();
+    }
+    QVERIFY(entered);
+
+    // Including a table nobody has loaded yet
+    std::atomic<int> reads{0};
+    std::atomic<bool> notesLoaded{false};
+    std::unique_ptr<QThread> reader(QThread::create([&]()
+                                                    {
+        notesLoaded = store.table(NOTES_TABLE)->getRows().size() == 1;
+        for (int i = 0; i < 1000; ++i)
+            if (store.snapshot(tables())->table(JOURNAL_TABLE)->getRows().isEmpty())
+                reads++; }));
+    reader->start();
+    bool finished = reader->wait(READER_WAIT_MS);
+    release.release();
+    writer->wait();
+    if (!finished)
+        reader->wait();
+
+    QVERIFY2(finished, "snapshot() blocked while a commit held the writer lock");
+    QVERIFY(notesLoaded.load());
+    QCOMPARE(reads.load(), 1000); // The open commit was not visible
+    DataSnapshotPtr after = store.snapshot();
+    QCOMPARE(int(after->table(JOURNAL_TABLE)->getRows().size()), 1);
+    QVERIFY2(after->table(NOTES_TABLE), "the commit dropped a table loaded while it ran");
+}
+
+void DataStoreTest::failedCommitPublishesNothing()
+{
+    DataStore &store = DataStore::instance();
+    DataSnapshotPtr before = store.snapshot(tables());
+
+    bool thrown = false;
+    try
+    {
+        store.commit([](DataBatch &batch)
+                     {
+            transfer(batch, 0);
+            throw Acadence::FileException("Abandoned"); });
+    }
+    catch (const Acadence::FileException &)
+    {
+        thrown = true;
+    }
+    QVERIFY(thrown);
+
+    DataSnapshotPtr after = store.snapshot(tables());
+    QCOMPARE(after->getVersion(), before->getVersion());
+    for (const QString &name : tables())
+        QCOMPARE(after->table(name), before->table(name));
+    store.reset();
+    QCOMPARE(int(store.snapshot(tables())->table(JOURNAL_TABLE)->getRows().size()), 0);
+}
+
+void DataStoreTest::unwrittenTablesKeepTheirSnapshot()
+{
+    DataStore &store = DataStore::instance();
+    TableSnapshotPtr notes = store.table(NOTES_TABLE);
+
+    store.commit([](DataBatch &batch)
+                 {
+        batch.append(LEDGER_TABLE, {"1", QString::number(batch.peek(NOTES_TABLE).size())}); });
+    QCOMPARE(store.table(NOTES_TABLE), notes);
+    QCOMPARE(int(store.table(LEDGER_TABLE)->getRows().size()), 1);
+}
+
+QTEST_GUILESS_MAIN(DataStoreTest)
+#include "datastoretest.moc"
@@ -0,0 +1,70 @@
+/**
+ * @file genmain.cpp
+ * @brief Entry point of acadence-gen, the synthetic dataset generator.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include "datagenerator.hpp"
+#include "exceptions.hpp"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("acadence-gen");
+    a.setOrganizationName("MyOrganization");
+
+    GeneratorOptions defaults;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes a consistent synthetic set of Acadence tables; the same seed and sizes give the same files.");
+    parser.addHelpOption();
+    QCommandLineOption dirOption("data-dir", "Directory to write the CSV files to.", "dir", QDir::currentPath());
+    QCommandLineOption seedOption("seed", "Random seed.", "n", QString::number(defaults.seed));
+    QCommandLineOption studentsOption("students", "Number of students.", "n", QString::number(defaults.students));
+    QCommandLineOption teachersOption("teachers", "Number of teachers (default: one per 25 students).", "n");
+    QCommandLineOption coursesOption("courses-per-semester", "Courses offered in each of the 8 semesters.", "n", QString::number(defaults.coursesPerSemester));
+    QCommandLineOption weeksOption("weeks", "Term length in weeks; each course meets twice a week.", "n", QString::number(defaults.weeks));
+    QCommandLineOption startOption("term-start", "First day of the term (yyyy-MM-dd).", "date", defaults.termStart.toString("yyyy-MM-dd"));
+    QCommandLineOption threadsOption("threads", "Worker threads (default: one per core).", "n");
+    for (const QCommandLineOption &option : {dirOption, seedOption, studentsOption, teachersOption, coursesOption, weeksOption, startOption, threadsOption})
+        parser.addOption(option);
+    parser.process(a);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    GeneratorOptions options;
+    options.seed = parser.value(seedOption).toULongLong();
+    options.students = parser.value(studentsOption).toInt();
+    options.teachers = parser.value(teachersOption).toInt();
+    options.coursesPerSemester = parser.value(coursesOption).toInt();
+    options.weeks = parser.value(weeksOption).toInt();
+    options.termStart = QDate::fromString(parser.value(startOption), "yyyy-MM-dd");
+    options.threads = parser.value(threadsOption).toInt();
+    if (!options.termStart.isValid())
+    {
+        err << "Invalid term start " << parser.value(startOption) << "\n";
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 total = 0;
+    try
+    {
+        DataGenerator(options).run(parser.value(dirOption), [&](const QString &fileName, qint64 rows)
+                                   {
+            total += rows;
+            out << fileName << ": " << rows << " rows (" << timer.elapsed() / 1000.0 << " s)\n";
+            out.flush(); });
+    }
+    catch (const Acadence::Exception &e)
+    {
+        err << "Generation failed: " << e.what() << "\n";
+        return 1;
+    }
+    out << total << " rows written in " << timer.elapsed() / 1000.0 << " s\n";
+    return 0;
+}
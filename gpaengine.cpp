@@ -0,0 +1,288 @@
+/**
+ * @file gpaengine.cpp
+ * @brief Incrementally maintained semester GPAs and CGPAs.
+ */
+#include "gpaengine.hpp"
+#include "storagebackend.hpp"
+#include <QMutexLocker>
+#include <algorithm>
+#include <utility>
+
+static const QStringList SOURCE_TABLES = {"courses.csv", "assessments.csv", "grades.csv", "gradescale.csv"};
+
+GradeScale GradeScale::standard()
+{
+    GradeScale scale;
+    scale.steps = {{80, 4.00, "A+"}, {75, 3.75, "A"}, {70, 3.50, "A-"}, {65, 3.25, "B+"}, {60, 3.00, "B"},
+                   {55, 2.75, "B-"}, {50, 2.50, "C+"}, {45, 2.25, "C"}, {40, 2.00, "D"}};
+    return scale;
+}
+
+GradeScale GradeScale::fromRows(const CsvTable &rows)
+{
+    // Format: MinPercent,Points,Letter
+    GradeScale scale;
+    for (const auto &row : rows)
+    {
+        bool percentOk = false, pointsOk = false;
+        if (row.size() < 3)
+            continue;
+        GradePoint step{row[0].toDouble(&percentOk), row[1].toDouble(&pointsOk), row[2]};
+        if (percentOk && pointsOk)
+            scale.steps.append(step);
+    }
+    if (scale.steps.isEmpty())
+        return standard();
+    std::sort(scale.steps.begin(), scale.steps.end(), [](const GradePoint &a, const GradePoint &b)
+              { return a.minPercent > b.minPercent; });
+    return scale;
+}
+
+GradePoint GradeScale::lookup(double percent) const
+{
+    for (const GradePoint &step : steps)
+        if (percent >= step.minPercent)
+            return step;
+    return {0, 0.0, "F"};
+}
+
+GpaEngine &GpaEngine::instance()
+{
+    static GpaEngine engine;
+    return engine;
+}
+
+GpaRecord GpaEngine::forStudent(int studentId)
+{
+    std::shared_ptr<StorageBackend> backend = DataStore::instance().backend();
+    if (backend->isRemote())
+    {
+        // The server's engine holds the grades; this client need not load them
+        QByteArray request;
+        QDataStream out(&request, QIODevice::WriteOnly);
+        out << qint32(studentId);
+        QByteArray reply = backend->query(Protocol::StudentGpa, request);
+        QDataStream in(reply);
+        GpaRecord record = Protocol::readGpa(in);
+        if (in.status() != QDataStream::Ok)
+            throw Acadence::FileException("Malformed GPA from acadence-server");
+        return record;
+    }
+
+    QMutexLocker locker(&mutex);
+    sync();
+    return records.value(studentId);
+}
+
+void GpaEngine::sync()
+{
+    DataSnapshotPtr snap = DataStore::instance().snapshot(SOURCE_TABLES);
+    bool rescaled = snap->table("gradescale.csv") != scaleTable;
+    bool restructured = snap->table("courses.csv") != coursesTable || snap->table("assessments.csv") != assessmentsTable;
+    bool regraded = snap->table("grades.csv") != gradesTable;
+    if (!rescaled && !restructured && !regraded)
+        return;
+
+    QSet<int> dirty;
+    if (rescaled)
+    {
+        scaleTable = snap->table("gradescale.csv");
+        scale = GradeScale::fromRows(scaleTable->getRows());
+    }
+    if (restructured)
+        dirty = rebuildStructure(snap);
+    if (regraded)
+    {
+        gradesTable = snap->table("grades.csv");
+        rebuildMarks();
+    }
+    if (restructured || regraded)
+        dirty.unite(rebuildEarned());
+
+    if (rescaled || regraded)
+    {
+        // Every student may have moved; recompute all of them
+        dirty.clear();
+        for (auto it = earned.constBegin(); it != earned.constEnd(); ++it)
+            dirty.insert(it.key());
+        for (auto it = records.constBegin(); it != records.constEnd(); ++it)
+            dirty.insert(it.key());
+    }
+    for (int studentId : dirty)
+        recompute(studentId);
+}
+
+QSet<int> GpaEngine::rebuildStructure(const DataSnapshotPtr &snap)
+{
+    coursesTable = snap->table("courses.csv");
+    assessmentsTable = snap->table("assessments.csv");
+
+    QHash<int, CourseNode> previous;
+    previous.swap(courses);
+    assessments.clear();
+
+    // Format: ID,Code,Name,TeacherID,Semester,Credits
+    for (const auto &row : coursesTable->getRows())
+    {
+        if (row.size() < 6)
+            continue;
+        int courseId = row[0].toInt();
+        CourseNode &course = courses[courseId];
+        // Kept so rebuildEarned() can tell which students' courses actually moved
+        course.students = previous.value(courseId).students;
+        course.gradedMaxMarks = previous.value(courseId).gradedMaxMarks;
+        course.semester = row[4].toInt();
+        course.credits = row[5].toInt();
+    }
+
+    // Format: ID,CourseID,Title,Type,Date,MaxMarks
+    for (const auto &row : assessmentsTable->getRows())
+    {
+        if (row.size() < 6)
+            continue;
+        int courseId = row[1].toInt();
+        assessments.insert(row[0].toInt(), {courseId, row[5].toInt()});
+        auto course = courses.find(courseId);
+        if (course != courses.end())
+            course->maxMarks += row[5].toInt();
+    }
+
+    // Only the students of a course whose grading inputs changed need new GPAs
+    QSet<int> dirty;
+    for (auto it = previous.constBegin(); it != previous.constEnd(); ++it)
+    {
+        auto now = courses.constFind(it.key());
+        if (now == courses.constEnd() || now->semester != it->semester || now->credits != it->credits ||
+            now->maxMarks != it->maxMarks)
+            dirty.unite(it->students);
+    }
+    return dirty;
+}
+
+void GpaEngine::rebuildMarks()
+{
+    // Format: StudentID,AssessmentID,Marks
+    marks.clear();
+    marks.reserve(gradesTable->getRows().size());
+    for (const auto &row : gradesTable->getRows())
+        if (row.size() >= 3)
+            marks.insert(cellKey(row[0].toInt(), row[1].toInt()), row[2].toDouble());
+}
+
+QSet<int> GpaEngine::rebuildEarned()
+{
+    QHash<int, QSet<int>> oldStudents;
+    QHash<int, int> oldGraded;
+    for (auto it = courses.begin(); it != courses.end(); ++it)
+    {
+        oldStudents.insert(it.key(), std::exchange(it->students, {}));
+        oldGraded.insert(it.key(), std::exchange(it->gradedMaxMarks, 0));
+    }
+    earned.clear();
+    markCounts.clear();
+
+    for (auto it = marks.constBegin(); it != marks.constEnd(); ++it)
+    {
+        int studentId = int(it.key() >> 32);
+        int assessmentId = int(quint32(it.key()));
+        auto assessment = assessments.constFind(assessmentId);
+        if (assessment == assessments.constEnd())
+            continue;
+        auto course = courses.find(assessment->first);
+        if (course == courses.end())
+            continue;
+        earned[studentId][assessment->first] += it.value();
+        course->students.insert(studentId);
+        if (markCounts[assessmentId]++ == 0)
+            course->gradedMaxMarks += assessment->second;
+    }
+
+    // A student gained or lost a course, e.g. through an assessment moving
+    // between courses, or the course's graded maximum moved
+    QSet<int> dirty;
+    for (auto it = courses.constBegin(); it != courses.constEnd(); ++it)
+    {
+        QSet<int> before = oldStudents.value(it.key());
+        if (before != it->students || oldGraded.value(it.key()) != it->gradedMaxMarks)
+            dirty.unite(before).unite(it->students);
+    }
+    return dirty;
+}
+
+void GpaEngine::recompute(int studentId)
+{
+    GpaRecord record;
+    QMap<int, double> semesterPoints;
+    double totalPoints = 0;
+
+    const QHash<int, double> byCourse = earned.value(studentId);
+    for (auto it = byCourse.constBegin(); it != byCourse.constEnd(); ++it)
+    {
+        auto course = courses.constFind(it.key());
+        if (course == courses.constEnd() || course->gradedMaxMarks <= 0 || course->credits <= 0)
+            continue;
+        double points = scale.lookup(it.value() * 100.0 / course->gradedMaxMarks).points * course->credits;
+        semesterPoints[course->semester] += points;
+        record.semesterCredits[course->semester] += course->credits;
+        totalPoints += points;
+        record.credits += course->credits;
+    }
+
+    if (record.credits == 0)
+    {
+        records.remove(studentId);
+        return;
+    }
+    for (auto it = semesterPoints.constBegin(); it != semesterPoints.constEnd(); ++it)
+        record.semesterGpa.insert(it.key(), it.value() / record.semesterCredits.value(it.key()));
+    record.cgpa = totalPoints / record.credits;
+    records.insert(studentId, record);
+}
+
+void GpaEngine::recordGrades(int assessmentId, const QMap<int, double> &marksByStudent, quint64 version)
+{
+    // A client of acadence-server keeps no engine state; forStudent() asks the server
+    if (DataStore::instance().backend()->isRemote())
+        return;
+
+    TableSnapshotPtr saved = DataStore::instance().snapshot({"grades.csv"})->table("grades.csv");
+
+    QMutexLocker locker(&mutex);
+    // Patch only if this save is the one grades.csv change since the engine last
+    // caught up; otherwise the next sync() rebuilds from the table
+    if (!gradesTable || saved->getVersion() != version || saved->getSequence() != gradesTable->getSequence() + 1)
+        return;
+    auto assessment = assessments.constFind(assessmentId);
+    if (assessment == assessments.constEnd() || !courses.contains(assessment->first))
+        return;
+
+    int courseId = assessment->first;
+    CourseNode &course = courses[courseId];
+    // The first marks of an assessment raise the course's graded maximum for everyone in it
+    bool firstMarks = markCounts.value(assessmentId) == 0 && !marksByStudent.isEmpty();
+    if (firstMarks)
+        course.gradedMaxMarks += assessment->second;
+
+    for (auto it = marksByStudent.constBegin(); it != marksByStudent.constEnd(); ++it)
+    {
+        auto cell = marks.find(cellKey(it.key(), assessmentId));
+        double previous = cell != marks.end() ? cell.value() : 0.0;
+        if (cell != marks.end())
+        {
+            cell.value() = it.value();
+        }
+        else
+        {
+            marks.insert(cellKey(it.key(), assessmentId), it.value());
+            markCounts[assessmentId]++;
+        }
+        earned[it.key()][courseId] += it.value() - previous;
+        course.students.insert(it.key());
+        if (!firstMarks)
+            recompute(it.key());
+    }
+    if (firstMarks)
+        for (int studentId : course.students)
+            recompute(studentId);
+    gradesTable = saved;
+}
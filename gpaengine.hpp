@@ -0,0 +1,141 @@
+#ifndef GPAENGINE_HPP
+#define GPAENGINE_HPP
+
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include "datastore.hpp"
+
+/**
+ * @brief One step of a grade-point scale.
+ */
+struct GradePoint
+{
+    double minPercent; ///< Lowest course percentage that earns this grade.
+    double points;
+    QString letter;
+};
+
+/**
+ * @brief Maps a course percentage to grade points.
+ */
+class GradeScale
+{
+public:
+    /**
+     * @brief 80% A+ 4.00 down to 40% D 2.00, F below.
+     */
+    static GradeScale standard();
+
+    /**
+     * @brief Scale from gradescale.csv rows; the standard one if none is usable.
+     */
+    static GradeScale fromRows(const CsvTable &rows);
+
+    /**
+     * @brief The highest step whose threshold @p percent reaches (F if none).
+     */
+    GradePoint lookup(double percent) const;
+
+private:
+    QVector<GradePoint> steps; ///< Highest threshold first.
+};
+
+/**
+ * @brief A student's grade point averages.
+ */
+struct GpaRecord
+{
+    QMap<int, double> semesterGpa; ///< Semester -> GPA over its graded courses.
+    QMap<int, int> semesterCredits;
+    double cgpa = 0.0;
+    int credits = 0; ///< Credits of every graded course; 0 if none is graded yet.
+};
+
+/**
+ * @brief Credit-weighted semester GPAs and CGPAs of every student, kept
+ * up to date as grades change.
+ *
+ * A course's grade comes from the student's total marks over the course's
+ * assessments graded so far (those with at least one recorded mark), as a
+ * percentage of their maximum, looked up in the GradeScale from
+ * gradescale.csv; assessments not held yet do not count against anyone.
+ * Courses in which the student has no recorded mark are not graded yet and
+ * carry no credits.
+ *
+ * The engine keeps each student's marks per course and, for every course,
+ * the students graded in it. Saved grades (recordGrades()) touch only the
+ * students whose marks changed (or, for an assessment's first marks, the
+ * course's students); a change to a course's credits, semester or
+ * assessments recomputes only that course's students; a new scale or a
+ * grades.csv change made elsewhere (e.g. a bulk import) rebuilds the marks
+ * in one pass. Nothing is written back to students.csv.
+ */
+class GpaEngine
+{
+public:
+    static GpaEngine &instance();
+
+    /**
+     * @brief Current GPAs of a student, catching up with the tables first.
+     * A client of acadence-server asks the server's engine instead.
+     */
+    GpaRecord forStudent(int studentId);
+
+    /**
+     * @brief Applies marks saved for one assessment.
+     * @param version Store version returned by the commit that saved them.
+     */
+    void recordGrades(int assessmentId, const QMap<int, double> &marksByStudent, quint64 version);
+
+private:
+    GpaEngine() = default;
+
+    struct CourseNode
+    {
+        int semester = 0;
+        int credits = 0;
+        int maxMarks = 0;       ///< Sum over the course's assessments.
+        int gradedMaxMarks = 0; ///< Sum over the assessments with at least one mark.
+        QSet<int> students;     ///< Students with at least one mark in the course.
+    };
+
+    static quint64 cellKey(int studentId, int assessmentId) { return (quint64(quint32(studentId)) << 32) | quint32(assessmentId); }
+
+    void sync();
+
+    /**
+     * @return Students of the courses whose semester, credits or maximum marks changed.
+     */
+    QSet<int> rebuildStructure(const DataSnapshotPtr &snap);
+    void rebuildMarks();
+
+    /**
+     * @return Students who gained or lost a graded course, or whose course
+     * had an assessment graded for the first time.
+     */
+    QSet<int> rebuildEarned();
+
+    void recompute(int studentId);
+
+    QMutex mutex; ///< Guards everything below.
+    GradeScale scale = GradeScale::standard();
+
+    QHash<int, CourseNode> courses;
+    QHash<int, QPair<int, int>> assessments; ///< Assessment ID -> (course ID, max marks).
+    QHash<quint64, double> marks;            ///< cellKey() -> recorded marks.
+    QHash<int, int> markCounts;              ///< Assessment ID -> marks recorded for it.
+    QHash<int, QHash<int, double>> earned;   ///< Student -> course -> sum of marks.
+    QHash<int, GpaRecord> records;           ///< Students with at least one graded course.
+
+    // Tables the state was derived from; a different snapshot means it is stale
+    TableSnapshotPtr coursesTable;
+    TableSnapshotPtr assessmentsTable;
+    TableSnapshotPtr gradesTable;
+    TableSnapshotPtr scaleTable;
+};
+
+#endif // GPAENGINE_HPP
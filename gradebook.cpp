@@ -0,0 +1,281 @@
+/**
+ * @file gradebook.cpp
+ * @brief Cached per-course matrix of marks.
+ */
+#include "gradebook.hpp"
+#include <QMutex>
+#include <QMutexLocker>
+
+static const QStringList SOURCE_TABLES = {"courses.csv", "students.csv", "assessments.csv", "grades.csv"};
+
+static QMutex cacheMutex;
+static QHash<int, std::shared_ptr<Gradebook>> cache; ///< Course ID -> gradebook, guarded by cacheMutex.
+
+Gradebook::Gradebook(int courseId) : courseId(courseId), semester(-1) {}
+
+void Gradebook::prepare(const DataSnapshotPtr &snap)
+{
+    courses = snap->table("courses.csv");
+    students = snap->table("students.csv");
+    assessments = snap->table("assessments.csv");
+    grades = snap->table("grades.csv");
+
+    // Format: ID,Code,Name,TeacherID,Semester,Credits
+    for (const auto &row : courses->getRows())
+    {
+        if (row.size() >= 6 && row[0].toInt() == courseId)
+        {
+            semester = row[4].toInt();
+            break;
+        }
+    }
+
+    // Format: ID,Name,Email,Username,Password,Dept,Batch,Sem,DateAdmission,CGPA
+    for (const auto &row : students->getRows())
+    {
+        if (row.size() >= 8 && row[7].toInt() == semester)
+        {
+            studentIndex.insert(row[0].toInt(), studentIds.size());
+            studentIds.append(row[0].toInt());
+            studentNames.append(row[1]);
+            int d = departments.indexOf(row[5]);
+            if (d < 0)
+            {
+                d = departments.size();
+                departments.append(row[5]);
+            }
+            studentDepts.append(d);
+        }
+    }
+
+    // Format: ID,CourseID,Title,Type,Date,MaxMarks
+    for (const auto &row : assessments->getRows())
+    {
+        if (row.size() >= 6 && row[1].toInt() == courseId)
+        {
+            assessmentIndex.insert(row[0].toInt(), assessmentIds.size());
+            assessmentIds.append(row[0].toInt());
+            assessmentTitles.append(row[2]);
+            maxMarks.append(row[5].toInt());
+        }
+    }
+
+    int cells = studentIds.size() * assessmentIds.size();
+    marks.fill(0.0, cells);
+    present.resize(cells);
+    stats.fill(GradeStats(), assessmentIds.size() * departments.size());
+}
+
+QVector<std::shared_ptr<Gradebook>> Gradebook::build(const QVector<int> &courseIds, const DataSnapshotPtr &snap)
+{
+    QVector<std::shared_ptr<Gradebook>> books;
+    QHash<int, Gradebook *> byAssessment; ///< Assessment ID -> the book holding it.
+    for (int courseId : courseIds)
+    {
+        std::shared_ptr<Gradebook> book(new Gradebook(courseId));
+        book->prepare(snap);
+        if (!book->studentIds.isEmpty())
+            for (int id : book->assessmentIds)
+                byAssessment.insert(id, book.get());
+        books.append(book);
+    }
+    if (byAssessment.isEmpty())
+        return books;
+
+    // Format: StudentID,AssessmentID,Marks - one pass, two hash lookups per row
+    const TableSnapshotPtr &grades = books.first()->grades;
+    for (const auto &row : grades->getRows())
+    {
+        if (row.size() < 3)
+            continue;
+        Gradebook *book = byAssessment.value(row[1].toInt(), nullptr);
+        if (!book)
+            continue;
+        int s = book->findStudent(row[0].toInt());
+        if (s >= 0)
+            book->setMarks(s, book->findAssessment(row[1].toInt()), row[2].toDouble());
+    }
+    return books;
+}
+
+bool Gradebook::isCurrent(const DataSnapshotPtr &snap) const
+{
+    // Unchanged tables keep their snapshot from one store version to the next
+    return courses == snap->table("courses.csv") && students == snap->table("students.csv") &&
+           assessments == snap->table("assessments.csv") && grades == snap->table("grades.csv");
+}
+
+void Gradebook::setMarks(int s, int a, double value)
+{
+    int cell = s * assessmentIds.size() + a;
+    GradeStats &summary = cellStats(s, a);
+    bool wasExtreme = false;
+    if (present.testBit(cell))
+    {
+        double old = toPercent(a, marks[cell]);
+        wasExtreme = old <= summary.getMin() || old >= summary.getMax();
+        summary.remove(old);
+    }
+    marks[cell] = value;
+    present.setBit(cell);
+    summary.add(toPercent(a, value));
+    if (wasExtreme)
+        refreshBounds(s, a);
+}
+
+void Gradebook::refreshBounds(int s, int a)
+{
+    // Only after an extreme mark changed: rescan the one column for that department
+    double lowest = 0, highest = 0;
+    bool any = false;
+    for (int other = 0; other < studentIds.size(); ++other)
+    {
+        if (studentDepts[other] != studentDepts[s] || !hasMarks(other, a))
+            continue;
+        double percent = toPercent(a, getMarks(other, a));
+        lowest = any ? qMin(lowest, percent) : percent;
+        highest = any ? qMax(highest, percent) : percent;
+        any = true;
+    }
+    cellStats(s, a).setBounds(lowest, highest);
+}
+
+std::shared_ptr<const Gradebook> Gradebook::forCourse(int courseId)
+{
+    return forCourses({courseId}).first();
+}
+
+QVector<std::shared_ptr<const Gradebook>> Gradebook::forCourses(const QVector<int> &courseIds)
+{
+    DataSnapshotPtr snap = DataStore::instance().snapshot(SOURCE_TABLES);
+
+    QMutexLocker locker(&cacheMutex);
+    QVector<int> missing;
+    for (int courseId : courseIds)
+    {
+        auto it = cache.constFind(courseId);
+        if (it == cache.constEnd() || !it.value()->isCurrent(snap))
+            missing.append(courseId);
+    }
+    for (const std::shared_ptr<Gradebook> &book : build(missing, snap))
+        cache.insert(book->courseId, book);
+
+    QVector<std::shared_ptr<const Gradebook>> books;
+    books.reserve(courseIds.size());
+    for (int courseId : courseIds)
+        books.append(cache.value(courseId));
+    return books;
+}
+
+GradeStats Gradebook::departmentStats(const QString &department)
+{
+    // Format: ID,Code,Name,TeacherID,Semester,Credits
+    QVector<int> courseIds;
+    for (const auto &row : DataStore::instance().snapshot({"courses.csv"})->table("courses.csv")->getRows())
+        if (row.size() >= 6)
+            courseIds.append(row[0].toInt());
+
+    GradeStats total;
+    for (const auto &book : forCourses(courseIds))
+        total.merge(department.isEmpty() ? book->courseStats() : book->courseStats(department));
+    return total;
+}
+
+void Gradebook::recordMarks(int assessmentId, const QMap<int, double> &marksByStudent, quint64 version)
+{
+    TableSnapshotPtr saved = DataStore::instance().snapshot({"grades.csv"})->table("grades.csv");
+
+    QMutexLocker locker(&cacheMutex);
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        std::shared_ptr<Gradebook> &book = it.value();
+        int a = book->findAssessment(assessmentId);
+
+        // Patch only if this save is the one grades.csv change after the book's copy;
+        // otherwise other writes happened in between and a rebuild picks them up
+        bool follows = saved->getVersion() == version && saved->getSequence() == book->grades->getSequence() + 1;
+        if (a < 0)
+        {
+            // Other courses' marks did not change, so their books stay current
+            if (follows)
+            {
+                if (book.use_count() > 1)
+                    book = std::make_shared<Gradebook>(*book);
+                book->grades = saved;
+            }
+            ++it;
+            continue;
+        }
+        if (!follows)
+        {
+            it = cache.erase(it);
+            continue;
+        }
+
+        if (book.use_count() > 1)
+            book = std::make_shared<Gradebook>(*book); // Readers keep the old, immutable one
+        for (auto m = marksByStudent.constBegin(); m != marksByStudent.constEnd(); ++m)
+        {
+            int s = book->findStudent(m.key());
+            if (s >= 0)
+                book->setMarks(s, a, m.value());
+        }
+        book->grades = saved;
+        ++it;
+    }
+}
+
+double Gradebook::totalMarks(int s) const
+{
+    double total = 0;
+    int base = s * assessmentIds.size();
+    for (int a = 0; a < assessmentIds.size(); ++a)
+        if (present.testBit(base + a))
+            total += marks[base + a];
+    return total;
+}
+
+int Gradebook::totalMaxMarks() const
+{
+    int total = 0;
+    for (int max : maxMarks)
+        total += max;
+    return total;
+}
+
+QVector<double> Gradebook::assessmentMarks(int a) const
+{
+    QVector<double> column;
+    column.reserve(studentIds.size());
+    for (int s = 0; s < studentIds.size(); ++s)
+        if (hasMarks(s, a))
+            column.append(getMarks(s, a));
+    return column;
+}
+
+GradeStats Gradebook::assessmentStats(int a) const
+{
+    GradeStats total;
+    for (int d = 0; d < departments.size(); ++d)
+        total.merge(stats[a * departments.size() + d]);
+    return total;
+}
+
+GradeStats Gradebook::courseStats() const
+{
+    GradeStats total;
+    for (const GradeStats &summary : stats)
+        total.merge(summary);
+    return total;
+}
+
+GradeStats Gradebook::courseStats(const QString &department) const
+{
+    GradeStats total;
+    int d = departments.indexOf(department);
+    if (d < 0)
+        return total;
+    for (int a = 0; a < assessmentIds.size(); ++a)
+        total.merge(stats[a * departments.size() + d]);
+    return total;
+}
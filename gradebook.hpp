@@ -0,0 +1,152 @@
+#ifndef GRADEBOOK_HPP
+#define GRADEBOOK_HPP
+
+#include <QBitArray>
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "datastore.hpp"
+#include "gradestats.hpp"
+
+/**
+ * @brief Marks of one course as a dense students × assessments matrix.
+ *
+ * The students are those in the course's semester, the assessments those
+ * of the course. A gradebook is built in a single pass over grades.csv and
+ * cached per course; grade saves made through AcadenceManager::addGrades()
+ * are applied to the cached matrix in place, so regrading a course reads
+ * no table at all. Any other change to the tables involved is noticed on
+ * the next forCourse() and the gradebook rebuilt.
+ *
+ * Alongside the marks it keeps a GradeStats summary per assessment and
+ * student department, updated with every mark set, so assessment, course
+ * and department distributions are merges of summaries rather than scans.
+ *
+ * Gradebooks handed out are immutable; share them freely between threads.
+ */
+class Gradebook
+{
+public:
+    /**
+     * @brief The current gradebook of a course (built on first use).
+     */
+    static std::shared_ptr<const Gradebook> forCourse(int courseId);
+
+    /**
+     * @brief The current gradebooks of several courses; those not cached
+     * are built together in a single pass over grades.csv.
+     */
+    static QVector<std::shared_ptr<const Gradebook>> forCourses(const QVector<int> &courseIds);
+
+    /**
+     * @brief Distribution of marks (as percentages) over every course.
+     * @param department Students' department (e.g. "CSE"), or empty for all.
+     */
+    static GradeStats departmentStats(const QString &department);
+
+    /**
+     * @brief Applies saved marks to the cached gradebooks.
+     * @param version Store version returned by the commit that saved them.
+     */
+    static void recordMarks(int assessmentId, const QMap<int, double> &marksByStudent, quint64 version);
+
+    int getCourseId() const { return courseId; }
+    int getSemester() const { return semester; }
+
+    int studentCount() const { return studentIds.size(); }
+    int getStudentId(int s) const { return studentIds[s]; }
+    QString getStudentName(int s) const { return studentNames[s]; }
+    int findStudent(int studentId) const { return studentIndex.value(studentId, -1); }
+
+    int assessmentCount() const { return assessmentIds.size(); }
+    int getAssessmentId(int a) const { return assessmentIds[a]; }
+    QString getAssessmentTitle(int a) const { return assessmentTitles[a]; }
+    int getMaxMarks(int a) const { return maxMarks[a]; }
+    int findAssessment(int assessmentId) const { return assessmentIndex.value(assessmentId, -1); }
+
+    /**
+     * @brief True if marks were recorded for the student in the assessment.
+     */
+    bool hasMarks(int s, int a) const { return present.testBit(s * assessmentIds.size() + a); }
+
+    /**
+     * @brief The recorded marks, or 0 if there are none.
+     */
+    double getMarks(int s, int a) const { return marks[s * assessmentIds.size() + a]; }
+
+    /**
+     * @brief Sum of the student's recorded marks over every assessment.
+     */
+    double totalMarks(int s) const;
+
+    /**
+     * @brief Sum of the maximum marks of every assessment.
+     */
+    int totalMaxMarks() const;
+
+    /**
+     * @brief The recorded marks of one assessment, in student order.
+     */
+    QVector<double> assessmentMarks(int a) const;
+
+    /**
+     * @brief Marks as a percentage of the assessment's maximum.
+     */
+    double toPercent(int a, double value) const { return maxMarks[a] > 0 ? value * 100.0 / maxMarks[a] : 0.0; }
+
+    /**
+     * @brief Distribution of one assessment's recorded marks, as percentages.
+     */
+    GradeStats assessmentStats(int a) const;
+
+    /**
+     * @brief Distribution of every recorded mark of the course, as percentages.
+     */
+    GradeStats courseStats() const;
+
+    /**
+     * @brief Like courseStats(), for the students of one department only.
+     */
+    GradeStats courseStats(const QString &department) const;
+
+private:
+    explicit Gradebook(int courseId);
+
+    /**
+     * @brief Builds the gradebooks of several courses; marks come from one grades.csv pass.
+     */
+    static QVector<std::shared_ptr<Gradebook>> build(const QVector<int> &courseIds, const DataSnapshotPtr &snap);
+    void prepare(const DataSnapshotPtr &snap);
+    bool isCurrent(const DataSnapshotPtr &snap) const;
+    void setMarks(int s, int a, double value);
+    GradeStats &cellStats(int s, int a) { return stats[a * departments.size() + studentDepts[s]]; }
+    void refreshBounds(int s, int a);
+
+    int courseId;
+    int semester;
+
+    QVector<int> studentIds;
+    QStringList studentNames;
+    QHash<int, int> studentIndex; ///< Student ID -> row.
+    QVector<int> studentDepts;    ///< Row -> index into departments.
+    QStringList departments;
+
+    QVector<int> assessmentIds;
+    QStringList assessmentTitles;
+    QVector<int> maxMarks;
+    QHash<int, int> assessmentIndex; ///< Assessment ID -> column.
+
+    QVector<double> marks; ///< Row-major, one row per student.
+    QBitArray present;     ///< Which entries of marks were recorded.
+    QVector<GradeStats> stats; ///< One per assessment and department, assessment-major.
+
+    // Tables the matrix was built from; a different snapshot means it is stale
+    TableSnapshotPtr courses;
+    TableSnapshotPtr students;
+    TableSnapshotPtr assessments;
+    TableSnapshotPtr grades;
+};
+
+#endif // GRADEBOOK_HPP
@@ -0,0 +1,142 @@
+/**
+ * @file gradestats.cpp
+ * @brief Welford running statistics with a mergeable histogram sketch.
+ */
+#include "gradestats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const double BIN_WIDTH = 100.0 / GradeStats::BINS;
+
+GradeStats::GradeStats()
+    : count(0), mean(0.0), m2(0.0), min(std::numeric_limits<double>::max()),
+      max(std::numeric_limits<double>::lowest()), boundsExact(true)
+{
+    bins.fill(0);
+}
+
+int GradeStats::binOf(double percent)
+{
+    return std::clamp(static_cast<int>(percent / BIN_WIDTH), 0, BINS - 1);
+}
+
+void GradeStats::add(double percent)
+{
+    count++;
+    double delta = percent - mean;
+    mean += delta / count;
+    m2 += delta * (percent - mean);
+    min = std::min(min, percent);
+    max = std::max(max, percent);
+    bins[binOf(percent)]++;
+}
+
+void GradeStats::remove(double percent)
+{
+    if (count <= 1)
+    {
+        *this = GradeStats();
+        return;
+    }
+    // Welford's update run backwards
+    double oldMean = (mean * count - percent) / (count - 1);
+    m2 = std::max(0.0, m2 - (percent - mean) * (percent - oldMean));
+    mean = oldMean;
+    count--;
+    bins[binOf(percent)]--;
+    if (percent <= min || percent >= max)
+        boundsExact = false;
+}
+
+void GradeStats::merge(const GradeStats &other)
+{
+    if (other.count == 0)
+        return;
+    if (count == 0)
+    {
+        *this = other;
+        return;
+    }
+    // Chan et al.'s parallel combination of two Welford summaries
+    int total = count + other.count;
+    double delta = other.mean - mean;
+    m2 += other.m2 + delta * delta * (double(count) * other.count / total);
+    mean += delta * other.count / total;
+    count = total;
+    min = std::min(getMin(), other.getMin());
+    max = std::max(getMax(), other.getMax());
+    boundsExact = boundsExact && other.boundsExact;
+    for (int i = 0; i < BINS; ++i)
+        bins[i] += other.bins[i];
+}
+
+void GradeStats::setBounds(double lowest, double highest)
+{
+    min = lowest;
+    max = highest;
+    boundsExact = true;
+}
+
+double GradeStats::getStdDev() const
+{
+    return std::sqrt(getVariance());
+}
+
+double GradeStats::getMin() const
+{
+    if (count == 0)
+        return 0.0;
+    if (boundsExact)
+        return min;
+    for (int i = 0; i < BINS; ++i)
+        if (bins[i] > 0)
+            return i * BIN_WIDTH;
+    return 0.0;
+}
+
+double GradeStats::getMax() const
+{
+    if (count == 0)
+        return 0.0;
+    if (boundsExact)
+        return max;
+    for (int i = BINS - 1; i >= 0; --i)
+        if (bins[i] > 0)
+            return (i + 1) * BIN_WIDTH;
+    return 0.0;
+}
+
+double GradeStats::percentile(double fraction) const
+{
+    if (count == 0)
+        return 0.0;
+    double rank = std::clamp(fraction, 0.0, 1.0) * count;
+    int seen = 0;
+    for (int i = 0; i < BINS; ++i)
+    {
+        if (bins[i] == 0)
+            continue;
+        if (seen + bins[i] >= rank)
+        {
+            double value = (i + (rank - seen) / bins[i]) * BIN_WIDTH;
+            return std::clamp(value, getMin(), getMax()); // The bin may be wider than the data
+        }
+        seen += bins[i];
+    }
+    return getMax();
+}
+
+QVector<int> GradeStats::histogram(int buckets) const
+{
+    QVector<int> result(std::max(1, buckets), 0);
+    for (int i = 0; i < BINS; ++i)
+        result[i * result.size() / BINS] += bins[i];
+    return result;
+}
+
+double GradeStats::zScore(double percent) const
+{
+    double sd = getStdDev();
+    return sd > 0 ? (percent - mean) / sd : 0.0;
+}
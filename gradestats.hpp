@@ -0,0 +1,83 @@
+#ifndef GRADESTATS_HPP
+#define GRADESTATS_HPP
+
+#include <QVector>
+#include <array>
+
+/**
+ * @brief Running summary of a set of marks, as percentages of the maximum.
+ *
+ * Count, mean and variance are kept with Welford's method; a fixed-width
+ * histogram of 200 half-percent bins doubles as a quantile sketch. Marks
+ * can be added and removed one at a time (a changed mark is a removal
+ * and an addition), and two summaries merge exactly, so per-assessment
+ * summaries combine into course or department summaries without looking
+ * at a single mark again.
+ */
+class GradeStats
+{
+public:
+    static const int BINS = 200;
+
+    GradeStats();
+
+    /**
+     * @param percent Marks as a percentage of the maximum; values outside
+     * 0-100 count towards the mean but land in the first or last bin.
+     */
+    void add(double percent);
+
+    /**
+     * @brief Takes back a value passed to add() earlier.
+     *
+     * If it was the smallest or largest value, getMin()/getMax() fall back
+     * to bin precision until setBounds() is called.
+     */
+    void remove(double percent);
+
+    /**
+     * @brief Adds every value of another summary.
+     */
+    void merge(const GradeStats &other);
+
+    /**
+     * @brief Restores exact bounds after a remove(), e.g. from the marks themselves.
+     */
+    void setBounds(double min, double max);
+
+    int getCount() const { return count; }
+    double getMean() const { return mean; }
+    double getVariance() const { return count > 0 ? m2 / count : 0.0; }
+    double getStdDev() const;
+    double getMin() const;
+    double getMax() const;
+
+    /**
+     * @brief The value below which @p fraction (0-1) of the values fall,
+     * interpolated within its bin.
+     */
+    double percentile(double fraction) const;
+
+    /**
+     * @brief Number of values in each of @p buckets equal ranges of 0-100.
+     */
+    QVector<int> histogram(int buckets) const;
+
+    /**
+     * @brief How many standard deviations @p percent lies from the mean.
+     */
+    double zScore(double percent) const;
+
+private:
+    static int binOf(double percent);
+
+    int count;
+    double mean;
+    double m2; ///< Sum of squared differences from the mean.
+    double min;
+    double max;
+    bool boundsExact; ///< False after an extreme value was removed.
+    std::array<int, BINS> bins;
+};
+
+#endif // GRADESTATS_HPP
@@ -0,0 +1,56 @@
+/**
+ * @file histogramwidget.cpp
+ * @brief Implementation of the HistogramWidget bar chart.
+ *
+ * Bars are scaled to the fullest bucket and drawn in the palette's accent color.
+ */
+
+#include "histogramwidget.hpp"
+#include <QPainter>
+#include <algorithm>
+
+HistogramWidget::HistogramWidget(QWidget *parent) : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    setMinimumSize(260, 140);
+}
+
+void HistogramWidget::setBuckets(const QVector<int> &counts)
+{
+    m_buckets = counts;
+    update();
+}
+
+void HistogramWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    QColor barColor = palette().highlight().color();
+    QColor textColor = palette().text().color();
+
+    // Leave room below the bars for the 0% / 50% / 100% axis labels
+    int labelHeight = fontMetrics().height();
+    QRectF plot(4, 4, width() - 8, height() - 8 - labelHeight);
+
+    painter.setPen(textColor);
+    painter.drawLine(plot.bottomLeft(), plot.bottomRight());
+    QRectF labels(plot.left(), plot.bottom() + 2, plot.width(), labelHeight);
+    painter.drawText(labels, Qt::AlignLeft, "0%");
+    painter.drawText(labels, Qt::AlignHCenter, "50%");
+    painter.drawText(labels, Qt::AlignRight, "100%");
+
+    int highest = m_buckets.isEmpty() ? 0 : *std::max_element(m_buckets.begin(), m_buckets.end());
+    if (highest == 0)
+        return;
+
+    double barWidth = plot.width() / m_buckets.size();
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(barColor);
+    for (int i = 0; i < m_buckets.size(); ++i)
+    {
+        double barHeight = plot.height() * m_buckets[i] / highest;
+        painter.drawRect(QRectF(plot.left() + i * barWidth + 1, plot.bottom() - barHeight, barWidth - 2, barHeight));
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef HISTOGRAMWIDGET_HPP
+#define HISTOGRAMWIDGET_HPP
+
+#include <QWidget>
+#include <QVector>
+
+/**
+ * @brief Bar chart of a marks distribution, one bar per equal range of 0-100%.
+ */
+class HistogramWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit HistogramWidget(QWidget *parent = nullptr);
+
+    void setBuckets(const QVector<int> &counts); // e.g. GradeStats::histogram(10)
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QVector<int> m_buckets;
+};
+
+#endif // HISTOGRAMWIDGET_HPP
@@ -0,0 +1,131 @@
+/**
+ * @file keyedtablemodel.cpp
+ * @brief Read-only table model refreshed by differences between row sets.
+ */
+#include "keyedtablemodel.hpp"
+#include "tracer.hpp"
+#include <QColor>
+#include <QHash>
+#include <QSet>
+
+KeyedTableModel::KeyedTableModel(const QStringList &headers, QObject *parent)
+    : QAbstractTableModel(parent), headers(headers)
+{
+}
+
+void KeyedTableModel::setRows(QVector<KeyedRow> next)
+{
+    ACADENCE_TRACE("model", "KeyedTableModel::setRows");
+    // Repeated keys get an occurrence number so every key is unique
+    QHash<QString, int> seen;
+    QSet<QString> nextKeys;
+    for (KeyedRow &row : next)
+    {
+        int occurrence = seen[row.key]++;
+        if (occurrence > 0)
+            row.key += QChar(0x1f) + QString::number(occurrence);
+        nextKeys.insert(row.key);
+    }
+
+    // Remove the rows that are gone, one signal per run
+    for (int end = rows.size() - 1; end >= 0;)
+    {
+        if (nextKeys.contains(rows[end].key))
+        {
+            --end;
+            continue;
+        }
+        int begin = end;
+        while (begin > 0 && !nextKeys.contains(rows[begin - 1].key))
+            --begin;
+        beginRemoveRows(QModelIndex(), begin, end);
+        rows.remove(begin, end - begin + 1);
+        endRemoveRows();
+        end = begin - 1;
+    }
+
+    // Walk the new order: rows before i already match
+    QSet<QString> shown;
+    for (const KeyedRow &row : rows)
+        shown.insert(row.key);
+    for (int i = 0; i < next.size();)
+    {
+        if (i < rows.size() && rows[i].key == next[i].key)
+        {
+            updateRow(i, next[i]);
+            ++i;
+        }
+        else if (shown.contains(next[i].key))
+        {
+            int from = i + 1;
+            while (rows[from].key != next[i].key)
+                ++from;
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+            rows.move(from, i);
+            endMoveRows();
+            updateRow(i, next[i]);
+            ++i;
+        }
+        else
+        {
+            int end = i;
+            while (end + 1 < next.size() && !shown.contains(next[end + 1].key))
+                ++end;
+            beginInsertRows(QModelIndex(), i, end);
+            for (int j = i; j <= end; ++j)
+                rows.insert(j, next[j]);
+            endInsertRows();
+            i = end + 1;
+        }
+    }
+}
+
+void KeyedTableModel::updateRow(int row, const KeyedRow &next)
+{
+    KeyedRow &current = rows[row];
+    int first = -1;
+    int last = -1;
+    for (int c = 0; c < headers.size(); ++c)
+    {
+        bool changed = current.cells.value(c) != next.cells.value(c) || (((current.warnings ^ next.warnings) >> c) & 1);
+        if (changed)
+        {
+            if (first < 0)
+                first = c;
+            last = c;
+        }
+    }
+    if (first < 0)
+        return;
+    current = next;
+    emit dataChanged(index(row, first), index(row, last));
+}
+
+int KeyedTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+int KeyedTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : headers.size();
+}
+
+QVariant KeyedTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size())
+        return QVariant();
+    const KeyedRow &row = rows[index.row()];
+    if (role == Qt::DisplayRole)
+        return row.cells.value(index.column());
+    if (role == Qt::ForegroundRole && ((row.warnings >> index.column()) & 1))
+        return QColor(Qt::red);
+    return QVariant();
+}
+
+QVariant KeyedTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role == Qt::DisplayRole && orientation == Qt::Horizontal)
+        return headers.value(section);
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
@@ -0,0 +1,53 @@
+#ifndef KEYEDTABLEMODEL_HPP
+#define KEYEDTABLEMODEL_HPP
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief One row of a KeyedTableModel.
+ */
+struct KeyedRow
+{
+    QString key;         ///< Identifies the row across refreshes.
+    QStringList cells;
+    quint32 warnings = 0; ///< Bit per column: cells shown in red.
+};
+
+/**
+ * @brief Read-only table model whose refreshes are applied as differences.
+ *
+ * setRows() compares the new rows with the shown ones by key: rows that
+ * are gone are removed and new ones inserted (each run of neighbouring
+ * rows with one signal), rows that changed place are moved, and changed
+ * cells are reported with dataChanged(). Unchanged rows cost a comparison
+ * only, and the views keep their selection and scroll position.
+ */
+class KeyedTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit KeyedTableModel(const QStringList &headers, QObject *parent = nullptr);
+
+    /**
+     * @brief Shows @p rows, in their order. Rows with the same key are
+     * matched in order of appearance.
+     */
+    void setRows(QVector<KeyedRow> rows);
+
+    const QVector<KeyedRow> &getRows() const { return rows; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    void updateRow(int row, const KeyedRow &next);
+
+    QStringList headers;
+    QVector<KeyedRow> rows; ///< Keys made unique by setRows().
+};
+
+#endif // KEYEDTABLEMODEL_HPP
@@ -1,6 +1,11 @@
 #include "mainwindow.hpp"
 #include "utils.hpp"
 #include "ui_mainwindow.h"
+#include "changefeed.hpp"
+#include "bulkimporter.hpp"
+#include "gradebook.hpp"
+#include "gradestats.hpp"
+#include "profiler.hpp"
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QApplication>
@@ -8,7 +13,9 @@
 #include <QDate>
 #include <QTime>
 #include <algorithm>
-#include <QStandardItemModel>
+#include <atomic>
+#include <memory>
+#include <QHash>
 #include <QFile>
 #include <QTextStream>
 #include <QSpinBox>
@@ -19,6 +26,12 @@
 #include <QDialogButtonBox>
 #include <QPushButton>
 #include <QGraphicsDropShadowEffect>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QProgressDialog>
+#include <QSignalBlocker>
+#include <QtConcurrent>
 
 /**
  * @brief Constructs the MainWindow.
@@ -28,7 +41,8 @@
  * @param parent Parent widget.
  */
 MainWindow::MainWindow(QString role, int uid, QString name, QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow), userRole(role), userId(uid), userName(name)
+    : QMainWindow(parent), ui(new Ui::MainWindow), adminSavesInFlight(0), userRole(role), userId(uid), userName(name),
+      noticesSequence(0), queriesSequence(0)
 {
     activeTimerHabit = nullptr;
     ui->setupUi(this);
@@ -81,6 +95,24 @@ MainWindow::MainWindow(QString role, int uid, QString name, QWidget *parent)
                     refreshHabits();
                 } });
 
+    // Smooth ring updates only while a ring is on screen; once a second otherwise
+    connect(ui->tabWidget, &QTabWidget::currentChanged, this, [this]()
+            {
+                m_focusTimer->setAnimated(m_focusProgress->isVisible());
+                m_workoutTimer->setAnimated(m_workoutProgress->isVisible()); });
+
+    // --- Grading statistics: histogram in place of its placeholder label ---
+    m_gradeHistogram = new HistogramWidget(this);
+    ui->grp_grade_stats->layout()->replaceWidget(ui->label_gradeHistogram, m_gradeHistogram);
+    ui->label_gradeHistogram->hide();
+    {
+        QSignalBlocker blocker(ui->comboStatsDepartment);
+        ui->comboStatsDepartment->addItem("All Departments", QString());
+        // Format: ID,Name,Email,Username,Password,Dept,...
+        for (const QString &dept : TableRegistry::find("students")->column(5)->getChoices())
+            ui->comboStatsDepartment->addItem(dept, dept);
+    }
+
     ui->label_welcome->setText("Welcome, " + role + " " + name);
 
     // --- Styling: Add Shadow to Profile Box ---
@@ -100,27 +132,88 @@ MainWindow::MainWindow(QString role, int uid, QString name, QWidget *parent)
     }
     connect(btnChangePass, &QPushButton::clicked, this, &MainWindow::onChangePasswordClicked);
 
+    // --- Routine, academics and attendance views (refreshed by differences) ---
+    routineModel = new KeyedTableModel({"Time", "Course", "Room", "Instructor", "Status"}, this);
+    ui->tableRoutine->setModel(routineModel);
+    teacherRoutineModel = new KeyedTableModel({"Time", "Course", "Room", "Semester"}, this);
+    ui->tableTeacherRoutine->setModel(teacherRoutineModel);
+    academicsModel = new KeyedTableModel({"Course", "Attendance %", "Score", "Status"}, this);
+    ui->tableAcademics->setModel(academicsModel);
+    attendanceModel = new AttendanceTableModel(this);
+    attendanceGrid = new AttendanceGrid(this);
+    if (ui->tableAttendance->parentWidget() && ui->tableAttendance->parentWidget()->layout())
+    {
+        ui->tableAttendance->parentWidget()->layout()->replaceWidget(ui->tableAttendance, attendanceGrid);
+        ui->tableAttendance->hide();
+    }
+    attendanceGrid->setModel(attendanceModel);
+
     // --- Admin Panel Setup ---
-    adminModel = new QStandardItemModel(this);
+    adminModel = new AdminTableModel(this);
 
     // Proxy Model for Search/Filter functionality in Admin Table
-    adminProxyModel = new QSortFilterProxyModel(this);
+    adminProxyModel = new AdminFilterProxyModel(this);
     adminProxyModel->setSourceModel(adminModel);
-    adminProxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    adminProxyModel->setFilterKeyColumn(-1); // Filter all columns
     ui->adminTableView->setModel(adminProxyModel);
+
+    // Search runs on a worker thread once typing pauses
+    adminSearchTimer = new QTimer(this);
+    adminSearchTimer->setSingleShot(true);
+    adminSearchTimer->setInterval(150);
+    connect(adminSearchTimer, &QTimer::timeout, this, &MainWindow::runAdminSearch);
+    adminSearchWatcher = new QFutureWatcher<QVector<int>>(this);
+    connect(adminSearchWatcher, &QFutureWatcherBase::finished, this, [this]()
+            {
+                // Ignore a result that arrives after the search box was cleared
+                if (ui->searchLineEdit->text().trimmed().isEmpty() || adminSearchWatcher->future().resultCount() == 0)
+                    return;
+                adminProxyModel->setMatches(adminSearchWatcher->result()); });
+    // Results go stale when rows change
+    connect(adminModel, &AdminTableModel::indexReady, adminSearchTimer, qOverload<>(&QTimer::start));
+    connect(adminModel, &AdminTableModel::edited, adminSearchTimer, qOverload<>(&QTimer::start));
+    // Sorting can move matches past the fetched rows
+    connect(adminModel, &QAbstractItemModel::layoutChanged, adminSearchTimer, qOverload<>(&QTimer::start));
     csvDelegate = new CsvDelegate(this);
     ui->adminTableView->setItemDelegate(csvDelegate);
+    // Auto-save: edits are coalesced until typing pauses, then saved off the GUI thread
+    adminSaveTimer = new QTimer(this);
+    adminSaveTimer->setSingleShot(true);
+    adminSaveTimer->setInterval(500);
+    connect(adminSaveTimer, &QTimer::timeout, this, &MainWindow::flushAdminChanges);
+    adminSavePool.setMaxThreadCount(1);
+    connect(adminModel, &AdminTableModel::edited, this, [this]()
+            {
+                adminSaveTimer->start();
+                updateSaveStatus(); });
     ui->adminTableView->setAlternatingRowColors(true);
 
     // Populate Admin Table Selector
-    QStringList tables = {
-        "admins", "students", "teachers", "courses", "routine", "grades", "notices"};
+    QStringList tables = TableRegistry::adminTableNames();
     ui->tableComboBox->addItems(tables);
 
     if (!tables.isEmpty())
         on_tableComboBox_currentTextChanged(tables.first());
 
+    // --- At-Risk Report ---
+    riskWatcher = new QFutureWatcher<QVector<RiskEntry>>(this);
+    connect(riskWatcher, &QFutureWatcherBase::finished, this, [this]()
+            {
+                ui->btnRunRiskReport->setEnabled(true);
+                riskEntries = riskWatcher->result();
+                showRiskReport(); });
+    {
+        QSignalBlocker deptBlocker(ui->comboRiskDepartment);
+        QSignalBlocker semBlocker(ui->comboRiskSemester);
+        ui->comboRiskDepartment->addItem("All Departments", QString());
+        // Format: ID,Name,Email,Username,Password,Dept,...
+        for (const QString &dept : TableRegistry::find("students")->column(5)->getChoices())
+            ui->comboRiskDepartment->addItem(dept, dept);
+        ui->comboRiskSemester->addItem("All Semesters", 0);
+        for (int sem = 1; sem <= 8; ++sem)
+            ui->comboRiskSemester->addItem(QString("Semester %1").arg(sem), sem);
+    }
+    ui->tableRisk->setAlternatingRowColors(true);
+
     // --- Role-Based UI Visibility Logic ---
     if (role == "Student")
     {
@@ -130,6 +223,8 @@ MainWindow::MainWindow(QString role, int uid, QString name, QWidget *parent)
         ui->tabWidget->setTabVisible(7, false);  // Hide Teacher Grades
         ui->tabWidget->setTabVisible(8, false);  // Hide Teacher Attendance
         ui->tabWidget->setTabVisible(10, false); // Hide Admin Panel
+        ui->tabWidget->setTabVisible(11, false); // Hide At-Risk Report
+        ui->tabWidget->setTabVisible(12, false); // Hide Diagnostics
     }
     else if (role == "Teacher")
     {
@@ -139,6 +234,8 @@ MainWindow::MainWindow(QString role, int uid, QString name, QWidget *parent)
         ui->tabWidget->setTabVisible(3, false);  // Hide Student Routine
         ui->tabWidget->setTabVisible(4, false);  // Hide Student Academics view
         ui->tabWidget->setTabVisible(10, false); // Hide Admin Panel
+        ui->tabWidget->setTabVisible(11, false); // Hide At-Risk Report
+        ui->tabWidget->setTabVisible(12, false); // Hide Diagnostics
         // Teacher Tabs (5, 6, 7, 8) and Q&A (9) remain visible
         refreshTeacherRoutine();
         refreshTeacherTools();
@@ -155,12 +252,17 @@ MainWindow::MainWindow(QString role, int uid, QString name, QWidget *parent)
         ui->tabWidget->setTabVisible(7, false); // Hide Teacher Grades
         ui->tabWidget->setTabVisible(8, false); // Hide Teacher Attendance
         ui->tabWidget->setTabVisible(9, false); // Hide Q&A
-        // Admin Panel (10) visible
+        // Admin Panel (10), At-Risk Report (11) and Diagnostics (12) visible
+        on_btnRunRiskReport_clicked();
+        on_btnRefreshDiagnostics_clicked();
         ui->addNoticeButton->setVisible(false);
         ui->label_notices->setVisible(false);
         ui->noticeListWidget->setVisible(false);
     }
 
+    // Patch the notice and query lists as rows change, here or in other sessions
+    connect(&ChangeFeed::instance(), &ChangeFeed::tableChanged, this, &MainWindow::onTableChanged);
+
     // --- Initial Data Load ---
     try
     {
@@ -171,6 +273,23 @@ MainWindow::MainWindow(QString role, int uid, QString name, QWidget *parent)
             refreshPlanner();
             refreshHabits();
 
+            // Countdowns left running or paused in the last session carry on
+            m_focusTimer->setPersistence(userId, "focus");
+            m_focusTimer->restore();
+            m_workoutTimer->setPersistence(userId, "workout");
+            if (m_workoutTimer->restore())
+            {
+                for (Habit *h : currentHabitList)
+                {
+                    auto dh = dynamic_cast<DurationHabit *>(h);
+                    if (dh && QString::number(dh->id) == m_workoutTimer->getTag())
+                    {
+                        activeTimerHabit = dh;
+                        ui->groupBox_workoutTimer->setTitle("Timer: " + dh->name);
+                    }
+                }
+            }
+
             // Auto-select the current day's routine (Qt days: 1=Mon ... 7=Sun)
             int currentDayIndex = QDate::currentDate().dayOfWeek() % 7;
             ui->comboRoutineDay->setCurrentIndex(currentDayIndex);
@@ -179,7 +298,7 @@ MainWindow::MainWindow(QString role, int uid, QString name, QWidget *parent)
             ui->tableTeacherRoutine->setAlternatingRowColors(true);
             ui->tableAcademics->setAlternatingRowColors(true);
             ui->tableGrading->setAlternatingRowColors(true);
-            ui->tableAttendance->setAlternatingRowColors(true);
+            attendanceGrid->setAlternatingRowColors(true);
 
             refreshAcademics();
         }
@@ -192,6 +311,9 @@ MainWindow::MainWindow(QString role, int uid, QString name, QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // Don't lose edits still waiting for the save timer
+    flushAdminChanges();
+    adminSavePool.waitForDone();
     qDeleteAll(currentHabitList);
     delete ui;
 }
@@ -252,13 +374,25 @@ void MainWindow::onChangePasswordClicked()
 
 // ========================== DASHBOARD ==========================
 
-void MainWindow::refreshDashboard()
+/**
+ * @brief Formats a notice for the dashboard list.
+ */
+static QString noticeLabel(const Notice &n)
+{
+    return "[" + n.getDate() + "] " + n.getAuthor() + ": " + n.getContent();
+}
+
+void MainWindow::refreshNotices()
 {
+    ACADENCE_PROFILE("MainWindow::refreshNotices");
     ui->noticeListWidget->clear();
     QVector<Notice> notices;
     try
     {
-        notices = myManager.getNotices();
+        // Rows and sequence from one snapshot, so later change events line up
+        TableSnapshotPtr t = DataStore::instance().table("notices.csv");
+        notices = myManager.getNotices(t->getRows());
+        noticesSequence = t->getSequence();
     }
     catch (const Acadence::Exception &e)
     {
@@ -266,8 +400,14 @@ void MainWindow::refreshDashboard()
     }
     for (const auto &n : notices)
     {
-        ui->noticeListWidget->addItem("[" + n.getDate() + "] " + n.getAuthor() + ": " + n.getContent());
+        ui->noticeListWidget->addItem(noticeLabel(n));
     }
+}
+
+void MainWindow::refreshDashboard()
+{
+    ACADENCE_PROFILE("MainWindow::refreshDashboard");
+    refreshNotices();
 
     // Update Next Class - Only for Students
     if (userRole == "Student")
@@ -349,7 +489,7 @@ void MainWindow::on_addNoticeButton_clicked()
         {
             QMessageBox::critical(this, "Error", e.what());
         }
-        refreshDashboard();
+        // The new notice arrives through the change feed
     }
 }
 
@@ -362,6 +502,7 @@ void MainWindow::on_logoutButton_clicked()
 
 void MainWindow::refreshPlanner()
 {
+    ACADENCE_PROFILE("MainWindow::refreshPlanner");
     ui->taskListWidget->clear();
     QVector<Task> tasks = myManager.getTasks(userId);
     for (const auto &t : tasks)
@@ -416,6 +557,7 @@ void MainWindow::on_btnTimerStop_clicked()
 
 void MainWindow::refreshHabits()
 {
+    ACADENCE_PROFILE("MainWindow::refreshHabits");
     // 1. Refresh Prayers
     DailyPrayerStatus prayers = myManager.getDailyPrayers(userId, QDate::currentDate().toString(Qt::ISODate));
     ui->chkFajr->setChecked(prayers.getFajr());
@@ -537,6 +679,7 @@ void MainWindow::on_btnDeleteHabit_clicked()
 
 void MainWindow::on_btnWorkoutStart_clicked()
 {
+    m_workoutTimer->setTag(activeTimerHabit ? QString::number(activeTimerHabit->id) : QString());
     m_workoutTimer->start(ui->spinWorkoutMinutes->value());
 }
 
@@ -559,9 +702,17 @@ void MainWindow::on_chkIsha_toggled(bool checked) { myManager.updateDailyPrayer(
 
 // ========================== ROUTINE ==========================
 
+/**
+ * @brief Identifies a routine session across refreshes of a routine table.
+ */
+static QString routineKey(const RoutineSession &session)
+{
+    return session.getStartTime() + "|" + session.getCourseCode() + "|" + session.getRoom() + "|" + QString::number(session.getSemester());
+}
+
 void MainWindow::refreshRoutine()
 {
-    ui->tableRoutine->setRowCount(0);
+    ACADENCE_PROFILE("MainWindow::refreshRoutine");
     QString day = ui->comboRoutineDay->currentText();
 
     int semester = -1;
@@ -580,6 +731,7 @@ void MainWindow::refreshRoutine()
     QString currentDay = QDate::currentDate().toString("dddd");
     bool isToday = (day == currentDay);
 
+    QVector<KeyedRow> rows;
     for (const auto &i : items)
     {
         QString status = "Upcoming";
@@ -597,14 +749,9 @@ void MainWindow::refreshRoutine()
                 status = "Starting Soon";
         }
 
-        int row = ui->tableRoutine->rowCount();
-        ui->tableRoutine->insertRow(row);
-        ui->tableRoutine->setItem(row, 0, new QTableWidgetItem(i.getStartTime() + " - " + i.getEndTime()));
-        ui->tableRoutine->setItem(row, 1, new QTableWidgetItem(i.getCourseCode() + ": " + i.getCourseName()));
-        ui->tableRoutine->setItem(row, 2, new QTableWidgetItem(i.getRoom()));
-        ui->tableRoutine->setItem(row, 3, new QTableWidgetItem(i.getInstructor()));
-        ui->tableRoutine->setItem(row, 4, new QTableWidgetItem(status));
+        rows.append({routineKey(i), {i.getStartTime() + " - " + i.getEndTime(), i.getCourseCode() + ": " + i.getCourseName(), i.getRoom(), i.getInstructor(), status}});
     }
+    routineModel->setRows(rows);
 }
 
 void MainWindow::on_comboRoutineDay_currentIndexChanged(int index)
@@ -614,21 +761,16 @@ void MainWindow::on_comboRoutineDay_currentIndexChanged(int index)
 
 void MainWindow::refreshTeacherRoutine()
 {
-    ui->tableTeacherRoutine->setRowCount(0);
+    ACADENCE_PROFILE("MainWindow::refreshTeacherRoutine");
     QString day = ui->comboRoutineDayInput->currentText();
     // Teachers see all routines for the day to avoid conflicts, or we could filter.
     // Let's show all for now so they know room availability.
     QVector<RoutineSession> items = myManager.getRoutineForDay(day);
 
+    QVector<KeyedRow> rows;
     for (const auto &i : items)
-    {
-        int row = ui->tableTeacherRoutine->rowCount();
-        ui->tableTeacherRoutine->insertRow(row);
-        ui->tableTeacherRoutine->setItem(row, 0, new QTableWidgetItem(i.getStartTime() + " - " + i.getEndTime()));
-        ui->tableTeacherRoutine->setItem(row, 1, new QTableWidgetItem(i.getCourseCode() + ": " + i.getCourseName()));
-        ui->tableTeacherRoutine->setItem(row, 2, new QTableWidgetItem(i.getRoom()));
-        ui->tableTeacherRoutine->setItem(row, 3, new QTableWidgetItem(QString::number(i.getSemester())));
-    }
+        rows.append({routineKey(i), {i.getStartTime() + " - " + i.getEndTime(), i.getCourseCode() + ": " + i.getCourseName(), i.getRoom(), QString::number(i.getSemester())}});
+    teacherRoutineModel->setRows(rows);
 }
 
 void MainWindow::on_comboRoutineDayInput_currentIndexChanged(int index)
@@ -681,6 +823,7 @@ void MainWindow::on_btnAddRoutine_Teacher_clicked()
 
 void MainWindow::refreshAcademics()
 {
+    ACADENCE_PROFILE("MainWindow::refreshAcademics");
     // Assessments
     ui->listAssessments->clear();
     QVector<Assessment> assessments = myManager.getAssessments(); // Get all for now
@@ -690,31 +833,26 @@ void MainWindow::refreshAcademics()
     }
 
     // Attendance & Grades
-    ui->tableAcademics->setRowCount(0);
     QVector<AttendanceRecord> att = myManager.getStudentAttendance(userId);
-    for (int i = 0; i < att.size(); ++i)
+    QVector<KeyedRow> rows;
+    for (const auto &record : att)
     {
-        ui->tableAcademics->insertRow(i);
-        ui->tableAcademics->setItem(i, 0, new QTableWidgetItem(att[i].getCourseName()));
-
-        double pct = (att[i].getTotalClasses() > 0) ? (double)att[i].getAttendedClasses() / att[i].getTotalClasses() * 100.0 : 0.0;
-        QTableWidgetItem *pctItem = new QTableWidgetItem(QString::number(pct, 'f', 1) + "%");
-        if (pct < 85.0)
-            pctItem->setForeground(Qt::red);
-        ui->tableAcademics->setItem(i, 1, pctItem);
-
-        QString scoreStr = QString::number(att[i].getTotalMarksObtained()) + " / " + QString::number(att[i].getTotalMaxMarks());
-        ui->tableAcademics->setItem(i, 2, new QTableWidgetItem(scoreStr));
-
+        double pct = (record.getTotalClasses() > 0) ? (double)record.getAttendedClasses() / record.getTotalClasses() * 100.0 : 0.0;
+        QString scoreStr = QString::number(record.getTotalMarksObtained()) + " / " + QString::number(record.getTotalMaxMarks());
         QString status = (pct < 85.0) ? "Low Attendance" : "Good";
-        ui->tableAcademics->setItem(i, 3, new QTableWidgetItem(status));
+        KeyedRow row{record.getCourseName(), {record.getCourseName(), QString::number(pct, 'f', 1) + "%", scoreStr, status}};
+        if (pct < 85.0)
+            row.warnings = 1u << 1; // Attendance % in red
+        rows.append(row);
     }
+    academicsModel->setRows(rows);
 }
 
 // ========================== TEACHER TOOLS ==========================
 
 void MainWindow::refreshTeacherTools()
 {
+    ACADENCE_PROFILE("MainWindow::refreshTeacherTools");
     // Populate Courses
     ui->comboTeacherCourse->clear();
     ui->comboRoutineCourse->clear();
@@ -734,6 +872,7 @@ void MainWindow::refreshTeacherTools()
     for (const auto &a : assessments)
     {
         ui->comboTeacherAssessment->addItem(a.getCourseName() + " - " + a.getTitle(), a.getId());
+        ui->comboTeacherAssessment->setItemData(ui->comboTeacherAssessment->count() - 1, a.getCourseId(), Qt::UserRole + 1);
     }
 
     // Trigger table refresh
@@ -762,74 +901,120 @@ void MainWindow::on_comboTeacherAssessment_currentIndexChanged(int index)
 
 void MainWindow::refreshTeacherGrades()
 {
+    ACADENCE_PROFILE("MainWindow::refreshTeacherGrades");
     ui->tableGrading->setRowCount(0);
+    refreshGradeStats();
 
     // Get selected assessment to find course and semester
     int assessmentId = ui->comboTeacherAssessment->currentData().toInt();
 
-    QVector<Assessment> allAssessments = myManager.getAssessments();
-    int courseId = -1;
-    for (const auto &a : allAssessments)
-    {
-        if (a.getId() == assessmentId)
-        {
-            courseId = a.getCourseId();
-            break;
-        }
-    }
-
-    if (courseId == -1)
+    int courseId = ui->comboTeacherAssessment->currentData(Qt::UserRole + 1).toInt();
+    if (courseId <= 0)
         return;
 
-    Course *c = myManager.getCourse(courseId);
+    // Students in the course's semester, with their marks, from the cached matrix
+    std::shared_ptr<const Gradebook> book = Gradebook::forCourse(courseId);
+    int a = book->findAssessment(assessmentId);
+    if (a < 0)
+        return;
 
-    QVector<Student *> students;
-    if (c)
+    GradeStats stats = book->assessmentStats(a);
+    ui->tableGrading->setRowCount(book->studentCount());
+    for (int i = 0; i < book->studentCount(); ++i)
     {
-        // Only show students in the semester of the selected course
-        students = myManager.getStudentsBySemester(c->getSemester());
-        delete c;
+        ui->tableGrading->setItem(i, 0, new QTableWidgetItem(QString::number(book->getStudentId(i))));
+        ui->tableGrading->setItem(i, 1, new QTableWidgetItem(book->getStudentName(i)));
+        QString gradeStr = book->hasMarks(i, a) ? QString::number(book->getMarks(i, a)) : "0";
+        ui->tableGrading->setItem(i, 2, new QTableWidgetItem(gradeStr));
+
+        QString zStr = book->hasMarks(i, a) ? QString::number(stats.zScore(book->toPercent(a, book->getMarks(i, a))), 'f', 2) : "-";
+        QTableWidgetItem *zItem = new QTableWidgetItem(zStr);
+        zItem->setFlags(zItem->flags() & ~Qt::ItemIsEditable);
+        ui->tableGrading->setItem(i, 3, zItem);
     }
+}
 
-    for (int i = 0; i < students.size(); ++i)
-    {
-        ui->tableGrading->insertRow(i);
-        ui->tableGrading->setItem(i, 0, new QTableWidgetItem(QString::number(students[i]->getId())));
-        ui->tableGrading->setItem(i, 1, new QTableWidgetItem(students[i]->getName()));
+/**
+ * @brief One line summary of a distribution; @p scale converts percentages
+ * back to marks (1.0 keeps them as percentages).
+ */
+static QString statsSummary(const QString &label, const GradeStats &stats, double scale, const QString &unit)
+{
+    if (stats.getCount() == 0)
+        return label + ": no marks recorded";
+    auto fmt = [&](double percent)
+    { return QString::number(percent * scale, 'f', 1) + unit; };
+    return QString("%1: %2 marks, mean %3 (sd %4), min %5, P25 %6, median %7, P75 %8, max %9")
+        .arg(label)
+        .arg(stats.getCount())
+        .arg(fmt(stats.getMean()), fmt(stats.getStdDev()), fmt(stats.getMin()), fmt(stats.percentile(0.25)),
+             fmt(stats.percentile(0.5)), fmt(stats.percentile(0.75)), fmt(stats.getMax()));
+}
 
-        double currentGrade = myManager.getGrade(students[i]->getId(), assessmentId);
-        QString gradeStr = (currentGrade >= 0) ? QString::number(currentGrade) : "0";
-        ui->tableGrading->setItem(i, 2, new QTableWidgetItem(gradeStr));
+void MainWindow::refreshGradeStats()
+{
+    ACADENCE_PROFILE("MainWindow::refreshGradeStats");
+    ui->labelAssessmentStats->clear();
+    ui->labelCourseStats->clear();
+    m_gradeHistogram->setBuckets({});
+
+    int courseId = ui->comboTeacherAssessment->currentData(Qt::UserRole + 1).toInt();
+    if (courseId > 0)
+    {
+        // Kept up to date by every grade save; nothing here reads grades.csv
+        std::shared_ptr<const Gradebook> book = Gradebook::forCourse(courseId);
+        int a = book->findAssessment(ui->comboTeacherAssessment->currentData().toInt());
+        if (a >= 0)
+        {
+            GradeStats stats = book->assessmentStats(a);
+            ui->labelAssessmentStats->setText(statsSummary(book->getAssessmentTitle(a), stats, book->getMaxMarks(a) / 100.0, ""));
+            m_gradeHistogram->setBuckets(stats.histogram(10));
+        }
+        ui->labelCourseStats->setText(statsSummary("Whole course", book->courseStats(), 1.0, "%"));
     }
-    qDeleteAll(students);
+
+    on_comboStatsDepartment_currentIndexChanged(ui->comboStatsDepartment->currentIndex());
+}
+
+void MainWindow::on_comboStatsDepartment_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    QString dept = ui->comboStatsDepartment->currentData().toString();
+    GradeStats stats = Gradebook::departmentStats(dept);
+    ui->labelDepartmentStats->setText(statsSummary("All courses", stats, 1.0, "%"));
 }
 
 void MainWindow::on_btnSaveGrades_clicked()
 {
     int assessmentId = ui->comboTeacherAssessment->currentData().toInt();
+    int courseId = ui->comboTeacherAssessment->currentData(Qt::UserRole + 1).toInt();
     int rows = ui->tableGrading->rowCount();
 
-    double max = -1, min = 1000, sum = 0;
-    int count = 0;
-
+    QMap<int, double> marksByStudent;
     for (int i = 0; i < rows; ++i)
     {
         int sid = ui->tableGrading->item(i, 0)->text().toInt();
         double marks = ui->tableGrading->item(i, 2)->text().toDouble();
-        myManager.addGrade(sid, assessmentId, marks);
-
-        if (marks > max)
-            max = marks;
-        if (marks < min)
-            min = marks;
-        sum += marks;
-        count++;
+        marksByStudent.insert(sid, marks);
     }
 
-    if (count > 0)
+    // One commit for the whole sheet: other readers never see a partial save
+    myManager.addGrades(assessmentId, marksByStudent);
+    refreshTeacherGrades();
+
+    std::shared_ptr<const Gradebook> book = Gradebook::forCourse(courseId);
+    int a = book->findAssessment(assessmentId);
+    if (a >= 0 && book->assessmentStats(a).getCount() > 0)
     {
+        GradeStats stats = book->assessmentStats(a);
+        double scale = book->getMaxMarks(a) / 100.0;
         QMessageBox::information(this, "Grading Complete",
-                                 QString("Highest: %1\nLowest: %2\nAverage: %3").arg(max).arg(min).arg(sum / count));
+                                 QString("Highest: %1\nLowest: %2\nAverage: %3\nMedian: %4\nStd. deviation: %5")
+                                     .arg(stats.getMax() * scale)
+                                     .arg(stats.getMin() * scale)
+                                     .arg(stats.getMean() * scale, 0, 'f', 2)
+                                     .arg(stats.percentile(0.5) * scale, 0, 'f', 1)
+                                     .arg(stats.getStdDev() * scale, 0, 'f', 2));
     }
 }
 
@@ -837,7 +1022,7 @@ void MainWindow::on_btnSaveGrades_clicked()
 
 void MainWindow::refreshTeacherAttendance()
 {
-    ui->tableAttendance->clear();
+    ACADENCE_PROFILE("MainWindow::refreshTeacherAttendance");
     int courseId = 0;
     if (ui->comboAttendanceCourse->count() > 0)
     {
@@ -845,6 +1030,7 @@ void MainWindow::refreshTeacherAttendance()
     }
     else
     {
+        attendanceModel->setSheet(0, {}, {}, {});
         return;
     }
     Course *c = myManager.getCourse(courseId);
@@ -852,40 +1038,14 @@ void MainWindow::refreshTeacherAttendance()
         return;
 
     QVector<Student *> students = myManager.getStudentsBySemester(c->getSemester());
-    QVector<QString> dates = myManager.getCourseDates(courseId);
-
-    // Setup Columns: ID, Name, %, Total, [Dates...]
-    QStringList headers;
-    headers << "ID" << "Name" << "%" << "Total";
-    for (const QString &d : dates)
-        headers << d;
-
-    ui->tableAttendance->setColumnCount(headers.size());
-    ui->tableAttendance->setHorizontalHeaderLabels(headers);
-    ui->tableAttendance->setRowCount(students.size());
-
-    for (int i = 0; i < students.size(); ++i)
-    {
-        int sid = students[i]->getId();
-        ui->tableAttendance->setItem(i, 0, new QTableWidgetItem(QString::number(sid)));
-        ui->tableAttendance->setItem(i, 1, new QTableWidgetItem(students[i]->getName()));
+    QVector<AttendanceStudent> roster;
+    roster.reserve(students.size());
+    for (Student *s : students)
+        roster.append({s->getId(), s->getName()});
+    QStringList dates = myManager.getCourseDates(courseId);
 
-        int presentCount = 0;
-        for (int j = 0; j < dates.size(); ++j)
-        {
-            bool present = myManager.isPresent(courseId, sid, dates[j]);
-            if (present)
-                presentCount++;
-
-            QTableWidgetItem *checkItem = new QTableWidgetItem();
-            checkItem->setCheckState(present ? Qt::Checked : Qt::Unchecked);
-            ui->tableAttendance->setItem(i, 4 + j, checkItem);
-        }
-
-        double pct = dates.isEmpty() ? 0.0 : (double)presentCount / dates.size() * 100.0;
-        ui->tableAttendance->setItem(i, 2, new QTableWidgetItem(QString::number(pct, 'f', 1) + "%"));
-        ui->tableAttendance->setItem(i, 3, new QTableWidgetItem(QString::number(presentCount) + "/" + QString::number(dates.size())));
-    }
+    // One pass over attendance.csv; only cells that differ from the view are updated
+    attendanceModel->setSheet(courseId, roster, dates, AcadenceManager::table("attendance.csv"));
 
     qDeleteAll(students);
     delete c;
@@ -902,17 +1062,7 @@ void MainWindow::on_btnAddClassDate_clicked()
     QString date = QInputDialog::getText(this, "Add Class", "Date (yyyy-MM-dd):", QLineEdit::Normal, QDate::currentDate().toString("yyyy-MM-dd"), &ok);
     if (ok && !date.isEmpty())
     {
-        int col = ui->tableAttendance->columnCount();
-        ui->tableAttendance->insertColumn(col);
-        ui->tableAttendance->setHorizontalHeaderItem(col, new QTableWidgetItem(date));
-
-        // Add checkboxes for all rows
-        for (int i = 0; i < ui->tableAttendance->rowCount(); ++i)
-        {
-            QTableWidgetItem *checkItem = new QTableWidgetItem();
-            checkItem->setCheckState(Qt::Unchecked);
-            ui->tableAttendance->setItem(i, col, checkItem);
-        }
+        attendanceModel->addDate(date);
     }
 }
 
@@ -922,48 +1072,144 @@ void MainWindow::on_btnSaveAttendance_clicked()
     if (courseId <= 0)
         return;
 
-    int rows = ui->tableAttendance->rowCount();
-    int cols = ui->tableAttendance->columnCount();
-
-    // Columns 0-3 are info. Dates start at 4.
-    for (int j = 4; j < cols; ++j)
-    {
-        QString date = ui->tableAttendance->horizontalHeaderItem(j)->text();
-        for (int i = 0; i < rows; ++i)
-        {
-            int sid = ui->tableAttendance->item(i, 0)->text().toInt();
-            bool present = (ui->tableAttendance->item(i, j)->checkState() == Qt::Checked);
-            myManager.markAttendance(courseId, sid, date, present);
-        }
-    }
+    myManager.saveAttendance(courseId, attendanceModel->entries());
     QMessageBox::information(this, "Success", "Attendance Saved");
     refreshTeacherAttendance();
 }
 
 // ========================== QUERIES ==========================
 
+/**
+ * @brief Fills a Q&A list item from a query; the query ID is kept in Qt::UserRole.
+ */
+static void fillQueryItem(QListWidgetItem *item, const Query &q, const QString &role)
+{
+    QString label;
+    if (role == "Student")
+    {
+        label = "Q: " + q.getQuestion() + "\n   A: " + (q.getAnswer().isEmpty() ? "(Waiting...)" : q.getAnswer());
+    }
+    else
+    {
+        label = "[" + q.getStudentName() + "] Q: " + q.getQuestion() + "\n   A: " + (q.getAnswer().isEmpty() ? "(Select to Reply)" : q.getAnswer());
+    }
+
+    item->setText(label);
+    item->setData(Qt::UserRole, q.getId());
+    item->setData(Qt::ForegroundRole, q.getAnswer().isEmpty() ? QVariant(QColor(Qt::red)) : QVariant());
+}
+
 void MainWindow::refreshQueries()
 {
+    ACADENCE_PROFILE("MainWindow::refreshQueries");
     ui->listQueries->clear();
-    QVector<Query> queries = myManager.getQueries(userId, userRole);
+    TableSnapshotPtr t = DataStore::instance().table("queries.csv");
+    QVector<Query> queries = myManager.getQueries(userId, userRole, t->getRows());
+    queriesSequence = t->getSequence();
 
     for (const auto &q : queries)
     {
-        QString label;
-        if (userRole == "Student")
+        QListWidgetItem *item = new QListWidgetItem;
+        fillQueryItem(item, q, userRole);
+        ui->listQueries->addItem(item);
+    }
+}
+
+void MainWindow::onTableChanged(const QString &table, const QVector<TableChange> &changes, quint64 sequence)
+{
+    try
+    {
+        if (table == "notices.csv" && sequence > noticesSequence)
         {
-            label = "Q: " + q.getQuestion() + "\n   A: " + (q.getAnswer().isEmpty() ? "(Waiting...)" : q.getAnswer());
+            noticesSequence = sequence;
+            applyNoticeChanges(changes);
         }
-        else
+        else if (table == "queries.csv" && sequence > queriesSequence)
+        {
+            queriesSequence = sequence;
+            applyQueryChanges(changes);
+        }
+        else if ((table == "grades.csv" || table == "assessments.csv") && userRole == "Teacher")
         {
-            label = "[" + q.getStudentName() + "] Q: " + q.getQuestion() + "\n   A: " + (q.getAnswer().isEmpty() ? "(Select to Reply)" : q.getAnswer());
+            refreshGradeStats(); // Leaves the sheet alone: it may hold unsaved marks
+        }
+        else if (table == "routine.csv")
+        {
+            // Applied as differences: selection and scroll position stay
+            if (userRole == "Student")
+                refreshRoutine();
+            else if (userRole == "Teacher")
+                refreshTeacherRoutine();
+        }
+        else if ((table == "attendance.csv" || table == "grades.csv" || table == "assessments.csv") && userRole == "Student")
+        {
+            refreshAcademics();
         }
+    }
+    catch (const Acadence::Exception &e)
+    {
+        // A view may lag until its next refresh; never interrupt the user for it
+    }
+}
 
-        QListWidgetItem *item = new QListWidgetItem(label);
-        item->setData(Qt::UserRole, q.getId());
-        if (q.getAnswer().isEmpty())
-            item->setForeground(Qt::red);
-        ui->listQueries->addItem(item);
+void MainWindow::applyNoticeChanges(const QVector<TableChange> &changes)
+{
+    // Notices have no key, so only appends can be applied row by row
+    CsvTable appended;
+    for (const auto &change : changes)
+    {
+        if (change.getType() == TableChange::Append)
+            appended.append(change.getRow());
+        else if (change.getType() != TableChange::None)
+        {
+            refreshNotices();
+            return;
+        }
+    }
+    for (const auto &n : myManager.getNotices(appended))
+        ui->noticeListWidget->addItem(noticeLabel(n));
+}
+
+void MainWindow::applyQueryChanges(const QVector<TableChange> &changes)
+{
+    QHash<int, QListWidgetItem *> items;
+    for (int i = 0; i < ui->listQueries->count(); ++i)
+    {
+        QListWidgetItem *item = ui->listQueries->item(i);
+        items.insert(item->data(Qt::UserRole).toInt(), item);
+    }
+
+    CsvTable upserted;
+    for (const auto &change : changes)
+    {
+        switch (change.getType())
+        {
+        case TableChange::Upsert:
+        case TableChange::Append:
+            upserted.append(change.getRow());
+            break;
+        case TableChange::Delete:
+            delete items.take(change.getRow().value(0).toInt());
+            break;
+        case TableChange::Rewrite:
+            refreshQueries();
+            return;
+        case TableChange::None:
+            break;
+        }
+    }
+
+    // getQueries applies the same visibility rules as a full refresh
+    for (const auto &q : myManager.getQueries(userId, userRole, upserted))
+    {
+        QListWidgetItem *item = items.value(q.getId());
+        if (!item)
+        {
+            item = new QListWidgetItem;
+            ui->listQueries->addItem(item);
+            items.insert(q.getId(), item);
+        }
+        fillQueryItem(item, q, userRole);
     }
 }
 
@@ -978,7 +1224,6 @@ void MainWindow::on_btnQueryAction_clicked()
         // Student asks question
         myManager.addQuery(userId, text);
         ui->editQueryInput->clear();
-        refreshQueries();
     }
     else
     {
@@ -992,113 +1237,156 @@ void MainWindow::on_btnQueryAction_clicked()
         int qid = item->data(Qt::UserRole).toInt();
         myManager.answerQuery(qid, text);
         ui->editQueryInput->clear();
-        refreshQueries();
     }
 }
 
 // ========================== ADMIN PANEL ==========================
 
-// Helper to save model data to text file
-void saveTableData(QStandardItemModel *model, const QString &tableName)
+/**
+ * @brief Outcome of one admin save, produced on the save thread.
+ */
+struct AdminSaveResult
 {
-    QVector<QStringList> data;
-    for (int i = 0; i < model->rowCount(); ++i)
-    {
-        QStringList rowData;
-        for (int j = 0; j < model->columnCount(); ++j)
+    QString error;         ///< Empty on success.
+    bool conflict = false; ///< The store's table moved on; the admin's copy cannot be saved over it.
+};
+
+void MainWindow::flushAdminChanges()
+{
+    adminSaveTimer->stop();
+    if (!adminModel->hasPendingChanges())
+        return;
+
+    bool rewrite = false;
+    QVector<TableChange> changes = adminModel->takePendingChanges(rewrite);
+    QString table = adminModel->getTableName() + ".csv";
+    CsvTable rows = adminModel->getRows(); // Shared, not copied
+    std::shared_ptr<quint64> sequence = adminSequence; // Only the save thread touches it from here on
+
+    // Row changes are merged into whatever the store holds now. The whole
+    // table is written only when they cannot describe the edit, and then
+    // only if nobody else has written the table since our copy was read.
+    QFuture<AdminSaveResult> save = QtConcurrent::run(&adminSavePool, [table, changes, rows, rewrite, sequence]()
+                                                      {
+        AdminSaveResult result;
+        try
+        {
+            bool current = false;
+            QHash<QString, quint64> written;
+            DataStore::instance().commit([&](DataBatch &batch)
+                                         {
+                current = batch.sequence(table) == *sequence;
+                result.conflict = rewrite ? !current : !batch.apply(table, changes);
+                if (rewrite && current)
+                    batch.rows(table) = rows; }, &written);
+            // Our copy only stays current if the commit had nothing to merge
+            if (current && written.contains(table))
+                *sequence = written.value(table);
+        }
+        catch (const std::exception &e)
         {
-            QStandardItem *item = model->item(i, j);
-            rowData << (item ? item->text() : "");
+            result.error = QString::fromUtf8(e.what());
         }
-        data.append(rowData);
+        if (result.conflict)
+            result.error = "Another session changed " + table + " first";
+        return result; });
+
+    adminSavesInFlight++;
+    auto *watcher = new QFutureWatcher<AdminSaveResult>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, sequence]()
+            {
+                AdminSaveResult result = watcher->result();
+                watcher->deleteLater();
+                adminSavesInFlight--;
+                adminSaveError = result.error;
+                updateSaveStatus();
+                // Only if the admin is still on the copy the save was made from
+                if (result.conflict && sequence == adminSequence)
+                {
+                    QMessageBox::warning(this, "Save Conflict",
+                                         "Another session changed " + adminModel->getTableName() +
+                                             " while you were editing it, so your last changes were not saved.\n"
+                                             "The table will be reloaded; please make those changes again.");
+                    bool rewrite = false;
+                    adminModel->takePendingChanges(rewrite); // Made on the same outdated copy
+                    on_tableComboBox_currentTextChanged(adminModel->getTableName());
+                } });
+    watcher->setFuture(save);
+    updateSaveStatus();
+}
+
+void MainWindow::updateSaveStatus()
+{
+    if (!adminSaveError.isEmpty())
+    {
+        ui->labelSaveStatus->setText("Save failed: " + adminSaveError);
+        ui->labelSaveStatus->setStyleSheet("color: red;");
+        return;
     }
-    AcadenceManager::writeCsv(tableName + ".csv", data);
+    ui->labelSaveStatus->setStyleSheet("");
+    if (adminModel->hasPendingChanges())
+        ui->labelSaveStatus->setText("Unsaved changes");
+    else if (adminSavesInFlight > 0)
+        ui->labelSaveStatus->setText("Saving...");
+    else
+        ui->labelSaveStatus->setText("All changes saved");
 }
 
 void MainWindow::on_tableComboBox_currentTextChanged(const QString &tableName)
 {
-    adminModel->clear();
-
-    // Disconnect previous connections to prevent multiple saves during load
-    disconnect(adminModel, nullptr, this, nullptr);
-    csvDelegate->currentTable = tableName;
+    flushAdminChanges(); // Pending edits belong to the table being left
+    const TableDescriptor *schema = TableRegistry::find(tableName);
+    csvDelegate->currentTable = schema;
 
     QVector<QStringList> data;
+    quint64 sequence = 0;
     try
     {
-        data = AcadenceManager::readCsv(tableName + ".csv");
+        TableSnapshotPtr snap = DataStore::instance().table(tableName + ".csv");
+        data = snap->getRows();
+        sequence = snap->getSequence();
     }
     catch (const Acadence::Exception &e)
     {
         QMessageBox::warning(this, "Load Error", e.what());
     }
-    for (const auto &row : data)
-    {
-        QList<QStandardItem *> items;
-        for (const QString &field : row)
-            items.append(new QStandardItem(field));
-        adminModel->appendRow(items);
-    }
-
-    // Set Headers
-    QStringList headers;
-    if (tableName == "admins")
-        headers << "ID" << "Username" << "Password" << "Name" << "Email";
-    else if (tableName == "students")
-        headers << "ID" << "Name" << "Email" << "Username" << "Password" << "Dept" << "Batch" << "Sem" << "Admission Date" << "CGPA";
-    else if (tableName == "teachers")
-        headers << "ID" << "Name" << "Email" << "Username" << "Password" << "Dept" << "Designation" << "Salary";
-    else if (tableName == "courses")
-        headers << "ID" << "Code" << "Name" << "Teacher ID" << "Semester" << "Credits";
-    else if (tableName == "routine")
-        headers << "Day" << "Start" << "End" << "Code" << "Name" << "Room" << "Instructor" << "Semester";
-    else if (tableName == "grades")
-        headers << "Student ID" << "Assessment ID" << "Marks";
-    else if (tableName == "notices")
-        headers << "Date" << "Author" << "Content";
-    adminModel->setHorizontalHeaderLabels(headers);
-
-    // Auto-save on edit
-    connect(adminModel, &QStandardItemModel::itemChanged, this, [this, tableName]()
-            { saveTableData(adminModel, tableName); });
+    adminSequence = std::make_shared<quint64>(sequence);
 
+    QStringList headers = schema ? schema->getHeaders() : QStringList();
+    adminModel->setTable(tableName, data, headers);
+    ui->adminTableView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder); // New table, stored order
+    runAdminSearch(); // Row numbers changed; re-apply the current search
     ui->adminTableView->resizeColumnsToContents();
 }
 
 void MainWindow::on_btnAddRow_clicked()
 {
-    // Insert a new empty row at the end
-    int row = adminModel->rowCount();
-    adminModel->insertRow(row);
-
-    QString currentTable = ui->tableComboBox->currentText();
-    QString nextIdStr = "";
+    QStringList newRow;
+    for (int j = 0; j < adminModel->columnCount(); ++j)
+        newRow << "";
 
-    // Auto-generate ID for tables with a primary key at column 0
-    if (currentTable == "admins" || currentTable == "students" ||
-        currentTable == "teachers" || currentTable == "courses")
+    // Auto-generate the ID for tables that have one
+    const TableDescriptor *schema = TableRegistry::find(adminModel->getTableName());
+    int idColumn = schema ? schema->columnWithRole(ColumnRole::Id) : -1;
+    if (idColumn >= 0 && idColumn < newRow.size())
     {
         int maxId = 0;
-        for (int i = 0; i < row; ++i)
-        {
-            QStandardItem *item = adminModel->item(i, 0);
-            if (item && item->text().toInt() > maxId)
-                maxId = item->text().toInt();
-        }
-        nextIdStr = QString::number(maxId + 1);
-    }
-
-    // Initialize items to prevent null pointers if saved immediately
-    for (int j = 0; j < adminModel->columnCount(); ++j)
-    {
-        if (j == 0 && !nextIdStr.isEmpty())
-            adminModel->setItem(row, j, new QStandardItem(nextIdStr));
-        else
-            adminModel->setItem(row, j, new QStandardItem(""));
-    }
-
-    // Trigger save
-    saveTableData(adminModel, currentTable);
+        for (const auto &row : adminModel->getRows())
+            maxId = std::max(maxId, row.value(idColumn).toInt());
+        newRow[idColumn] = QString::number(maxId + 1);
+    }
+
+    // A search would hide the blank row
+    if (!ui->searchLineEdit->text().isEmpty())
+        ui->searchLineEdit->clear();
+    adminProxyModel->clearMatches();
+
+    adminModel->appendRow(newRow);
+    int added = adminModel->viewRow(static_cast<int>(adminModel->getRows().size()) - 1);
+    int column = (idColumn == 0 && adminModel->columnCount() > 1) ? 1 : 0; // The ID is filled in already
+    QModelIndex cell = adminProxyModel->mapFromSource(adminModel->index(added, column));
+    ui->adminTableView->scrollTo(cell);
+    ui->adminTableView->setCurrentIndex(cell);
 }
 
 void MainWindow::on_btnDeleteRow_clicked()
@@ -1124,14 +1412,217 @@ void MainWindow::on_btnDeleteRow_clicked()
     {
         adminModel->removeRow(sourceRows[i]);
     }
+}
 
-    // Trigger save
-    saveTableData(adminModel, ui->tableComboBox->currentText());
+void MainWindow::on_searchLineEdit_textChanged(const QString &)
+{
+    adminSearchTimer->start();
 }
 
-void MainWindow::on_searchLineEdit_textChanged(const QString &arg1)
+void MainWindow::on_btnImport_clicked()
 {
-    adminProxyModel->setFilterFixedString(arg1);
+    QString tableName = adminModel->getTableName();
+    QString path = QFileDialog::getOpenFileName(this, "Import into " + tableName, QString(), "CSV files (*.csv);;All files (*)");
+    if (path.isEmpty())
+        return;
+
+    flushAdminChanges(); // Queued first on the save thread, so the import sees it
+
+    auto *dialog = new QProgressDialog("Importing " + QFileInfo(path).fileName() + "...", "Cancel", 0, 100, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setMinimumDuration(0);
+    dialog->setAutoClose(false);
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    connect(dialog, &QProgressDialog::canceled, this, [cancelled]()
+            { *cancelled = true; });
+
+    QFuture<ImportReport> import = QtConcurrent::run(&adminSavePool, [tableName, path, cancelled](QPromise<ImportReport> &promise)
+                                                     {
+        promise.setProgressRange(0, 100);
+        ImportReport report;
+        try
+        {
+            report = BulkImporter(tableName).run(path, [&](int percent)
+                                                 {
+                promise.setProgressValue(percent);
+                return !*cancelled; });
+        }
+        catch (const std::exception &e)
+        {
+            report.failure = QString::fromUtf8(e.what());
+        }
+        promise.addResult(report); });
+
+    auto *watcher = new QFutureWatcher<ImportReport>(this);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, dialog, &QProgressDialog::setValue);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, dialog, tableName]()
+            {
+                ImportReport report = watcher->result();
+                watcher->deleteLater();
+                dialog->close();
+
+                if (!report.failure.isEmpty())
+                {
+                    QMessageBox::warning(this, "Import Failed", report.failure);
+                    return;
+                }
+                if (report.cancelled)
+                    return;
+                if (adminModel->getTableName() == tableName)
+                    on_tableComboBox_currentTextChanged(tableName); // Show the new rows
+
+                QMessageBox box(report.errors.isEmpty() ? QMessageBox::Information : QMessageBox::Warning, "Import",
+                                QString("Imported %1 rows into %2.").arg(report.imported).arg(tableName), QMessageBox::Ok, this);
+                if (!report.errors.isEmpty())
+                {
+                    box.setInformativeText(QString("%1 rows were skipped; see the details.").arg(report.errors.size()));
+                    box.setDetailedText(report.errors.join("\n"));
+                }
+                box.exec(); });
+    watcher->setFuture(import);
+}
+
+// ========================== AT-RISK REPORT ==========================
+
+void MainWindow::on_btnRunRiskReport_clicked()
+{
+    if (riskWatcher->isRunning())
+        return;
+    ui->btnRunRiskReport->setEnabled(false);
+    ui->labelRiskSummary->setText("Running...");
+    riskWatcher->setFuture(QtConcurrent::run([]()
+                                             { return RiskReport().run(); }));
+}
+
+QVector<RiskEntry> MainWindow::filteredRiskEntries() const
+{
+    QString dept = ui->comboRiskDepartment->currentData().toString();
+    int semester = ui->comboRiskSemester->currentData().toInt();
+    QVector<RiskEntry> shown;
+    for (const RiskEntry &e : riskEntries)
+        if ((dept.isEmpty() || e.department == dept) && (semester == 0 || e.semester == semester))
+            shown.append(e);
+    return shown;
+}
+
+void MainWindow::showRiskReport()
+{
+    QVector<RiskEntry> shown = filteredRiskEntries();
+    ui->tableRisk->setSortingEnabled(false);
+    ui->tableRisk->setRowCount(shown.size());
+    for (int i = 0; i < shown.size(); ++i)
+    {
+        const RiskEntry &e = shown[i];
+        QStringList risks;
+        if (e.lowAttendance)
+            risks << "Low attendance";
+        if (e.failing)
+            risks << "Failing marks";
+        ui->tableRisk->setItem(i, 0, new QTableWidgetItem(QString::number(e.studentId)));
+        ui->tableRisk->setItem(i, 1, new QTableWidgetItem(e.studentName));
+        ui->tableRisk->setItem(i, 2, new QTableWidgetItem(e.department));
+        ui->tableRisk->setItem(i, 3, new QTableWidgetItem(QString::number(e.semester)));
+        ui->tableRisk->setItem(i, 4, new QTableWidgetItem(e.courseCode + " - " + e.courseName));
+        ui->tableRisk->setItem(i, 5, new QTableWidgetItem(QString("%1/%2 (%3%)").arg(e.classesAttended).arg(e.classesHeld).arg(e.attendancePercent(), 0, 'f', 1)));
+        ui->tableRisk->setItem(i, 6, new QTableWidgetItem(e.gradedMaxMarks > 0 ? QString("%1/%2 (%3%)").arg(e.marks).arg(e.gradedMaxMarks).arg(e.marksPercent(), 0, 'f', 1) : "-"));
+        ui->tableRisk->setItem(i, 7, new QTableWidgetItem(risks.join(", ")));
+    }
+    ui->labelRiskSummary->setText(QString("%1 of %2 at-risk enrolments shown").arg(shown.size()).arg(riskEntries.size()));
+}
+
+void MainWindow::on_comboRiskDepartment_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    showRiskReport();
+}
+
+void MainWindow::on_comboRiskSemester_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    showRiskReport();
+}
+
+void MainWindow::on_btnExportRiskReport_clicked()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export At-Risk Report", "at_risk_report.csv", "CSV Files (*.csv)");
+    if (path.isEmpty())
+        return;
+    try
+    {
+        RiskReport::exportCsv(filteredRiskEntries(), path);
+    }
+    catch (const Acadence::FileException &e)
+    {
+        QMessageBox::critical(this, "Export Failed", e.what());
+    }
+}
+
+// ========================== DIAGNOSTICS ==========================
+
+void MainWindow::on_btnRefreshDiagnostics_clicked()
+{
+    if (!Profiler::ENABLED)
+    {
+        ui->labelDiagnosticsStatus->setText("Profiling is disabled in this build; configure with -DACADENCE_ENABLE_PROFILING=ON");
+        return;
+    }
+
+    QMap<QString, ProbeStats> results = Profiler::results();
+    QVector<QPair<QString, ProbeStats>> probes;
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it)
+        probes.append({it.key(), it.value()});
+    std::sort(probes.begin(), probes.end(), [](const auto &a, const auto &b)
+              { return a.second.totalNs > b.second.totalNs; });
+
+    ui->tableDiagnostics->setSortingEnabled(false);
+    ui->tableDiagnostics->setRowCount(probes.size());
+    for (int i = 0; i < probes.size(); ++i)
+    {
+        const ProbeStats &s = probes[i].second;
+        ui->tableDiagnostics->setItem(i, 0, new QTableWidgetItem(probes[i].first));
+        ui->tableDiagnostics->setItem(i, 1, new QTableWidgetItem(QString::number(s.calls)));
+        ui->tableDiagnostics->setItem(i, 2, new QTableWidgetItem(QString::number(s.totalNs / 1e6, 'f', 2)));
+        ui->tableDiagnostics->setItem(i, 3, new QTableWidgetItem(QString::number(s.meanMicros(), 'f', 1)));
+        ui->tableDiagnostics->setItem(i, 4, new QTableWidgetItem(QString::number(s.percentileMicros(0.95), 'f', 0)));
+        ui->tableDiagnostics->setItem(i, 5, new QTableWidgetItem(QString::number(s.maxNs / 1000.0, 'f', 1)));
+        ui->tableDiagnostics->setItem(i, 6, new QTableWidgetItem(locale().formattedDataSize(s.bytesRead)));
+        ui->tableDiagnostics->setItem(i, 7, new QTableWidgetItem(locale().formattedDataSize(s.bytesWritten)));
+        ui->tableDiagnostics->setItem(i, 8, new QTableWidgetItem(QString::number(s.rows)));
+    }
+    ui->labelDiagnosticsStatus->setText(QString("%1 probes").arg(probes.size()));
+}
+
+void MainWindow::on_btnResetDiagnostics_clicked()
+{
+    Profiler::reset();
+    on_btnRefreshDiagnostics_clicked();
+}
+
+void MainWindow::on_btnExportDiagnostics_clicked()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export Diagnostics", "diagnostics.json", "JSON Files (*.json)");
+    if (path.isEmpty())
+        return;
+    try
+    {
+        Profiler::exportJson(path);
+    }
+    catch (const Acadence::FileException &e)
+    {
+        QMessageBox::critical(this, "Export Failed", e.what());
+    }
+}
+
+void MainWindow::runAdminSearch()
+{
+    QString query = ui->searchLineEdit->text();
+    if (query.trimmed().isEmpty())
+    {
+        adminProxyModel->clearMatches();
+        return;
+    }
+    adminSearchWatcher->setFuture(adminModel->search(query));
 }
 
 // ========================== CSV DELEGATE ==========================
@@ -1140,120 +1631,49 @@ CsvDelegate::CsvDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
 
 QWidget *CsvDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
-    int col = index.column();
+    // The column's descriptor says which editor to use; no per-table branching
+    const ColumnDescriptor *column = currentTable ? currentTable->column(index.column()) : nullptr;
+    if (!column)
+        return QStyledItemDelegate::createEditor(parent, option, index);
 
-    // Admins: ID,Username,Password,Name,Email
-    if (currentTable == "admins")
+    switch (column->type)
     {
-        if (col == 0)
-        { // ID
-            QSpinBox *sb = new QSpinBox(parent);
-            sb->setRange(1, 999999);
-            return sb;
-        }
-    }
-    // Students: ID,Name,Email,Username,Password,Dept,Batch,Sem,StudentID,DateAdmission,CGPA
-    else if (currentTable == "students")
+    case ColumnType::Integer:
     {
-        if (col == 0)
-        { // ID
-            QSpinBox *sb = new QSpinBox(parent);
-            sb->setRange(1, 999999);
-            return sb;
-        }
-        if (col == 7)
-        { // Sem
-            QSpinBox *sb = new QSpinBox(parent);
-            sb->setRange(1, 8);
-            return sb;
-        }
-        if (col == 8)
-        { // DateAdmission
-            QDateEdit *de = new QDateEdit(parent);
-            de->setDisplayFormat("yyyy-MM-dd");
-            de->setCalendarPopup(true);
-            return de;
-        }
-        if (col == 9)
-        { // CGPA
-            QDoubleSpinBox *dsb = new QDoubleSpinBox(parent);
-            dsb->setRange(0.0, 4.0);
-            dsb->setSingleStep(0.01);
-            return dsb;
-        }
-        if (col == 5)
-        { // Dept
-            QComboBox *cb = new QComboBox(parent);
-            cb->addItems({"CSE", "EEE", "MCE", "CEE", "BTM", "TVE", "SWE"});
-            return cb;
-        }
+        QSpinBox *sb = new QSpinBox(parent);
+        sb->setRange(static_cast<int>(column->min), static_cast<int>(column->max));
+        return sb;
     }
-    // Teachers: ID,Name,Email,Username,Password,Dept,Designation,TeacherID,Salary
-    else if (currentTable == "teachers")
+    case ColumnType::Real:
     {
-        if (col == 0)
-        {
-            QSpinBox *sb = new QSpinBox(parent);
-            sb->setRange(1, 999999);
-            return sb;
-        }
-        if (col == 7)
-        { // Salary
-            QDoubleSpinBox *dsb = new QDoubleSpinBox(parent);
-            dsb->setRange(0.0, 1000000.0);
-            return dsb;
-        }
-        if (col == 5)
-        { // Dept
-            QComboBox *cb = new QComboBox(parent);
-            cb->addItems({"CSE", "EEE", "MCE", "CEE", "BTM", "TVE", "SWE"});
-            return cb;
-        }
+        QDoubleSpinBox *dsb = new QDoubleSpinBox(parent);
+        dsb->setRange(column->min, column->max);
+        if (column->step > 0)
+            dsb->setSingleStep(column->step);
+        return dsb;
     }
-    // Courses: ID,Code,Name,TeacherID,Semester,Credits
-    else if (currentTable == "courses")
+    case ColumnType::Date:
     {
-        if (col == 0 || col == 3 || col == 5)
-        {
-            QSpinBox *sb = new QSpinBox(parent);
-            sb->setRange(1, 999999);
-            return sb;
-        }
-        if (col == 4)
-        { // Semester
-            QSpinBox *sb = new QSpinBox(parent);
-            sb->setRange(1, 8);
-            return sb;
-        }
+        QDateEdit *de = new QDateEdit(parent);
+        de->setDisplayFormat("yyyy-MM-dd");
+        de->setCalendarPopup(true);
+        return de;
     }
-    // Routine: Day,Start,End,Code,Name,Room,Instructor,Semester
-    else if (currentTable == "routine")
+    case ColumnType::Time:
     {
-        if (col == 1 || col == 2)
-        { // Start, End
-            QTimeEdit *te = new QTimeEdit(parent);
-            te->setDisplayFormat("HH:mm");
-            return te;
-        }
-        if (col == 7)
-        { // Semester
-            QSpinBox *sb = new QSpinBox(parent);
-            sb->setRange(1, 8);
-            return sb;
-        }
+        QTimeEdit *te = new QTimeEdit(parent);
+        te->setDisplayFormat("HH:mm");
+        return te;
     }
-    // Notices: Date,Author,Content
-    else if (currentTable == "notices")
-    {
-        if (col == 0)
+    case ColumnType::Text:
+        if (column->choiceCount > 0)
         {
-            QDateEdit *de = new QDateEdit(parent);
-            de->setDisplayFormat("yyyy-MM-dd");
-            de->setCalendarPopup(true);
-            return de;
+            QComboBox *cb = new QComboBox(parent);
+            cb->addItems(column->getChoices());
+            return cb;
         }
+        break;
     }
-
     return QStyledItemDelegate::createEditor(parent, option, index);
 }
 
@@ -1301,89 +1721,72 @@ void CsvDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const
 
     // --- 2. Perform Validation ---
 
-    // ID Validation (Column 0 for user tables)
-    if (col == 0 && (currentTable == "admins" || currentTable == "students" || currentTable == "teachers" || currentTable == "courses"))
+    // Check against every row of the table, including rows the view has not fetched
+    const QSortFilterProxyModel *proxy = qobject_cast<const QSortFilterProxyModel *>(model);
+    const AdminTableModel *tableModel = qobject_cast<const AdminTableModel *>(proxy ? proxy->sourceModel() : model);
+    int sourceRow = proxy ? proxy->mapToSource(index).row() : index.row();
+
+    const ColumnDescriptor *column = currentTable ? currentTable->column(col) : nullptr;
+    if (!column)
     {
-        // Check for duplicate ID in current model
-        for (int i = 0; i < model->rowCount(); ++i)
-        {
-            if (i != index.row() && model->index(i, 0).data(Qt::EditRole).toString() == newVal)
-            {
-                QMessageBox::warning(editor->parentWidget(), "Validation Error", "ID must be unique.");
-                return; // Reject change
-            }
-        }
+        model->setData(index, newVal, Qt::EditRole);
+        return;
     }
 
-    // Username Validation
-    // Admins: Col 1, Students: Col 3, Teachers: Col 3
-    bool isUsernameCol = (currentTable == "admins" && col == 1) ||
-                         ((currentTable == "students" || currentTable == "teachers") && col == 3);
+    // Type, range and username/password rules
+    QString error = column->validate(newVal);
+    if (!error.isEmpty())
+    {
+        QMessageBox::warning(editor->parentWidget(), "Validation Error", error);
+        return; // Reject change
+    }
 
-    if (isUsernameCol)
+    // IDs are unique within their table
+    if (column->role == ColumnRole::Id && tableModel && tableModel->findRow(col, newVal, sourceRow) >= 0)
     {
-        QString error = Utils::validateUsername(newVal);
-        if (!error.isEmpty())
-        {
-            QMessageBox::warning(editor->parentWidget(), "Validation Error", error);
-            return;
-        }
+        QMessageBox::warning(editor->parentWidget(), "Validation Error", "ID must be unique.");
+        return;
+    }
 
-        // Check uniqueness across all user tables
-        QStringList userTables = {"admins", "students", "teachers"};
-        for (const QString &table : userTables)
+    // Usernames are unique across every table that has them
+    if (column->role == ColumnRole::Username)
+    {
+        for (const TableDescriptor *table : TableRegistry::tables())
         {
-            int uCol = (table == "admins") ? 1 : 3;
+            int uCol = table->columnWithRole(ColumnRole::Username);
+            if (uCol < 0)
+                continue;
             if (table == currentTable)
             {
-                for (int i = 0; i < model->rowCount(); ++i)
+                if (tableModel && tableModel->findRow(uCol, newVal, sourceRow) >= 0)
                 {
-                    if (i != index.row() && model->index(i, uCol).data(Qt::EditRole).toString() == newVal)
-                    {
-                        QMessageBox::warning(editor->parentWidget(), "Validation Error", "Username '" + newVal + "' already taken.");
-                        return;
-                    }
+                    QMessageBox::warning(editor->parentWidget(), "Validation Error", "Username '" + newVal + "' already taken.");
+                    return;
                 }
+                continue;
             }
-            else
+
+            QVector<QStringList> data;
+            try
             {
-                QVector<QStringList> data;
-                try
-                {
-                    data = AcadenceManager::readCsv(table + ".csv");
-                }
-                catch (...)
-                {
-                    continue;
-                }
+                data = AcadenceManager::table(table->getFileName());
+            }
+            catch (...)
+            {
+                continue;
+            }
 
-                for (const auto &row : data)
+            for (const auto &row : data)
+            {
+                if (row.size() > uCol && row[uCol] == newVal)
                 {
-                    if (row.size() > uCol && row[uCol] == newVal)
-                    {
-                        QMessageBox::warning(editor->parentWidget(), "Validation Error", "Username '" + newVal + "' already taken in " + table + ".");
-                        return;
-                    }
+                    QMessageBox::warning(editor->parentWidget(), "Validation Error", "Username '" + newVal + "' already taken in " + table->getName() + ".");
+                    return;
                 }
             }
         }
     }
 
-    // Password Validation
-    // Admins: Col 2, Students: Col 4, Teachers: Col 4
-    bool isPasswordCol = (currentTable == "admins" && col == 2) ||
-                         ((currentTable == "students" || currentTable == "teachers") && col == 4);
-
-    if (isPasswordCol)
-    {
-        QString error = Utils::validatePassword(newVal);
-        if (!error.isEmpty())
-        {
-            QMessageBox::warning(editor->parentWidget(), "Validation Error", error);
-            return;
-        }
-    }
-
     // --- 3. Apply Data ---
     model->setData(index, newVal, Qt::EditRole);
 }
\ No newline at end of file
@@ -6,9 +6,20 @@
 #include "academicmanager.hpp" // Include your logic class
 #include "timer.hpp"
 #include "circularprogress.hpp"
-#include <QStandardItemModel>
+#include "histogramwidget.hpp"
+#include "riskreport.hpp"
+#include "tablefile.hpp"
+#include "admintablemodel.hpp"
+#include "keyedtablemodel.hpp"
+#include "attendancemodel.hpp"
+#include "attendancegrid.hpp"
+#include "tableregistry.hpp"
 #include <QSortFilterProxyModel>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QThreadPool>
 #include <QStyledItemDelegate>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 namespace Ui
@@ -22,7 +33,7 @@ class CsvDelegate : public QStyledItemDelegate
     Q_OBJECT
 public:
     explicit CsvDelegate(QObject *parent = nullptr);
-    QString currentTable;
+    const TableDescriptor *currentTable = nullptr; ///< Schema of the table being edited.
     QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
     void setEditorData(QWidget *editor, const QModelIndex &index) const override;
     void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const override;
@@ -46,8 +57,16 @@ private slots:
     // Admin Panel Slots
     void on_btnAddRow_clicked();
     void on_btnDeleteRow_clicked();
+    void on_btnImport_clicked();
     void on_tableComboBox_currentTextChanged(const QString &arg1);
     void on_searchLineEdit_textChanged(const QString &arg1);
+    void on_btnRunRiskReport_clicked();
+    void on_btnExportRiskReport_clicked();
+    void on_comboRiskDepartment_currentIndexChanged(int index);
+    void on_comboRiskSemester_currentIndexChanged(int index);
+    void on_btnRefreshDiagnostics_clicked();
+    void on_btnResetDiagnostics_clicked();
+    void on_btnExportDiagnostics_clicked();
 
     // Feature Slots
     void on_addTaskButton_clicked();
@@ -75,6 +94,7 @@ private slots:
     void on_btnCreateAssessment_clicked();
     void on_comboTeacherAssessment_currentIndexChanged(int index);
     void on_btnSaveGrades_clicked();
+    void on_comboStatsDepartment_currentIndexChanged(int index);
     void on_comboAttendanceCourse_currentIndexChanged(int index);
     void on_btnAddClassDate_clicked();
     void on_btnSaveAttendance_clicked();
@@ -89,6 +109,9 @@ private slots:
 
     void onChangePasswordClicked();
 
+    // Change feed: applies rows changed by this or other sessions
+    void onTableChanged(const QString &table, const QVector<TableChange> &changes, quint64 sequence);
+
 private:
     Ui::MainWindow *ui;        ///< Pointer to the UI elements.
     AcadenceManager myManager; ///< The core logic engine.
@@ -102,17 +125,37 @@ private:
     Timer *m_workoutTimer;
     CircularProgress *m_focusProgress;
     CircularProgress *m_workoutProgress;
+    HistogramWidget *m_gradeHistogram;
     DurationHabit *activeTimerHabit; ///< Currently running habit for the timer.
 
-    QStandardItemModel *adminModel;
-    QSortFilterProxyModel *adminProxyModel;
+    KeyedTableModel *routineModel;
+    KeyedTableModel *teacherRoutineModel;
+    KeyedTableModel *academicsModel;
+    AttendanceTableModel *attendanceModel;
+    AttendanceGrid *attendanceGrid; ///< Replaces the tableAttendance placeholder.
+
+    AdminTableModel *adminModel;
+    AdminFilterProxyModel *adminProxyModel;
+    QTimer *adminSearchTimer;                      ///< Debounces typing in the search box.
+    QFutureWatcher<QVector<int>> *adminSearchWatcher; ///< Running admin search, if any.
+    QTimer *adminSaveTimer;                        ///< Coalesces admin edits before saving.
+    QThreadPool adminSavePool;                     ///< Single thread: saves land in edit order.
+    int adminSavesInFlight;
+    QString adminSaveError;                        ///< Last failed save, shown until the next success.
+    std::shared_ptr<quint64> adminSequence;        ///< Storage sequence the admin rows match; saves of the table update it.
     CsvDelegate *csvDelegate;
+    QFutureWatcher<QVector<RiskEntry>> *riskWatcher; ///< Running at-risk report, if any.
+    QVector<RiskEntry> riskEntries;                  ///< Last report, unfiltered.
 
     QString userRole; ///< Current user's role.
     int userId;       ///< Current user's ID.
     QString userName; ///< Current user's name.
 
+    quint64 noticesSequence; ///< Storage sequence the notice list shows.
+    quint64 queriesSequence; ///< Storage sequence the query list shows.
+
     void refreshDashboard();
+    void refreshNotices();
     void refreshPlanner();
     void refreshHabits();
     void refreshRoutine();
@@ -120,8 +163,16 @@ private:
     void refreshAcademics();
     void refreshTeacherTools();
     void refreshTeacherGrades();
+    void refreshGradeStats();
     void refreshTeacherAttendance();
     void refreshQueries();
+    void runAdminSearch();
+    void flushAdminChanges();
+    void updateSaveStatus();
+    QVector<RiskEntry> filteredRiskEntries() const;
+    void showRiskReport();
+    void applyNoticeChanges(const QVector<TableChange> &changes);
+    void applyQueryChanges(const QVector<TableChange> &changes);
 };
 
 #endif // MAINWINDOW_H
\ No newline at end of file
@@ -0,0 +1,203 @@
+/**
+ * @file profiler.cpp
+ * @brief Per-thread probe buffers, merged on demand, and their JSON export.
+ */
+#include "profiler.hpp"
+#include "exceptions.hpp"
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QVector>
+#include <QtAlgorithms>
+#include <memory>
+
+namespace
+{
+    /**
+     * @brief One thread's probes. Its lock is only contended while results() reads it.
+     */
+    struct ThreadBuffer
+    {
+        QMutex mutex;
+        QHash<const char *, ProbeStats> probes;
+    };
+
+    struct Registry
+    {
+        QMutex mutex;
+        QVector<std::shared_ptr<ThreadBuffer>> buffers; ///< Kept after their thread ends.
+    };
+
+    Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    ThreadBuffer &localBuffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = []
+        {
+            auto created = std::make_shared<ThreadBuffer>();
+            QMutexLocker lock(&registry().mutex);
+            registry().buffers.append(created);
+            return created;
+        }();
+        return *buffer;
+    }
+
+    thread_local Profiler::Scope *innermost = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// ProbeStats
+// ---------------------------------------------------------------------------
+
+void ProbeStats::record(quint64 ns)
+{
+    calls++;
+    totalNs += ns;
+    maxNs = qMax(maxNs, ns);
+    quint64 micros = ns / 1000;
+    int bucket = micros == 0 ? 0 : 64 - qCountLeadingZeroBits(micros);
+    histogram[qMin(bucket, BUCKETS - 1)]++;
+}
+
+void ProbeStats::merge(const ProbeStats &other)
+{
+    calls += other.calls;
+    totalNs += other.totalNs;
+    maxNs = qMax(maxNs, other.maxNs);
+    bytesRead += other.bytesRead;
+    bytesWritten += other.bytesWritten;
+    rows += other.rows;
+    for (int i = 0; i < BUCKETS; ++i)
+        histogram[i] += other.histogram[i];
+}
+
+double ProbeStats::percentileMicros(double fraction) const
+{
+    if (calls == 0)
+        return 0.0;
+    quint64 target = qMax<quint64>(1, quint64(fraction * calls + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKETS; ++i)
+    {
+        seen += histogram[i];
+        if (seen >= target)
+            return qMin(double(quint64(1) << i), maxNs / 1000.0);
+    }
+    return maxNs / 1000.0;
+}
+
+// ---------------------------------------------------------------------------
+// Profiler
+// ---------------------------------------------------------------------------
+
+Profiler::Scope::Scope(const char *name) : name(name), parent(innermost), start(std::chrono::steady_clock::now())
+{
+    innermost = this;
+}
+
+Profiler::Scope::~Scope()
+{
+    quint64 ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    innermost = parent;
+
+    ThreadBuffer &buffer = localBuffer();
+    QMutexLocker lock(&buffer.mutex);
+    ProbeStats &stats = buffer.probes[name];
+    stats.record(ns);
+    stats.bytesRead += bytesRead;
+    stats.bytesWritten += bytesWritten;
+    stats.rows += rows;
+}
+
+void Profiler::countRead(qint64 bytes, qint64 rows)
+{
+    if (!innermost)
+        return;
+    innermost->bytesRead += bytes;
+    innermost->rows += rows;
+}
+
+void Profiler::countWritten(qint64 bytes)
+{
+    if (innermost)
+        innermost->bytesWritten += bytes;
+}
+
+QMap<QString, ProbeStats> Profiler::results()
+{
+    QVector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        QMutexLocker lock(&registry().mutex);
+        buffers = registry().buffers;
+    }
+
+    // The same name may be a different literal in another file, so merge by text
+    QMap<QString, ProbeStats> merged;
+    for (const auto &buffer : buffers)
+    {
+        QMutexLocker lock(&buffer->mutex);
+        for (auto it = buffer->probes.constBegin(); it != buffer->probes.constEnd(); ++it)
+            merged[QString::fromLatin1(it.key())].merge(it.value());
+    }
+    return merged;
+}
+
+void Profiler::reset()
+{
+    QMutexLocker registryLock(&registry().mutex);
+    for (const auto &buffer : registry().buffers)
+    {
+        QMutexLocker lock(&buffer->mutex);
+        buffer->probes.clear();
+    }
+}
+
+QByteArray Profiler::toJson()
+{
+    QJsonArray probes;
+    QMap<QString, ProbeStats> all = results();
+    for (auto it = all.constBegin(); it != all.constEnd(); ++it)
+    {
+        const ProbeStats &s = it.value();
+        QJsonArray histogram;
+        int last = ProbeStats::BUCKETS - 1;
+        while (last > 0 && s.histogram[last] == 0)
+            --last;
+        for (int i = 0; i <= last; ++i)
+            histogram.append(double(s.histogram[i]));
+
+        QJsonObject probe;
+        probe["name"] = it.key();
+        probe["calls"] = double(s.calls);
+        probe["totalMs"] = s.totalNs / 1e6;
+        probe["meanUs"] = s.meanMicros();
+        probe["p50Us"] = s.percentileMicros(0.5);
+        probe["p95Us"] = s.percentileMicros(0.95);
+        probe["maxUs"] = s.maxNs / 1000.0;
+        probe["bytesRead"] = double(s.bytesRead);
+        probe["bytesWritten"] = double(s.bytesWritten);
+        probe["rowsParsed"] = double(s.rows);
+        probe["histogramUs"] = histogram; // Bucket i: calls under 2^i us
+        probes.append(probe);
+    }
+
+    QJsonObject root;
+    root["enabled"] = ENABLED;
+    root["probes"] = probes;
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+void Profiler::exportJson(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        throw Acadence::FileException("Failed to open file for writing: " + path);
+    file.write(toJson());
+}
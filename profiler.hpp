@@ -0,0 +1,111 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include "tracer.hpp"
+#include <array>
+#include <chrono>
+
+/**
+ * @brief Aggregated measurements of one probe.
+ */
+struct ProbeStats
+{
+    static const int BUCKETS = 32; ///< Bucket 0 counts calls under 1 us, bucket i under 2^i us.
+
+    quint64 calls = 0;
+    quint64 totalNs = 0;
+    quint64 maxNs = 0;
+    quint64 bytesRead = 0;
+    quint64 bytesWritten = 0;
+    quint64 rows = 0; ///< CSV rows parsed.
+    std::array<quint64, BUCKETS> histogram{};
+
+    void record(quint64 ns);
+    void merge(const ProbeStats &other);
+
+    double meanMicros() const { return calls ? totalNs / 1000.0 / calls : 0.0; }
+
+    /**
+     * @brief Latency below which @p fraction of the calls fall, to the
+     * histogram's resolution (a power of two, capped at the maximum).
+     */
+    double percentileMicros(double fraction) const;
+};
+
+/**
+ * @brief Low-overhead instrumentation of the hot paths.
+ *
+ * ACADENCE_PROFILE("name") opens a scoped probe: on leaving the scope its
+ * call and latency are added to the calling thread's own buffer, so probes
+ * on worker threads never contend. I/O counted with ACADENCE_PROFILE_READ /
+ * ACADENCE_PROFILE_WRITTEN goes to the innermost open probe. results()
+ * merges every thread's buffer on demand.
+ *
+ * The probes are compiled in only with ACADENCE_ENABLE_PROFILING (CMake
+ * option of the same name); otherwise the macros expand to nothing. Either
+ * way ACADENCE_PROFILE also opens a Tracer span, so a trace shows every
+ * probe on its thread's timeline.
+ */
+class Profiler
+{
+public:
+#ifdef ACADENCE_ENABLE_PROFILING
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        friend class Profiler;
+        const char *name;
+        Scope *parent; ///< Enclosing probe on this thread.
+        std::chrono::steady_clock::time_point start;
+        quint64 bytesRead = 0;
+        quint64 bytesWritten = 0;
+        quint64 rows = 0;
+    };
+
+    static void countRead(qint64 bytes, qint64 rows);
+    static void countWritten(qint64 bytes);
+
+    /**
+     * @brief Measurements of every probe so far, all threads merged.
+     */
+    static QMap<QString, ProbeStats> results();
+
+    static void reset();
+
+    static QByteArray toJson();
+
+    /**
+     * @throws Acadence::FileException if the file cannot be written.
+     */
+    static void exportJson(const QString &path);
+};
+
+#ifdef ACADENCE_ENABLE_PROFILING
+#define ACADENCE_PROFILE_CONCAT2(a, b) a##b
+#define ACADENCE_PROFILE_CONCAT(a, b) ACADENCE_PROFILE_CONCAT2(a, b)
+#define ACADENCE_PROFILE(name)                                              \
+    Profiler::Scope ACADENCE_PROFILE_CONCAT(acadenceProbe, __LINE__)(name); \
+    ACADENCE_TRACE("probe", name)
+#define ACADENCE_PROFILE_READ(bytes, rows) Profiler::countRead(bytes, rows)
+#define ACADENCE_PROFILE_WRITTEN(bytes) Profiler::countWritten(bytes)
+#else
+#define ACADENCE_PROFILE(name) ACADENCE_TRACE("probe", name)
+#define ACADENCE_PROFILE_READ(bytes, rows) (void)0
+#define ACADENCE_PROFILE_WRITTEN(bytes) (void)0
+#endif
+
+#endif // PROFILER_HPP
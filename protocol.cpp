@@ -0,0 +1,223 @@
+/**
+ * @file protocol.cpp
+ * @brief Framing and (de)serialisation helpers for the local server protocol.
+ */
+#include "protocol.hpp"
+#include "exceptions.hpp"
+#include <QtEndian>
+#include <algorithm>
+
+const char *const Protocol::DEFAULT_SERVER_NAME = "acadence";
+
+static const int HEADER_SIZE = 4 + 4 + 1; // length, requestId, op
+
+QByteArray Protocol::frame(quint32 requestId, Op op, const QByteArray &body)
+{
+    QByteArray out;
+    out.reserve(HEADER_SIZE + body.size());
+    quint32 length = 4 + 1 + body.size(); // Everything after the length field
+    char header[HEADER_SIZE];
+    qToBigEndian(length, header);
+    qToBigEndian(requestId, header + 4);
+    header[8] = static_cast<char>(op);
+    out.append(header, HEADER_SIZE);
+    out.append(body);
+    return out;
+}
+
+bool Protocol::takeFrame(QByteArray &buffer, quint32 maxLength, quint32 &requestId, Op &op, QByteArray &body)
+{
+    // The length is checked as soon as it arrives, before anything is buffered for it
+    if (buffer.size() < 4)
+        return false;
+    quint32 length = qFromBigEndian<quint32>(buffer.constData());
+    if (length < quint32(HEADER_SIZE - 4) || length > maxLength)
+        throw Acadence::Exception("Malformed frame of " + QString::number(length) + " bytes");
+    if (static_cast<quint64>(buffer.size()) < 4 + static_cast<quint64>(length))
+        return false;
+
+    requestId = qFromBigEndian<quint32>(buffer.constData() + 4);
+    op = static_cast<Op>(static_cast<quint8>(buffer[8]));
+    body = buffer.mid(HEADER_SIZE, length - (HEADER_SIZE - 4));
+    buffer.remove(0, 4 + length);
+    return true;
+}
+
+void Protocol::writeString(QDataStream &out, const QString &s)
+{
+    out << s.toUtf8();
+}
+
+QString Protocol::readString(QDataStream &in)
+{
+    QByteArray utf8;
+    in >> utf8;
+    return QString::fromUtf8(utf8);
+}
+
+void Protocol::writeRows(QDataStream &out, const CsvTable &rows)
+{
+    out << quint32(rows.size());
+    for (const auto &row : rows)
+    {
+        out << quint16(row.size());
+        for (const QString &field : row)
+            writeString(out, field);
+    }
+}
+
+/**
+ * @brief Capacity worth reserving for @p count items of at least @p minSize
+ * bytes each: a count from the wire is never trusted beyond the bytes left.
+ */
+static quint32 plausibleCount(QDataStream &in, quint32 count, qint64 minSize)
+{
+    qint64 available = in.device() ? in.device()->bytesAvailable() : 0;
+    return static_cast<quint32>(std::min<qint64>(count, available / minSize));
+}
+
+QStringList Protocol::readStringList(QDataStream &in)
+{
+    quint32 count = 0;
+    in >> count;
+    QStringList list;
+    list.reserve(plausibleCount(in, count, 4));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString s;
+        in >> s;
+        list << s;
+    }
+    return list;
+}
+
+CsvTable Protocol::readRows(QDataStream &in)
+{
+    quint32 count = 0;
+    in >> count;
+    CsvTable rows;
+    rows.reserve(plausibleCount(in, count, 2));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        quint16 fields = 0;
+        in >> fields;
+        QStringList row;
+        row.reserve(plausibleCount(in, fields, 4));
+        for (quint16 f = 0; f < fields && in.status() == QDataStream::Ok; ++f)
+            row << readString(in);
+        rows.append(row);
+    }
+    return rows;
+}
+
+void Protocol::writeChanges(QDataStream &out, const QVector<TableChange> &changes)
+{
+    out << quint32(changes.size());
+    for (const auto &change : changes)
+    {
+        out << quint8(change.getType()) << quint16(change.getRow().size());
+        for (const QString &field : change.getRow())
+            writeString(out, field);
+    }
+}
+
+QVector<TableChange> Protocol::readChanges(QDataStream &in)
+{
+    quint32 count = 0;
+    in >> count;
+    QVector<TableChange> changes;
+    changes.reserve(plausibleCount(in, count, 3));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        quint8 type = 0;
+        quint16 fields = 0;
+        in >> type >> fields;
+        if (type > TableChange::None)
+        {
+            in.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        QStringList row;
+        row.reserve(plausibleCount(in, fields, 4));
+        for (quint16 f = 0; f < fields && in.status() == QDataStream::Ok; ++f)
+            row << readString(in);
+        changes.append(TableChange(static_cast<TableChange::Type>(type), row));
+    }
+    return changes;
+}
+
+/**
+ * @brief Writes a semester-keyed map as a count and (qint32, value) pairs.
+ */
+template <typename T>
+static void writeSemesterMap(QDataStream &out, const QMap<int, T> &map)
+{
+    out << quint32(map.size());
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+        out << qint32(it.key()) << it.value();
+}
+
+template <typename T>
+static QMap<int, T> readSemesterMap(QDataStream &in)
+{
+    quint32 count = 0;
+    in >> count;
+    QMap<int, T> map;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        qint32 key = 0;
+        T value{};
+        in >> key >> value;
+        if (in.status() == QDataStream::Ok)
+            map.insert(key, value);
+    }
+    return map;
+}
+
+void Protocol::writeGpa(QDataStream &out, const GpaRecord &record)
+{
+    writeSemesterMap(out, record.semesterGpa);
+    writeSemesterMap(out, record.semesterCredits);
+    out << record.cgpa << qint32(record.credits);
+}
+
+GpaRecord Protocol::readGpa(QDataStream &in)
+{
+    GpaRecord record;
+    record.semesterGpa = readSemesterMap<double>(in);
+    record.semesterCredits = readSemesterMap<int>(in);
+    qint32 credits = 0;
+    in >> record.cgpa >> credits;
+    record.credits = credits;
+    return record;
+}
+
+void Protocol::writeAttendance(QDataStream &out, const QVector<AttendanceRecord> &records)
+{
+    out << quint32(records.size());
+    for (const auto &r : records)
+    {
+        writeString(out, r.getCourseName());
+        out << qint32(r.getTotalClasses()) << qint32(r.getAttendedClasses()) << r.getTotalMarksObtained() << r.getTotalMaxMarks();
+    }
+}
+
+QVector<AttendanceRecord> Protocol::readAttendance(QDataStream &in)
+{
+    quint32 count = 0;
+    in >> count;
+    QVector<AttendanceRecord> records;
+    records.reserve(plausibleCount(in, count, 28));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString course = readString(in);
+        qint32 total = 0;
+        qint32 attended = 0;
+        double marks = 0;
+        double max = 0;
+        in >> total >> attended >> marks >> max;
+        if (in.status() == QDataStream::Ok)
+            records.append(AttendanceRecord(course, total, attended, marks, max));
+    }
+    return records;
+}
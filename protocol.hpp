@@ -0,0 +1,93 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "academicmanager.hpp"
+#include "datastore.hpp"
+#include "gpaengine.hpp"
+#include "tablefile.hpp"
+
+/**
+ * @brief Binary wire format spoken between acadence-server and its clients.
+ *
+ * Every message is a frame: [quint32 length][quint32 requestId][quint8 op][body].
+ * Replies carry the id of their request, so a client may send several
+ * requests before reading any reply (pipelining). Text travels as UTF-8.
+ *
+ * Besides whole tables, the server answers the AcadenceManager queries a
+ * user's own screens make (Select, StudentGpa, StudentAttendance), so a
+ * client can show them without holding the tables they are computed from.
+ *
+ * Frames come from other processes, so nothing read from them is trusted:
+ * counts never size an allocation beyond the bytes actually received, and
+ * the read* helpers stop at the first malformed value, leaving the stream
+ * with a status other than QDataStream::Ok.
+ */
+class Protocol
+{
+public:
+    enum Op : quint8
+    {
+        // Requests
+        FetchTables = 1,  ///< body: QStringList names -> Tables
+        FetchChanges = 2, ///< body: name, quint64 seq -> Changes
+        Commit = 3,       ///< body: writes -> Committed | Conflict
+        Subscribe = 4,    ///< body: empty -> Notify (empty), then pushed Notify frames
+        Select = 5,       ///< body: name, qint32 column (-1: any row), value, quint32 offset, quint32 limit -> Rows
+        StudentGpa = 6,   ///< body: qint32 studentId -> Gpa
+        StudentAttendance = 7, ///< body: qint32 studentId -> Attendance
+
+        // Replies
+        Tables = 100,    ///< body: count, {name, seq, rows}...
+        Changes = 101,   ///< body: quint64 seq, bool complete, changes | rows
+        Committed = 102, ///< body: count, {name, seq}...
+        Conflict = 103,  ///< body: QStringList stale names
+        Error = 104,     ///< body: QString message
+        Notify = 105,    ///< body: name, quint64 seq; pushed with requestId 0
+        Rows = 106,      ///< body: quint32 total matches, rows
+        Gpa = 107,       ///< body: GpaRecord
+        Attendance = 108 ///< body: count, {course name, qint32 total, qint32 attended, double marks, double max}...
+    };
+
+    static const char *const DEFAULT_SERVER_NAME; ///< QLocalServer name used when none is given.
+
+    static const quint32 MAX_REQUEST_SIZE = 64u << 20; ///< Largest frame the server accepts.
+    static const quint32 MAX_REPLY_SIZE = 1u << 30;    ///< Largest frame a client accepts (whole tables).
+
+    /**
+     * @brief Wraps a body into a length-prefixed frame.
+     */
+    static QByteArray frame(quint32 requestId, Op op, const QByteArray &body);
+
+    /**
+     * @brief Removes one complete frame from the front of @p buffer.
+     * @param maxLength Largest frame the caller accepts from its peer.
+     * @return False if the buffer does not hold a complete frame yet.
+     * @throws Acadence::Exception if the length is impossible or above
+     * @p maxLength; the stream cannot be resynchronised, so the caller
+     * must drop the connection.
+     */
+    static bool takeFrame(QByteArray &buffer, quint32 maxLength, quint32 &requestId, Op &op, QByteArray &body);
+
+    static void writeString(QDataStream &out, const QString &s);
+    static QString readString(QDataStream &in);
+
+    /**
+     * @brief Reads a QStringList written with operator<<, without trusting its count.
+     */
+    static QStringList readStringList(QDataStream &in);
+    static void writeRows(QDataStream &out, const CsvTable &rows);
+    static CsvTable readRows(QDataStream &in);
+    static void writeChanges(QDataStream &out, const QVector<TableChange> &changes);
+    static QVector<TableChange> readChanges(QDataStream &in);
+    static void writeGpa(QDataStream &out, const GpaRecord &record);
+    static GpaRecord readGpa(QDataStream &in);
+    static void writeAttendance(QDataStream &out, const QVector<AttendanceRecord> &records);
+    static QVector<AttendanceRecord> readAttendance(QDataStream &in);
+};
+
+#endif // PROTOCOL_HPP
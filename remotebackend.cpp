@@ -0,0 +1,237 @@
+/**
+ * @file remotebackend.cpp
+ * @brief Client side of the local server protocol.
+ */
+#include "remotebackend.hpp"
+#include "exceptions.hpp"
+#include <QHash>
+
+static const int CONNECT_TIMEOUT_MS = 1000;
+static const int REPLY_TIMEOUT_MS = 30000;
+
+RemoteBackend::RemoteBackend(const QString &serverName) : serverName(serverName), nextRequestId(1) {}
+
+bool RemoteBackend::isAvailable(const QString &serverName)
+{
+    QLocalSocket probe;
+    probe.connectToServer(serverName);
+    return probe.waitForConnected(CONNECT_TIMEOUT_MS);
+}
+
+RemoteBackend::Connection *RemoteBackend::connection()
+{
+    if (!connections.hasLocalData())
+        connections.setLocalData(new Connection);
+
+    Connection *c = connections.localData();
+    if (c->socket.state() != QLocalSocket::ConnectedState)
+    {
+        c->buffer.clear();
+        c->socket.connectToServer(serverName);
+        if (!c->socket.waitForConnected(CONNECT_TIMEOUT_MS))
+        {
+            throw Acadence::FileException("Cannot reach acadence-server '" + serverName + "': " + c->socket.errorString());
+        }
+    }
+    return c;
+}
+
+QVector<RemoteBackend::Reply> RemoteBackend::call(const QVector<QPair<Protocol::Op, QByteArray>> &requests)
+{
+    Connection *c = connection();
+
+    // Pipeline: write every request before waiting for the first reply
+    QHash<quint32, int> pending;
+    QByteArray out;
+    for (int i = 0; i < requests.size(); ++i)
+    {
+        quint32 id = nextRequestId++;
+        pending.insert(id, i);
+        out += Protocol::frame(id, requests[i].first, requests[i].second);
+    }
+    c->socket.write(out);
+
+    QVector<Reply> replies(requests.size());
+    int remaining = requests.size();
+    while (remaining > 0)
+    {
+        quint32 id;
+        Protocol::Op op;
+        QByteArray body;
+        try
+        {
+            while (remaining > 0 && Protocol::takeFrame(c->buffer, Protocol::MAX_REPLY_SIZE, id, op, body))
+            {
+                auto it = pending.find(id);
+                if (it == pending.end())
+                    continue; // Late reply to a call that was abandoned
+                replies[it.value()].op = op;
+                replies[it.value()].body = body;
+                pending.erase(it);
+                remaining--;
+            }
+        }
+        catch (const Acadence::Exception &e)
+        {
+            c->socket.abort();
+            throw Acadence::FileException("Lost connection to acadence-server: " + QString::fromUtf8(e.what()));
+        }
+        if (remaining == 0)
+            break;
+        if (!c->socket.waitForReadyRead(REPLY_TIMEOUT_MS))
+        {
+            c->socket.abort();
+            throw Acadence::FileException("Lost connection to acadence-server: " + c->socket.errorString());
+        }
+        c->buffer += c->socket.readAll();
+    }
+
+    for (const Reply &r : replies)
+    {
+        if (r.op == Protocol::Error)
+        {
+            QDataStream in(r.body);
+            throw Acadence::Exception(Protocol::readString(in));
+        }
+    }
+    return replies;
+}
+
+QVector<TableSnapshotPtr> RemoteBackend::load(const QStringList &names, quint64 version)
+{
+    QVector<QPair<Protocol::Op, QByteArray>> requests;
+    for (const QString &name : names)
+    {
+        QByteArray body;
+        QDataStream out(&body, QIODevice::WriteOnly);
+        out << QStringList{name};
+        requests.append({Protocol::FetchTables, body});
+    }
+
+    QVector<TableSnapshotPtr> tables;
+    for (const Reply &r : call(requests))
+    {
+        QDataStream in(r.body);
+        quint32 count = 0;
+        in >> count;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+        {
+            QString name = Protocol::readString(in);
+            quint64 seq = 0;
+            in >> seq;
+            CsvTable rows = Protocol::readRows(in);
+            if (in.status() == QDataStream::Ok)
+                tables.append(std::make_shared<const TableSnapshot>(name, rows, version, seq));
+        }
+        if (in.status() != QDataStream::Ok)
+            throw Acadence::FileException("Malformed table reply from acadence-server");
+    }
+    return tables;
+}
+
+TableSnapshotPtr RemoteBackend::refresh(const TableSnapshotPtr &old, const QString &name, quint64 version)
+{
+    if (!old)
+        return load({name}, version).value(0);
+
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    Protocol::writeString(out, name);
+    out << old->getSequence();
+
+    Reply r = call({{Protocol::FetchChanges, body}}).first();
+    QDataStream in(r.body);
+    quint64 seq = 0;
+    bool complete = false;
+    in >> seq >> complete;
+
+    if (seq == old->getSequence())
+        return old;
+
+    CsvTable rows;
+    if (complete)
+    {
+        // Only the changed rows crossed the socket
+        QVector<TableChange> changes = Protocol::readChanges(in);
+        if (in.status() != QDataStream::Ok)
+            throw Acadence::FileException("Malformed change reply from acadence-server");
+        rows = old->getRows();
+        if (!TableChange::apply(rows, changes, TableFile::keyColumns(name)))
+            return load({name}, version).value(0);
+    }
+    else
+    {
+        rows = Protocol::readRows(in);
+        if (in.status() != QDataStream::Ok)
+            throw Acadence::FileException("Malformed change reply from acadence-server");
+    }
+    return std::make_shared<const TableSnapshot>(name, rows, version, seq);
+}
+
+QStringList RemoteBackend::write(QVector<TableWrite> &writes)
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out << quint32(writes.size());
+    for (auto &w : writes)
+    {
+        Protocol::writeString(out, w.name);
+        out << w.baseSequence;
+        if (!w.rewritten)
+        {
+            out << quint8(0);
+            Protocol::writeRows(out, w.appended);
+            if (!w.changesKnown)
+                w.changes = TableChange::diff({}, w.appended, {});
+            continue;
+        }
+
+        // Send the row changes unless they cannot describe the rewrite
+        if (!w.changesKnown)
+            w.changes = TableChange::diff(w.baseRows, w.rows, TableFile::keyColumns(w.name));
+        bool describable = true;
+        for (const auto &change : w.changes)
+            describable = describable && change.getType() != TableChange::Rewrite;
+        if (describable)
+        {
+            out << quint8(1);
+            Protocol::writeChanges(out, w.changes);
+        }
+        else
+        {
+            out << quint8(2);
+            Protocol::writeRows(out, w.rows);
+        }
+    }
+
+    // The server drops a client that sends a larger frame (body plus request id and op)
+    if (body.size() > qsizetype(Protocol::MAX_REQUEST_SIZE) - 5)
+        throw Acadence::FileException("Commit too large for acadence-server (" + QString::number(body.size() >> 20) + " MiB)");
+
+    Reply r = call({{Protocol::Commit, body}}).first();
+    QDataStream in(r.body);
+    if (r.op == Protocol::Conflict)
+        return Protocol::readStringList(in);
+
+    quint32 count = 0;
+    in >> count;
+    QHash<QString, quint64> seqs;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString name = Protocol::readString(in);
+        quint64 seq = 0;
+        in >> seq;
+        seqs.insert(name, seq);
+    }
+    // The server has committed; only the new sequences were lost
+    if (in.status() != QDataStream::Ok)
+        throw Acadence::FileException("Malformed commit reply from acadence-server");
+    for (auto &w : writes)
+        w.newSequence = seqs.value(w.name, w.baseSequence + 1);
+    return {};
+}
+
+QByteArray RemoteBackend::query(Protocol::Op op, const QByteArray &request)
+{
+    return call({{op, request}}).first().body;
+}
@@ -0,0 +1,63 @@
+#ifndef REMOTEBACKEND_HPP
+#define REMOTEBACKEND_HPP
+
+#include <QByteArray>
+#include <QLocalSocket>
+#include <QThreadStorage>
+#include <atomic>
+#include "storagebackend.hpp"
+#include "protocol.hpp"
+
+/**
+ * @brief Storage backend that forwards loads and commits to acadence-server.
+ *
+ * The server parses the CSV files once and keeps them in memory; clients
+ * receive rows in binary form and only hold the tables they use. A user's
+ * own records (their rows, GPA and attendance summary) are answered by the
+ * server through query(), so loading them holds no table at all. Each thread
+ * talks to the server over its own QLocalSocket.
+ */
+class RemoteBackend : public StorageBackend
+{
+public:
+    explicit RemoteBackend(const QString &serverName);
+
+    /**
+     * @brief Checks whether a server is listening under the given name.
+     */
+    static bool isAvailable(const QString &serverName);
+
+    QVector<TableSnapshotPtr> load(const QStringList &names, quint64 version) override;
+    TableSnapshotPtr refresh(const TableSnapshotPtr &old, const QString &name, quint64 version) override;
+    QStringList write(QVector<TableWrite> &writes) override;
+    bool isRemote() const override { return true; }
+    QByteArray query(Protocol::Op op, const QByteArray &request) override;
+
+private:
+    struct Connection
+    {
+        QLocalSocket socket;
+        QByteArray buffer; ///< Bytes received but not yet parsed into frames.
+    };
+
+    struct Reply
+    {
+        Protocol::Op op = Protocol::Error;
+        QByteArray body;
+    };
+
+    Connection *connection();
+
+    /**
+     * @brief Sends all requests back to back, then collects the replies.
+     * @throws Acadence::FileException if the server goes away,
+     *         Acadence::Exception if it reports an error.
+     */
+    QVector<Reply> call(const QVector<QPair<Protocol::Op, QByteArray>> &requests);
+
+    QString serverName;
+    QThreadStorage<Connection *> connections;
+    std::atomic<quint32> nextRequestId;
+};
+
+#endif // REMOTEBACKEND_HPP
@@ -0,0 +1,247 @@
+/**
+ * @file riskreport.cpp
+ * @brief Single-pass, parallel join of attendance and grades for the at-risk report.
+ */
+#include "riskreport.hpp"
+#include "academicmanager.hpp"
+#include "datastore.hpp"
+#include "gpaengine.hpp"
+#include <QHash>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+static const int MIN_CHUNK_ROWS = 4096; ///< Rows aggregated by one task at least.
+
+namespace
+{
+    struct CourseInfo
+    {
+        int id;
+        QString code;
+        QString name;
+        int semester;
+        int slot; ///< Position among the courses of its semester.
+    };
+
+    struct StudentInfo
+    {
+        int id;
+        QString name;
+        QString department;
+        int semester;
+        int base; ///< First cell of the student's (student, course) block.
+    };
+
+    struct Range
+    {
+        int begin;
+        int end;
+    };
+
+    struct AttendancePartial
+    {
+        QVector<int> attended;        ///< Per cell.
+        QVector<QSet<QString>> dates; ///< Per course: dates a class was held.
+    };
+
+    struct GradePartial
+    {
+        QVector<double> marks; ///< Per cell.
+        QSet<int> graded;      ///< Assessments with at least one mark.
+    };
+
+    QVector<Range> splitRows(int count)
+    {
+        int chunk = std::max(MIN_CHUNK_ROWS, count / QThread::idealThreadCount() + 1);
+        QVector<Range> ranges;
+        for (int begin = 0; begin < count; begin += chunk)
+            ranges.append({begin, std::min(count, begin + chunk)});
+        return ranges;
+    }
+}
+
+RiskReport::RiskReport(double minAttendance) : minAttendance(minAttendance) {}
+
+QVector<RiskEntry> RiskReport::run() const
+{
+    DataSnapshotPtr snap = DataStore::instance().snapshot(
+        {"students.csv", "courses.csv", "assessments.csv", "attendance.csv", "grades.csv", "gradescale.csv"});
+    GradeScale scale = GradeScale::fromRows(snap->table("gradescale.csv")->getRows());
+
+    // --- Build side: courses, students and assessments by ID ---
+    QVector<CourseInfo> courses;
+    QHash<int, int> courseIndex;
+    QHash<int, QVector<int>> semesterCourses; ///< Semester -> course indexes, in slot order.
+    // Format: ID,Code,Name,TeacherID,Semester,Credits
+    for (const auto &row : snap->table("courses.csv")->getRows())
+    {
+        if (row.size() < 6)
+            continue;
+        int semester = row[4].toInt();
+        QVector<int> &list = semesterCourses[semester];
+        courseIndex.insert(row[0].toInt(), courses.size());
+        courses.append({row[0].toInt(), row[1], row[2], semester, int(list.size())});
+        list.append(courses.size() - 1);
+    }
+
+    QVector<StudentInfo> students;
+    QHash<int, int> studentIndex;
+    int cells = 0;
+    // Format: ID,Name,Email,Username,Password,Dept,Batch,Sem,DateAdmission,CGPA
+    for (const auto &row : snap->table("students.csv")->getRows())
+    {
+        if (row.size() < 8)
+            continue;
+        int semester = row[7].toInt();
+        studentIndex.insert(row[0].toInt(), students.size());
+        students.append({row[0].toInt(), row[1], row[5], semester, cells});
+        cells += semesterCourses.value(semester).size();
+    }
+
+    QHash<int, QPair<int, int>> assessments; ///< ID -> (course index, max marks).
+    // Format: ID,CourseID,Title,Type,Date,MaxMarks
+    for (const auto &row : snap->table("assessments.csv")->getRows())
+    {
+        int c = row.size() >= 6 ? courseIndex.value(row[1].toInt(), -1) : -1;
+        if (c >= 0)
+            assessments.insert(row[0].toInt(), {c, row[5].toInt()});
+    }
+
+    // Only courses of the student's own semester are tracked, as in the Academics view
+    auto cellOf = [&](int studentId, int c) -> int
+    {
+        int s = studentIndex.value(studentId, -1);
+        if (s < 0 || courses[c].semester != students[s].semester)
+            return -1;
+        return students[s].base + courses[c].slot;
+    };
+
+    // --- Probe side: attendance, chunks aggregated in parallel ---
+    const CsvTable &attendanceRows = snap->table("attendance.csv")->getRows();
+    QVector<AttendancePartial> attendanceParts = QtConcurrent::blockingMapped<QVector<AttendancePartial>>(
+        splitRows(attendanceRows.size()), [&](const Range &range)
+        {
+            AttendancePartial part;
+            part.attended.fill(0, cells);
+            part.dates.resize(courses.size());
+            // Format: CourseID,StudentID,Date,Present
+            for (int i = range.begin; i < range.end; ++i)
+            {
+                const QStringList &row = attendanceRows[i];
+                int c = row.size() >= 4 ? courseIndex.value(row[0].toInt(), -1) : -1;
+                if (c < 0)
+                    continue;
+                part.dates[c].insert(row[2]);
+                int cell = row[3] == "1" ? cellOf(row[1].toInt(), c) : -1;
+                if (cell >= 0)
+                    part.attended[cell]++;
+            }
+            return part; });
+
+    // --- Probe side: grades ---
+    const CsvTable &gradeRows = snap->table("grades.csv")->getRows();
+    QVector<GradePartial> gradeParts = QtConcurrent::blockingMapped<QVector<GradePartial>>(
+        splitRows(gradeRows.size()), [&](const Range &range)
+        {
+            GradePartial part;
+            part.marks.fill(0.0, cells);
+            // Format: StudentID,AssessmentID,Marks
+            for (int i = range.begin; i < range.end; ++i)
+            {
+                const QStringList &row = gradeRows[i];
+                if (row.size() < 3)
+                    continue;
+                auto a = assessments.constFind(row[1].toInt());
+                if (a == assessments.constEnd())
+                    continue;
+                part.graded.insert(a.key());
+                int cell = cellOf(row[0].toInt(), a->first);
+                if (cell >= 0)
+                    part.marks[cell] += row[2].toDouble();
+            }
+            return part; });
+
+    // --- Merge the partial aggregates ---
+    QVector<int> attended(cells, 0);
+    QVector<int> held(courses.size(), 0);
+    QVector<QSet<QString>> dates(courses.size());
+    for (const AttendancePartial &part : attendanceParts)
+    {
+        for (int i = 0; i < cells; ++i)
+            attended[i] += part.attended[i];
+        for (int c = 0; c < courses.size(); ++c)
+            dates[c].unite(part.dates[c]);
+    }
+    for (int c = 0; c < courses.size(); ++c)
+        held[c] = dates[c].size();
+
+    QVector<double> marks(cells, 0.0);
+    QSet<int> graded;
+    for (const GradePartial &part : gradeParts)
+    {
+        for (int i = 0; i < cells; ++i)
+            marks[i] += part.marks[i];
+        graded.unite(part.graded);
+    }
+    QVector<double> gradedMax(courses.size(), 0.0);
+    for (int id : graded)
+    {
+        const QPair<int, int> &a = assessments[id];
+        gradedMax[a.first] += a.second;
+    }
+
+    // --- Emit the students at risk ---
+    QVector<RiskEntry> entries;
+    for (const StudentInfo &student : students)
+    {
+        const QVector<int> list = semesterCourses.value(student.semester);
+        for (int c : list)
+        {
+            int cell = student.base + courses[c].slot;
+            RiskEntry entry;
+            entry.classesHeld = held[c];
+            entry.classesAttended = attended[cell];
+            entry.marks = marks[cell];
+            entry.gradedMaxMarks = gradedMax[c];
+            entry.lowAttendance = entry.classesHeld > 0 && entry.attendancePercent() < minAttendance;
+            entry.failing = entry.gradedMaxMarks > 0 && scale.lookup(entry.marksPercent()).points <= 0;
+            if (!entry.lowAttendance && !entry.failing)
+                continue;
+            entry.studentId = student.id;
+            entry.studentName = student.name;
+            entry.department = student.department;
+            entry.semester = student.semester;
+            entry.courseCode = courses[c].code;
+            entry.courseName = courses[c].name;
+            entries.append(entry);
+        }
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const RiskEntry &a, const RiskEntry &b)
+                     {
+        if (a.department != b.department)
+            return a.department < b.department;
+        if (a.semester != b.semester)
+            return a.semester < b.semester;
+        return a.studentId < b.studentId; });
+    return entries;
+}
+
+void RiskReport::exportCsv(const QVector<RiskEntry> &entries, const QString &path)
+{
+    QVector<QStringList> rows;
+    rows.reserve(entries.size() + 1);
+    rows.append({"StudentID", "Name", "Dept", "Sem", "CourseCode", "Course", "ClassesHeld", "ClassesAttended",
+                 "AttendancePercent", "Marks", "GradedMaxMarks", "MarksPercent", "LowAttendance", "Failing"});
+    for (const RiskEntry &e : entries)
+    {
+        rows.append({QString::number(e.studentId), e.studentName, e.department, QString::number(e.semester),
+                     e.courseCode, e.courseName, QString::number(e.classesHeld), QString::number(e.classesAttended),
+                     QString::number(e.attendancePercent(), 'f', 1), QString::number(e.marks),
+                     QString::number(e.gradedMaxMarks), QString::number(e.marksPercent(), 'f', 1),
+                     e.lowAttendance ? "1" : "0", e.failing ? "1" : "0"});
+    }
+    AcadenceManager::writeCsv(path, rows);
+}
@@ -0,0 +1,65 @@
+#ifndef RISKREPORT_HPP
+#define RISKREPORT_HPP
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief One student in one course who is at risk.
+ */
+struct RiskEntry
+{
+    int studentId = 0;
+    QString studentName;
+    QString department;
+    int semester = 0;
+    QString courseCode;
+    QString courseName;
+    int classesHeld = 0;
+    int classesAttended = 0;
+    double marks = 0;
+    double gradedMaxMarks = 0; ///< Maximum marks of the course's assessments graded so far.
+    bool lowAttendance = false;
+    bool failing = false;
+
+    double attendancePercent() const { return classesHeld > 0 ? classesAttended * 100.0 / classesHeld : 100.0; }
+    double marksPercent() const { return gradedMaxMarks > 0 ? marks * 100.0 / gradedMaxMarks : 0.0; }
+};
+
+/**
+ * @brief Finds every student at risk in any course of their semester:
+ * attendance below a threshold, or marks that earn no grade points.
+ *
+ * The report reads each table once. Students, courses and assessments are
+ * put in hash tables; attendance.csv and grades.csv are then split into
+ * chunks aggregated in parallel on the global thread pool (hash join on
+ * course, student and assessment IDs) and the partial counts summed.
+ * Attendance is counted like the student Academics view: the classes held
+ * are the distinct dates recorded for the course. Marks are judged against
+ * the assessments graded so far, using the grade-point scale of GpaEngine.
+ */
+class RiskReport
+{
+public:
+    /**
+     * @param minAttendance Attendance percentage below which a student is at risk.
+     */
+    explicit RiskReport(double minAttendance = 75.0);
+
+    /**
+     * @brief Builds the report. Blocks; run it off the GUI thread.
+     * @return Entries sorted by department, semester, student and course.
+     */
+    QVector<RiskEntry> run() const;
+
+    /**
+     * @brief Writes entries as CSV with a header line.
+     * @throws Acadence::FileException if the file cannot be written.
+     */
+    static void exportCsv(const QVector<RiskEntry> &entries, const QString &path);
+
+private:
+    double minAttendance;
+};
+
+#endif // RISKREPORT_HPP
@@ -0,0 +1,58 @@
+/**
+ * @file servermain.cpp
+ * @brief Entry point of acadence-server, the shared data server.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QTextStream>
+#include "academicmanager.hpp"
+#include "dataserver.hpp"
+#include "changefeed.hpp"
+#include "protocol.hpp"
+#include "exceptions.hpp"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("acadence-server");
+    a.setOrganizationName("MyOrganization");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Keeps the Acadence tables in memory and serves them to local clients.");
+    parser.addHelpOption();
+    QCommandLineOption nameOption("name", "Server name clients pass to --server.", "name", Protocol::DEFAULT_SERVER_NAME);
+    QCommandLineOption dirOption("data-dir", "Directory holding the CSV files.", "dir", QDir::currentPath());
+    parser.addOption(nameOption);
+    parser.addOption(dirOption);
+    parser.process(a);
+
+    QTextStream err(stderr);
+    if (!QDir::setCurrent(parser.value(dirOption)))
+    {
+        err << "Cannot enter data directory " << parser.value(dirOption) << "\n";
+        return 1;
+    }
+
+    AcadenceManager::initializeDataFiles();
+
+    DataServer server;
+    try
+    {
+        server.preload(AcadenceManager::dataFiles());
+        // Commits made by instances using the files directly are passed on too
+        ChangeFeed::instance().watchFiles(AcadenceManager::dataFiles());
+    }
+    catch (const Acadence::Exception &e)
+    {
+        err << "Failed to load data: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (!server.listen(parser.value(nameOption)))
+    {
+        err << "Cannot listen on " << parser.value(nameOption) << ": " << server.errorString() << "\n";
+        return 1;
+    }
+    return a.exec();
+}
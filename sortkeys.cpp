@@ -0,0 +1,126 @@
+/**
+ * @file sortkeys.cpp
+ * @brief Typed, parallel sorting of table rows by one column.
+ */
+#include "sortkeys.hpp"
+#include <QDate>
+#include <QTime>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+static const int PARALLEL_ROWS = 50000; ///< Smaller tables are sorted on the calling thread.
+
+namespace
+{
+    template <typename T>
+    struct Keyed
+    {
+        T value;
+        int row;
+        bool present;
+    };
+
+    /**
+     * @brief Runs @p work(begin, end) over [0, count) in chunks, in parallel if large.
+     * @return The chunk boundaries.
+     */
+    template <typename Work>
+    QVector<int> forChunks(int count, Work work)
+    {
+        int chunks = count < PARALLEL_ROWS ? 1 : std::max(1, QThread::idealThreadCount());
+        QVector<int> bounds;
+        for (int i = 0; i <= chunks; ++i)
+            bounds.append(static_cast<int>(qint64(count) * i / chunks));
+        if (chunks == 1)
+        {
+            work(0, count);
+            return bounds;
+        }
+        QVector<int> parts(chunks);
+        std::iota(parts.begin(), parts.end(), 0);
+        QtConcurrent::blockingMap(parts, [&](int part)
+                                  { work(bounds[part], bounds[part + 1]); });
+        return bounds;
+    }
+
+    template <typename T, typename Parse>
+    QVector<int> sortBy(const CsvTable &rows, int column, int &present, Parse parse)
+    {
+        int count = rows.size();
+        QVector<Keyed<T>> keys(count);
+        Keyed<T> *data = keys.data(); // Detached once; chunks write disjoint ranges
+
+        forChunks(count, [&](int begin, int end)
+                  {
+            for (int r = begin; r < end; ++r)
+            {
+                bool ok = false;
+                data[r].value = parse(rows[r].value(column).trimmed(), ok);
+                data[r].row = r;
+                data[r].present = ok;
+            } });
+
+        // Blank and unparsable cells go last in table order
+        Keyed<T> *split = std::stable_partition(data, data + count, [](const Keyed<T> &k)
+                                                { return k.present; });
+        present = static_cast<int>(split - data);
+
+        // Row index breaks ties, so the unstable sort gives a stable result
+        auto less = [](const Keyed<T> &a, const Keyed<T> &b)
+        { return a.value < b.value || (!(b.value < a.value) && a.row < b.row); };
+        QVector<int> bounds = forChunks(present, [&](int begin, int end)
+                                        { std::sort(data + begin, data + end, less); });
+        int chunks = bounds.size() - 1;
+        for (int width = 1; width < chunks; width *= 2)
+        {
+            QVector<int> merges;
+            for (int i = 0; i + width < chunks; i += 2 * width)
+                merges.append(i);
+            QtConcurrent::blockingMap(merges, [&](int i)
+                                      { std::inplace_merge(data + bounds[i], data + bounds[i + width],
+                                                           data + bounds[std::min(i + 2 * width, chunks)], less); });
+        }
+
+        QVector<int> order(count);
+        for (int i = 0; i < count; ++i)
+            order[i] = data[i].row;
+        return order;
+    }
+}
+
+QVector<int> SortKeys::sort(const CsvTable &rows, int column, ColumnType type, int &present)
+{
+    switch (type)
+    {
+    case ColumnType::Integer:
+    case ColumnType::Real:
+        // Doubles hold every integer an ID or count can reach exactly; "nan"
+        // and "inf" parse but would break the ordering, so they count as unparsable
+        return sortBy<double>(rows, column, present, [](const QString &field, bool &ok)
+                              {
+            double value = field.toDouble(&ok);
+            ok = ok && std::isfinite(value);
+            return value; });
+    case ColumnType::Date:
+        return sortBy<qint64>(rows, column, present, [](const QString &field, bool &ok)
+                              {
+            QDate date = QDate::fromString(field, Qt::ISODate);
+            ok = date.isValid();
+            return date.toJulianDay(); });
+    case ColumnType::Time:
+        return sortBy<int>(rows, column, present, [](const QString &field, bool &ok)
+                           {
+            QTime time = QTime::fromString(field, Qt::ISODate);
+            ok = time.isValid();
+            return time.msecsSinceStartOfDay() / 60000; });
+    case ColumnType::Text:
+        break;
+    }
+    return sortBy<QString>(rows, column, present, [](const QString &field, bool &ok)
+                           {
+        ok = !field.isEmpty();
+        return field.toCaseFolded(); });
+}
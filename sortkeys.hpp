@@ -0,0 +1,34 @@
+#ifndef SORTKEYS_HPP
+#define SORTKEYS_HPP
+
+#include <QString>
+#include <QVector>
+#include "tablechange.hpp"
+#include "tableregistry.hpp"
+
+/**
+ * @brief Orders the rows of a table by one column.
+ *
+ * Every cell of the column is converted once into a typed key (a number
+ * for numeric, date and time columns, case-folded text otherwise), so the
+ * comparisons themselves never touch a QString conversion. Large tables
+ * are converted and sorted in chunks on the global thread pool and the
+ * chunks merged.
+ */
+class SortKeys
+{
+public:
+    /**
+     * @brief Sorts the rows in ascending order of one column.
+     *
+     * Ties keep their table order. Rows whose cell is empty or does not
+     * parse as @p type come last, in table order.
+     * @param present Set to the number of rows with a value, i.e. the
+     * length of the sorted prefix; reversing just that prefix gives the
+     * descending order with blank cells still last.
+     * @return Row indices in sorted order.
+     */
+    static QVector<int> sort(const CsvTable &rows, int column, ColumnType type, int &present);
+};
+
+#endif // SORTKEYS_HPP
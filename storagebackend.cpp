@@ -0,0 +1,302 @@
+/**
+ * @file storagebackend.cpp
+ * @brief CSV file implementation of the DataStore's storage backend.
+ */
+#include "storagebackend.hpp"
+#include "academicmanager.hpp"
+#include "profiler.hpp"
+#include "tablefile.hpp"
+#include "tracer.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+static const qint64 EDGE_BLOCK = 64 * 1024; ///< Bytes hashed at each end of a parsed prefix.
+
+/**
+ * @brief Hashes the first and the last block of the first @p length bytes of
+ * @p file: enough to notice a rewrite without reading the whole prefix.
+ * @return Empty if the file ended early.
+ */
+static QByteArray edgeHash(QFile &file, qint64 length)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    qint64 head = std::min(length, EDGE_BLOCK);
+    qint64 tail = std::min(length - head, EDGE_BLOCK);
+    if (!file.seek(0))
+        return QByteArray();
+    QByteArray block = file.read(head);
+    if (block.size() != head || !file.seek(length - tail))
+        return QByteArray();
+    hash.addData(block);
+    block = file.read(tail);
+    if (block.size() != tail)
+        return QByteArray();
+    hash.addData(block);
+    ACADENCE_PROFILE_READ(head + tail, 0);
+    return hash.result();
+}
+
+/**
+ * @brief Parses complete CSV lines, skipping blank ones like readCsv does.
+ */
+static void appendLines(CsvTable &rows, const QByteArray &bytes)
+{
+    [[maybe_unused]] qsizetype before = rows.size();
+    const QStringList lines = QString::fromUtf8(bytes).split('\n');
+    for (QString line : lines)
+    {
+        if (line.endsWith('\r'))
+            line.chop(1);
+        if (!line.trimmed().isEmpty())
+            rows.append(AcadenceManager::parseCsvLine(line));
+    }
+    ACADENCE_PROFILE_READ(bytes.size(), rows.size() - before);
+}
+
+QByteArray StorageBackend::query(Protocol::Op op, const QByteArray &)
+{
+    throw Acadence::FileException("Query " + QString::number(op) + " needs acadence-server");
+}
+
+CsvTable FileBackend::readTable(const QString &name, const TableSnapshotPtr &base, quint64 sequence)
+{
+    ACADENCE_PROFILE("FileBackend::readTable");
+    ACADENCE_TRACE_DETAIL("io", "read", name);
+    QFile file(name);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        throw Acadence::FileException("Failed to open file for reading: " + name);
+    }
+
+    // Only the ends of the old prefix are checked; only new lines are parsed
+    Tail tail;
+    {
+        QMutexLocker locker(&tailMutex);
+        tail = tails.value(name);
+    }
+    QDateTime birthTime = QFileInfo(file).birthTime();
+    bool grewOnly = base && tail.offset > 0 && tail.sequence == base->getSequence() &&
+                    base->getRows().size() >= tail.rowCount && birthTime == tail.birthTime &&
+                    file.size() >= tail.offset && edgeHash(file, tail.offset) == tail.edgeHash;
+
+    CsvTable rows;
+    if (grewOnly)
+    {
+        rows = base->getRows();
+        rows.resize(tail.rowCount); // Drops a partial last line parsed the previous time
+    }
+    else
+    {
+        tail = Tail();
+    }
+    if (!file.seek(tail.offset))
+        throw Acadence::FileException("Failed to read file: " + name);
+
+    QByteArray fresh = file.readAll();
+    qsizetype complete = fresh.lastIndexOf('\n') + 1;
+    appendLines(rows, fresh.left(complete));
+    tail.offset += complete;
+    tail.rowCount = rows.size();
+    tail.sequence = sequence;
+    tail.birthTime = birthTime;
+    tail.edgeHash = edgeHash(file, tail.offset);
+    {
+        QMutexLocker locker(&tailMutex);
+        tails.insert(name, tail);
+    }
+
+    // A last line without a newline is returned but parsed again next time
+    if (complete < fresh.size())
+        appendLines(rows, fresh.mid(complete));
+    return rows;
+}
+
+CsvTable FileBackend::readCurrent(const TableFile &file, const QString &name, const TableSnapshotPtr &base, quint64 sequence)
+{
+    quint64 fileSequence = file.readFileSequence(sequence);
+    if (fileSequence == sequence)
+        return readTable(name, base, sequence);
+
+    CsvTable rows = readTable(name, nullptr, fileSequence);
+    {
+        QMutexLocker locker(&tailMutex);
+        tails.remove(name); // The logged edits change rows of the parsed prefix
+    }
+    bool complete = false;
+    QVector<TableChange> changes = file.readChangesSince(fileSequence, complete);
+    if (!complete || !TableChange::apply(rows, changes, TableFile::keyColumns(name)))
+    {
+        throw Acadence::FileException("The change log of " + name + " no longer covers commit " +
+                                      QString::number(fileSequence + 1));
+    }
+    return rows;
+}
+
+void FileBackend::advanceTail(const QString &name, quint64 from, quint64 to, const QVector<TableChange> &changes)
+{
+    QMutexLocker locker(&tailMutex);
+    auto it = tails.find(name);
+    if (it == tails.end() || it->sequence != from)
+        return;
+    for (const auto &change : changes)
+    {
+        if (change.getType() != TableChange::Append && change.getType() != TableChange::None)
+        {
+            tails.erase(it);
+            return;
+        }
+    }
+    it->sequence = to;
+}
+
+QVector<TableSnapshotPtr> FileBackend::load(const QStringList &names, quint64 version)
+{
+    QVector<TableSnapshotPtr> tables;
+    for (const QString &name : names)
+    {
+        // Hold the table lock so the rows and the sequence number belong together
+        TableFile file(name);
+        file.lock();
+        quint64 seq = file.readSequence();
+        tables.append(std::make_shared<const TableSnapshot>(name, readCurrent(file, name, nullptr, seq), version, seq));
+    }
+    return tables;
+}
+
+TableSnapshotPtr FileBackend::refresh(const TableSnapshotPtr &old, const QString &name, quint64 version)
+{
+    TableFile file(name);
+    // The sequence is written last, so an unchanged one means there is nothing to read
+    if (old && file.readSequence() == old->getSequence())
+        return old;
+    file.lock();
+    quint64 diskSeq = file.readSequence();
+
+    CsvTable rows;
+    bool complete = false;
+    if (old)
+    {
+        // Re-read only the rows other instances changed since our copy
+        QVector<TableChange> changes = file.readChangesSince(old->getSequence(), complete);
+        rows = old->getRows();
+        complete = complete && TableChange::apply(rows, changes, TableFile::keyColumns(name));
+        if (complete)
+            advanceTail(name, old->getSequence(), diskSeq, changes);
+    }
+    if (!complete)
+        rows = readCurrent(file, name, old, diskSeq);
+
+    return std::make_shared<const TableSnapshot>(name, rows, version, diskSeq);
+}
+
+QStringList FileBackend::write(QVector<TableWrite> &writes)
+{
+    ACADENCE_PROFILE("FileBackend::write");
+    // Lock in name order so two instances can never wait on each other
+    std::map<QString, std::unique_ptr<TableFile>> locks;
+    for (const auto &w : writes)
+    {
+        auto &file = locks[w.name];
+        if (!file)
+            file.reset(new TableFile(w.name));
+    }
+    for (auto &entry : locks)
+        entry.second->lock();
+
+    // Compare: has anyone committed to these tables since we read them?
+    QStringList stale;
+    for (const auto &w : writes)
+        if (locks[w.name]->readSequence() != w.baseSequence)
+            stale.append(w.name);
+    if (!stale.isEmpty())
+        return stale;
+
+    // Keyed edits only go to the change log (below) while the file lags
+    // less than MAX_FILE_LAG commits behind; a file that lags at all is
+    // rewritten rather than appended to, as the log would append again
+    QVector<quint64> fileSequences(writes.size());
+    QVector<bool> logOnly(writes.size(), false);
+    for (int i = 0; i < writes.size(); ++i)
+    {
+        const TableWrite &w = writes[i];
+        fileSequences[i] = locks[w.name]->readFileSequence(w.baseSequence);
+        bool behind = fileSequences[i] != w.baseSequence;
+        logOnly[i] = w.changesKnown && (w.rewritten || behind) &&
+                     w.baseSequence + 1 - fileSequences[i] < TableFile::MAX_FILE_LAG;
+    }
+
+    // Swap, stage one: new contents go to temporary files and appends are
+    // written, so a failure here can still be undone completely
+    std::vector<std::unique_ptr<QSaveFile>> staged(writes.size());
+    QVector<qint64> appendedFrom(writes.size(), -1);
+    try
+    {
+        for (int i = 0; i < writes.size(); ++i)
+        {
+            const TableWrite &w = writes[i];
+            if (logOnly[i])
+                continue;
+            if (w.rewritten || fileSequences[i] != w.baseSequence)
+            {
+                ACADENCE_TRACE_DETAIL("io", "write", w.name);
+                staged[i].reset(new QSaveFile(w.name));
+                if (!staged[i]->open(QIODevice::WriteOnly | QIODevice::Text))
+                    throw Acadence::FileException("Failed to open file for writing: " + w.name);
+                AcadenceManager::writeCsv(*staged[i], w.rows);
+            }
+            else
+            {
+                appendedFrom[i] = QFileInfo(w.name).size();
+                AcadenceManager::appendCsv(w.name, w.appended);
+            }
+        }
+
+        // Stage two: each rename is atomic; only a failed rename after an
+        // earlier one succeeded can leave part of the commit on disk
+        for (auto &file : staged)
+            if (file && !file->commit())
+                throw Acadence::FileException("Failed to replace " + file->fileName() + ": " + file->errorString());
+    }
+    catch (...)
+    {
+        // Unrenamed temporary files are discarded by QSaveFile
+        for (int i = 0; i < writes.size(); ++i)
+            if (appendedFrom[i] >= 0)
+                QFile::resize(writes[i].name, appendedFrom[i]);
+        throw;
+    }
+
+    // Publish: the new sequences are written only once every table is on disk
+    for (int i = 0; i < writes.size(); ++i)
+    {
+        TableWrite &w = writes[i];
+        TableFile &file = *locks[w.name];
+        w.newSequence = w.baseSequence + 1;
+        if (logOnly[i] || staged[i])
+        {
+            QMutexLocker locker(&tailMutex);
+            tails.remove(w.name); // Would no longer match
+        }
+        else
+            advanceTail(w.name, w.baseSequence, w.newSequence, {});
+
+        if (logOnly[i] && fileSequences[i] == w.baseSequence)
+            file.writeFileSequence(w.baseSequence);
+        else if (staged[i] && fileSequences[i] != w.baseSequence)
+            file.clearFileSequence(); // Compacted
+
+        if (!w.changesKnown)
+            w.changes = w.rewritten ? TableChange::diff(w.baseRows, w.rows, TableFile::keyColumns(w.name))
+                                    : TableChange::diff({}, w.appended, {});
+        file.appendChanges(w.newSequence, w.changes);
+        file.writeSequence(w.newSequence);
+    }
+    return stale;
+}
@@ -0,0 +1,145 @@
+#ifndef STORAGEBACKEND_HPP
+#define STORAGEBACKEND_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QDateTime>
+#include <QMutex>
+#include "datastore.hpp"
+#include "protocol.hpp"
+#include "tablefile.hpp"
+
+/**
+ * @brief One table written by a commit, as handed to a StorageBackend.
+ */
+struct TableWrite
+{
+    QString name;
+    quint64 baseSequence; ///< Sequence the batch read; the write only succeeds if it still matches.
+    CsvTable baseRows;    ///< Rows the batch started from.
+    CsvTable rows;        ///< Full new contents.
+    CsvTable appended;    ///< Appended rows, when the table was not otherwise modified.
+    bool rewritten;       ///< False if the table only received appends.
+    quint64 newSequence;  ///< Set by the backend on success.
+    QVector<TableChange> changes; ///< Row changes from baseRows to rows.
+    bool changesKnown;            ///< True if the batch supplied changes; otherwise the backend diffs.
+};
+
+/**
+ * @brief Where the DataStore loads tables from and commits them to.
+ *
+ * The default FileBackend works on the CSV files in the working directory;
+ * RemoteBackend forwards everything to an acadence-server process.
+ */
+class StorageBackend
+{
+public:
+    virtual ~StorageBackend() = default;
+
+    /**
+     * @brief Loads several tables at once.
+     * @throws Acadence::FileException if a table cannot be read.
+     */
+    virtual QVector<TableSnapshotPtr> load(const QStringList &names, quint64 version) = 0;
+
+    /**
+     * @brief Brings a stale table up to date, fetching only changed rows when possible.
+     * @param old The outdated snapshot, or nullptr to load the table in full.
+     */
+    virtual TableSnapshotPtr refresh(const TableSnapshotPtr &old, const QString &name, quint64 version) = 0;
+
+    /**
+     * @brief Compare-and-swap write of every table in a commit.
+     *
+     * Either all tables are written (and their newSequence is set) or none is.
+     * @return The tables whose sequence no longer matched; empty on success.
+     */
+    virtual QStringList write(QVector<TableWrite> &writes) = 0;
+
+    /**
+     * @brief True if the tables live in another process, which answers
+     * read-only queries (query()) so their rows need not be held here.
+     */
+    virtual bool isRemote() const { return false; }
+
+    /**
+     * @brief Sends a read-only Protocol request to the process holding the tables.
+     * @return The reply body.
+     * @throws Acadence::FileException if the backend is not remote or the
+     * server goes away, Acadence::Exception if the server reports an error.
+     */
+    virtual QByteArray query(Protocol::Op op, const QByteArray &request);
+};
+
+/**
+ * @brief Stores tables as CSV files, coordinated through TableFile.
+ *
+ * Remembers how far each file was parsed into which snapshot; when a table
+ * is refreshed from the file and the file only grew, just the new lines are
+ * parsed and added to that snapshot's rows.
+ *
+ * A commit writes rewritten tables to temporary files (QSaveFile) and only
+ * renames them into place, and bumps any sequence, once every table of the
+ * commit has been written; appends are cut back off if a later table fails.
+ *
+ * Keyed edits (TableChange::Upsert/Delete) are not written to the CSV file
+ * at all: they go to the table's change log only, so a save costs the rows
+ * it changed. The file is compacted (rewritten with the current rows) once
+ * it lags TableFile::MAX_FILE_LAG commits behind; until then readers replay
+ * the log over it.
+ */
+class FileBackend : public StorageBackend
+{
+public:
+    QVector<TableSnapshotPtr> load(const QStringList &names, quint64 version) override;
+    TableSnapshotPtr refresh(const TableSnapshotPtr &old, const QString &name, quint64 version) override;
+    QStringList write(QVector<TableWrite> &writes) override;
+
+private:
+    /**
+     * @brief The part of a table file that has already been parsed.
+     *
+     * Only enough to recognise the prefix again is kept, never its rows:
+     * the rows are the first rowCount of the snapshot at sequence.
+     */
+    struct Tail
+    {
+        qint64 offset = 0;    ///< Length of the parsed prefix; always ends a line.
+        int rowCount = 0;     ///< Rows parsed from the prefix.
+        quint64 sequence = 0; ///< Storage sequence of the snapshot those rows are in.
+        QDateTime birthTime;  ///< Identity of the file; a replaced file has a new one.
+        QByteArray edgeHash;  ///< Hash of the prefix's first and last blocks, to detect rewrites.
+    };
+
+    /**
+     * @brief Reads a table. If @p base is the snapshot the last read produced
+     * (or one that only gained appended rows since) and the file kept its
+     * identity and parsed prefix, only bytes appended after it are parsed.
+     * @param sequence Storage sequence the returned rows will be published at.
+     * @throws Acadence::FileException if the file cannot be read.
+     */
+    CsvTable readTable(const QString &name, const TableSnapshotPtr &base, quint64 sequence);
+
+    /**
+     * @brief Reads a table at sequence @p sequence: the CSV file, plus the
+     * logged commits it does not hold yet.
+     * @throws Acadence::FileException if the file cannot be read or the log
+     * no longer covers those commits.
+     */
+    CsvTable readCurrent(const TableFile &file, const QString &name, const TableSnapshotPtr &base, quint64 sequence);
+
+    /**
+     * @brief Moves a table's tail from snapshot sequence @p from to @p to
+     * if @p changes only appended rows (which keeps the parsed rows first);
+     * forgets it otherwise.
+     */
+    void advanceTail(const QString &name, quint64 from, quint64 to, const QVector<TableChange> &changes);
+
+    QHash<QString, Tail> tails; ///< Guarded by tailMutex: tables are loaded outside the DataStore writer lock.
+    QMutex tailMutex;
+};
+
+#endif // STORAGEBACKEND_HPP
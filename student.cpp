@@ -1,4 +1,5 @@
 #include "student.hpp"
+#include "gpaengine.hpp"
 #include <cmath> // For rounding if needed
 
 Student::Student(int id, QString name, QString email, QString dept, QString batch, int sem)
@@ -9,5 +10,7 @@ Student::Student(int id, QString name, QString email, QString dept, QString batc
 
 double Student::calculateGPA() const
 {
-    return m_gpa;
+    // The stored CGPA stands in until a course of this student has been graded
+    GpaRecord record = GpaEngine::instance().forStudent(getId());
+    return record.credits > 0 ? record.cgpa : m_gpa;
 }
\ No newline at end of file
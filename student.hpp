@@ -44,6 +44,9 @@ public:
     void setGpa(double gpa) { m_gpa = gpa; }
     void setDateAdmission(const QDate &date) { dateAdmission = date; }
 
+    /**
+     * @brief CGPA over the graded courses (see GpaEngine), or the stored one if none is graded.
+     */
     double calculateGPA() const;
 };
 
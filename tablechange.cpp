@@ -0,0 +1,140 @@
+/**
+ * @file tablechange.cpp
+ * @brief Row-level diffing and patching of CSV tables.
+ */
+#include "tablechange.hpp"
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+
+QString TableChange::rowKey(const QStringList &row, const QVector<int> &keyColumns)
+{
+    QStringList parts;
+    for (int c : keyColumns)
+        parts << row.value(c).trimmed();
+    return parts.join(QChar(0x1F)); // Unit separator never appears in CSV fields
+}
+
+QVector<TableChange> TableChange::diff(const CsvTable &before, const CsvTable &after, const QVector<int> &keyColumns)
+{
+    QVector<TableChange> changes;
+
+    // Without a key only pure appends can be described row by row
+    if (keyColumns.isEmpty())
+    {
+        if (after.size() >= before.size() && std::equal(before.begin(), before.end(), after.begin()))
+        {
+            for (int i = before.size(); i < after.size(); ++i)
+                changes.append(TableChange(Append, after[i]));
+        }
+        else
+        {
+            changes.append(TableChange(Rewrite));
+        }
+        return changes;
+    }
+
+    QHash<QString, int> beforeIndex;
+    beforeIndex.reserve(before.size());
+    for (int i = 0; i < before.size(); ++i)
+        beforeIndex.insert(rowKey(before[i], keyColumns), i);
+
+    QSet<QString> seen;
+    seen.reserve(after.size());
+    for (const auto &row : after)
+    {
+        QString key = rowKey(row, keyColumns);
+        seen.insert(key);
+        auto it = beforeIndex.constFind(key);
+        if (it == beforeIndex.constEnd() || before[it.value()] != row)
+            changes.append(TableChange(Upsert, row));
+    }
+
+    for (const auto &row : before)
+    {
+        if (!seen.contains(rowKey(row, keyColumns)))
+        {
+            QStringList keyValues;
+            for (int c : keyColumns)
+                keyValues << row.value(c).trimmed();
+            changes.append(TableChange(Delete, keyValues));
+        }
+    }
+    return changes;
+}
+
+bool TableChange::apply(CsvTable &rows, const QVector<TableChange> &changes, const QVector<int> &keyColumns,
+                        KeyIndex *index)
+{
+    for (const auto &change : changes)
+        if (change.type == Rewrite)
+            return false;
+
+    KeyIndex local;
+    bool indexed = index != nullptr;
+    bool kept = indexed; // The caller's index must still match the rows afterwards
+    if (!index)
+        index = &local;
+    QVector<bool> removed;
+
+    for (const auto &change : changes)
+    {
+        if (change.type == None)
+            continue;
+        if (change.type == Append)
+        {
+            if (indexed && !keyColumns.isEmpty())
+                index->insert(rowKey(change.row, keyColumns), rows.size());
+            rows.append(change.row);
+            continue;
+        }
+
+        if (!indexed)
+        {
+            index->reserve(rows.size());
+            for (int i = 0; i < rows.size(); ++i)
+                index->insert(rowKey(rows[i], keyColumns), i);
+            indexed = true;
+        }
+
+        QString key = (change.type == Delete) ? change.row.join(QChar(0x1F)) : rowKey(change.row, keyColumns);
+        auto it = index->find(key);
+        if (change.type == Delete)
+        {
+            if (it != index->end())
+            {
+                removed.resize(rows.size());
+                removed[it.value()] = true;
+                index->erase(it);
+            }
+        }
+        else if (it != index->end())
+        {
+            rows[it.value()] = change.row;
+        }
+        else
+        {
+            index->insert(key, rows.size());
+            rows.append(change.row);
+        }
+    }
+
+    if (removed.contains(true))
+    {
+        CsvTable remaining;
+        remaining.reserve(rows.size());
+        for (int i = 0; i < rows.size(); ++i)
+            if (i >= removed.size() || !removed[i])
+                remaining.append(rows[i]);
+        rows = remaining;
+
+        // Later rows moved up
+        if (kept)
+        {
+            index->clear();
+            for (int i = 0; i < rows.size(); ++i)
+                index->insert(rowKey(rows[i], keyColumns), i);
+        }
+    }
+    return true;
+}
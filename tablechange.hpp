@@ -0,0 +1,66 @@
+#ifndef TABLECHANGE_HPP
+#define TABLECHANGE_HPP
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Rows of a CSV table, one QStringList per line.
+ */
+using CsvTable = QVector<QStringList>;
+
+/**
+ * @brief Row position of each key of a table (see TableChange::rowKey()).
+ */
+using KeyIndex = QHash<QString, int>;
+
+/**
+ * @brief One row-level change recorded in a table's change log.
+ */
+class TableChange
+{
+public:
+    enum Type
+    {
+        Upsert,  ///< Row inserted or replaced (matched by key columns).
+        Delete,  ///< Row removed; payload holds the key values only.
+        Append,  ///< Row appended to a table without key columns.
+        Rewrite, ///< Table rewritten in a way rows cannot describe.
+        None     ///< Commit that changed nothing (keeps the log contiguous).
+    };
+
+private:
+    Type type;
+    QStringList row;
+
+public:
+    TableChange(Type t = None, QStringList r = {}) : type(t), row(r) {}
+
+    Type getType() const { return type; }
+    const QStringList &getRow() const { return row; }
+
+    /**
+     * @brief Computes the changes that turn @p before into @p after.
+     */
+    static QVector<TableChange> diff(const CsvTable &before, const CsvTable &after, const QVector<int> &keyColumns);
+
+    /**
+     * @brief Applies changes to rows in place.
+     * @param index Index of @p rows that is used and kept up to date, for
+     * callers applying changes to the same table again and again; if
+     * nullptr, one is built for the call when a keyed change needs it.
+     * @return False if a change cannot be applied row by row (caller must
+     * reload); nothing is changed then.
+     */
+    static bool apply(CsvTable &rows, const QVector<TableChange> &changes, const QVector<int> &keyColumns,
+                      KeyIndex *index = nullptr);
+
+    /**
+     * @brief Builds the lookup key of a row from its key columns.
+     */
+    static QString rowKey(const QStringList &row, const QVector<int> &keyColumns);
+};
+
+#endif // TABLECHANGE_HPP
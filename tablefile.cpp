@@ -0,0 +1,136 @@
+/**
+ * @file tablefile.cpp
+ * @brief Lock, sequence and change-log files used to share tables between instances.
+ */
+#include "tablefile.hpp"
+#include "academicmanager.hpp"
+#include "tableregistry.hpp"
+#include <QFile>
+#include <QTextStream>
+
+static const int LOCK_TIMEOUT_MS = 5000;
+static const quint64 LOG_WINDOW = 256; ///< Commits kept in the change log.
+static_assert(TableFile::MAX_FILE_LAG < LOG_WINDOW, "the log must cover what the CSV file lacks");
+
+TableFile::TableFile(const QString &name) : name(name), lockFile(name + ".lock") {}
+
+void TableFile::lock()
+{
+    if (!lockFile.tryLock(LOCK_TIMEOUT_MS))
+    {
+        throw Acadence::FileException("Timed out waiting for another instance to release " + name);
+    }
+}
+
+quint64 TableFile::readSequence() const
+{
+    QFile file(name + ".seq");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return 0; // Never committed through a sequence-aware instance
+    return file.readAll().trimmed().toULongLong();
+}
+
+void TableFile::writeSequence(quint64 seq) const
+{
+    QFile file(name + ".seq");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+    {
+        throw Acadence::FileException("Failed to open file for writing: " + file.fileName());
+    }
+    file.write(QByteArray::number(seq));
+}
+
+quint64 TableFile::readFileSequence(quint64 seq) const
+{
+    QFile file(name + ".base");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return seq;
+    return file.readAll().trimmed().toULongLong();
+}
+
+void TableFile::writeFileSequence(quint64 seq) const
+{
+    QFile file(name + ".base");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+    {
+        throw Acadence::FileException("Failed to open file for writing: " + file.fileName());
+    }
+    file.write(QByteArray::number(seq));
+}
+
+void TableFile::clearFileSequence() const
+{
+    if (QFile::exists(name + ".base") && !QFile::remove(name + ".base"))
+    {
+        throw Acadence::FileException("Failed to remove " + name + ".base");
+    }
+}
+
+QVector<TableChange> TableFile::readChangesSince(quint64 seq, bool &complete) const
+{
+    QVector<TableChange> changes;
+    complete = false;
+    if (!QFile::exists(name + ".log"))
+        return changes;
+
+    CsvTable log = AcadenceManager::readCsv(name + ".log");
+    // Format: Seq,Type,Fields...
+    if (log.isEmpty() || log.first().value(0).toULongLong() > seq + 1)
+        return changes; // Compacted past our position
+
+    for (const auto &entry : log)
+    {
+        if (entry.size() < 2 || entry[0].toULongLong() <= seq)
+            continue;
+        QStringList row = entry.mid(2);
+        QChar t = entry[1].isEmpty() ? QChar('R') : entry[1][0];
+        if (t == 'U')
+            changes.append(TableChange(TableChange::Upsert, row));
+        else if (t == 'D')
+            changes.append(TableChange(TableChange::Delete, row));
+        else if (t == 'A')
+            changes.append(TableChange(TableChange::Append, row));
+        else if (t == 'N')
+            changes.append(TableChange(TableChange::None));
+        else
+            changes.append(TableChange(TableChange::Rewrite));
+    }
+    complete = true;
+    return changes;
+}
+
+void TableFile::appendChanges(quint64 seq, const QVector<TableChange> &changes) const
+{
+    static const char TYPE_CODES[] = {'U', 'D', 'A', 'R', 'N'};
+    QString logName = name + ".log";
+
+    if (seq % LOG_WINDOW == 0 && QFile::exists(logName))
+    {
+        // Drop entries older than the window; instances further behind reload the table
+        CsvTable kept;
+        for (const auto &entry : AcadenceManager::readCsv(logName))
+            if (entry.value(0).toULongLong() + LOG_WINDOW > seq)
+                kept.append(entry);
+        AcadenceManager::writeCsv(logName, kept);
+    }
+
+    QVector<TableChange> entries = changes;
+    if (entries.isEmpty())
+        entries.append(TableChange(TableChange::None));
+
+    CsvTable lines;
+    lines.reserve(entries.size());
+    for (const auto &change : entries)
+    {
+        QStringList fields = {QString::number(seq), QString(QChar(TYPE_CODES[change.getType()]))};
+        fields << change.getRow();
+        lines.append(fields);
+    }
+    AcadenceManager::appendCsv(logName, lines);
+}
+
+QVector<int> TableFile::keyColumns(const QString &name)
+{
+    const TableDescriptor *table = TableRegistry::find(name);
+    return table ? table->getKeyColumns() : QVector<int>{0}; // Unknown tables: ID column
+}
@@ -0,0 +1,79 @@
+#ifndef TABLEFILE_HPP
+#define TABLEFILE_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QLockFile>
+#include "tablechange.hpp"
+
+/**
+ * @brief Cross-process coordination files for one CSV table.
+ *
+ * Next to "grades.csv" live:
+ *  - "grades.csv.lock": QLockFile held while a commit is written,
+ *  - "grades.csv.seq":  the table's commit sequence number,
+ *  - "grades.csv.log":  the rows changed by recent commits, so other
+ *                       instances can catch up without rereading the table,
+ *  - "grades.csv.base": the sequence the CSV file itself holds, while keyed
+ *                       edits after it are only in the log (see FileBackend).
+ */
+class TableFile
+{
+private:
+    QString name;
+    QLockFile lockFile;
+
+public:
+    /**
+     * @brief Commits the CSV file may lag behind the change log before it
+     * is compacted; well inside the commits the log keeps.
+     */
+    static const quint64 MAX_FILE_LAG = 64;
+
+    explicit TableFile(const QString &name);
+
+    /**
+     * @brief Acquires the table lock.
+     * @throws Acadence::FileException if another instance holds it too long.
+     */
+    void lock();
+
+    quint64 readSequence() const;
+    void writeSequence(quint64 seq) const;
+
+    /**
+     * @brief Sequence whose rows the CSV file holds; later commits are only
+     * in the change log until the file is compacted.
+     * @param seq The table's sequence, returned when the file holds every commit.
+     */
+    quint64 readFileSequence(quint64 seq) const;
+
+    /**
+     * @brief Records that commits after @p seq are only in the change log.
+     */
+    void writeFileSequence(quint64 seq) const;
+
+    /**
+     * @brief Records that the CSV file holds every commit again.
+     */
+    void clearFileSequence() const;
+
+    /**
+     * @brief Reads the changes committed after sequence @p seq.
+     * @param complete Set to false if the log no longer covers that range.
+     */
+    QVector<TableChange> readChangesSince(quint64 seq, bool &complete) const;
+
+    /**
+     * @brief Records the changes of commit @p seq, compacting the log periodically.
+     */
+    void appendChanges(quint64 seq, const QVector<TableChange> &changes) const;
+
+    /**
+     * @brief Key columns identifying a row; empty for tables without a key.
+     */
+    static QVector<int> keyColumns(const QString &name);
+};
+
+#endif // TABLEFILE_HPP
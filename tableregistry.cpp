@@ -0,0 +1,229 @@
+/**
+ * @file tableregistry.cpp
+ * @brief Compile-time descriptors of every CSV table.
+ */
+#include "tableregistry.hpp"
+#include "utils.hpp"
+#include <QDate>
+#include <QTime>
+
+namespace
+{
+    constexpr int MAX_ID = 999999;
+    constexpr const char *DEPARTMENTS[] = {"CSE", "EEE", "MCE", "CEE", "BTM", "TVE", "SWE"};
+
+    constexpr ColumnDescriptor text(const char *title, ColumnRole role = ColumnRole::None)
+    {
+        return {title, ColumnType::Text, role, 0, 0, 0, nullptr, 0};
+    }
+
+    template <std::size_t N>
+    constexpr ColumnDescriptor choice(const char *title, const char *const (&values)[N])
+    {
+        return {title, ColumnType::Text, ColumnRole::None, 0, 0, 0, values, static_cast<int>(N)};
+    }
+
+    constexpr ColumnDescriptor integer(const char *title, int min, int max, ColumnRole role = ColumnRole::None)
+    {
+        return {title, ColumnType::Integer, role, double(min), double(max), 0, nullptr, 0};
+    }
+
+    constexpr ColumnDescriptor real(const char *title, double min, double max, double step = 0)
+    {
+        return {title, ColumnType::Real, ColumnRole::None, min, max, step, nullptr, 0};
+    }
+
+    constexpr ColumnDescriptor date(const char *title)
+    {
+        return {title, ColumnType::Date, ColumnRole::None, 0, 0, 0, nullptr, 0};
+    }
+
+    constexpr ColumnDescriptor timeOfDay(const char *title)
+    {
+        return {title, ColumnType::Time, ColumnRole::None, 0, 0, 0, nullptr, 0};
+    }
+
+    constexpr ColumnDescriptor id() { return integer("ID", 1, MAX_ID, ColumnRole::Id); }
+    constexpr ColumnDescriptor reference(const char *title) { return integer(title, 1, MAX_ID); }
+    constexpr ColumnDescriptor flag(const char *title) { return integer(title, 0, 1); }
+
+    constexpr ColumnDescriptor ADMINS[] = {
+        id(), text("Username", ColumnRole::Username), text("Password", ColumnRole::Password), text("Name"), text("Email")};
+    constexpr ColumnDescriptor STUDENTS[] = {
+        id(), text("Name"), text("Email"), text("Username", ColumnRole::Username), text("Password", ColumnRole::Password),
+        choice("Dept", DEPARTMENTS), text("Batch"), integer("Sem", 1, 8), date("Admission Date"), real("CGPA", 0.0, 4.0, 0.01)};
+    constexpr ColumnDescriptor TEACHERS[] = {
+        id(), text("Name"), text("Email"), text("Username", ColumnRole::Username), text("Password", ColumnRole::Password),
+        choice("Dept", DEPARTMENTS), text("Designation"), real("Salary", 0.0, 1000000.0)};
+    constexpr ColumnDescriptor COURSES[] = {
+        id(), text("Code"), text("Name"), reference("Teacher ID"), integer("Semester", 1, 8), integer("Credits", 1, MAX_ID)};
+    constexpr ColumnDescriptor ROUTINE[] = {
+        text("Day"), timeOfDay("Start"), timeOfDay("End"), text("Code"), text("Name"), text("Room"), text("Instructor"),
+        integer("Semester", 1, 8)};
+    constexpr ColumnDescriptor ATTENDANCE[] = {
+        reference("Course ID"), reference("Student ID"), date("Date"), flag("Present")};
+    constexpr ColumnDescriptor GRADES[] = {
+        reference("Student ID"), reference("Assessment ID"), real("Marks", 0.0, 1000000.0)};
+    constexpr ColumnDescriptor NOTICES[] = {
+        date("Date"), text("Author"), text("Content")};
+    constexpr ColumnDescriptor TASKS[] = {
+        id(), reference("User ID"), text("Description"), flag("Completed")};
+    constexpr ColumnDescriptor HABITS[] = {
+        id(), reference("User ID"), text("Name"), text("Type"), text("Frequency"), integer("Target", 0, MAX_ID),
+        integer("Current", 0, MAX_ID), integer("Streak", 0, MAX_ID), date("Last Date"), flag("Completed"), text("Unit")};
+    constexpr ColumnDescriptor QUERIES[] = {
+        id(), reference("Student ID"), text("Question"), text("Answer")};
+    constexpr ColumnDescriptor ASSESSMENTS[] = {
+        id(), reference("Course ID"), text("Title"), text("Type"), date("Date"), integer("Max Marks", 1, MAX_ID)};
+    constexpr ColumnDescriptor PRAYERS[] = {
+        reference("User ID"), date("Date"), flag("Fajr"), flag("Dhuhr"), flag("Asr"), flag("Maghrib"), flag("Isha")};
+    constexpr ColumnDescriptor TIMERS[] = {
+        reference("User ID"), text("Name"), text("State"), text("Ends At"), real("Remaining Ms", 0.0, 1e12),
+        real("Total Ms", 0.0, 1e12), text("Tag")};
+    constexpr ColumnDescriptor GRADE_SCALE[] = {
+        real("Min Percent", 0.0, 100.0, 0.5), real("Points", 0.0, 10.0, 0.01), text("Letter")};
+
+    constexpr int ID_KEY[] = {0};
+    constexpr int PAIR_KEY[] = {0, 1};          // StudentID/UserID + AssessmentID/Date
+    constexpr int ATTENDANCE_KEY[] = {0, 1, 2}; // CourseID + StudentID + Date
+
+    template <std::size_t N, std::size_t K>
+    constexpr TableDescriptor table(const char *name, const ColumnDescriptor (&columns)[N], const int (&keys)[K], bool admin)
+    {
+        return {name, columns, static_cast<int>(N), keys, static_cast<int>(K), admin};
+    }
+
+    template <std::size_t N>
+    constexpr TableDescriptor keyless(const char *name, const ColumnDescriptor (&columns)[N], bool admin)
+    {
+        return {name, columns, static_cast<int>(N), nullptr, 0, admin};
+    }
+
+    // Same order as the files were always created in
+    constexpr TableDescriptor TABLES[] = {
+        table("admins", ADMINS, ID_KEY, true),
+        table("students", STUDENTS, ID_KEY, true),
+        table("teachers", TEACHERS, ID_KEY, true),
+        table("courses", COURSES, ID_KEY, true),
+        {"enrollments", nullptr, 0, nullptr, 0, false}, // Columns not defined yet
+        keyless("routine", ROUTINE, true),
+        table("attendance", ATTENDANCE, ATTENDANCE_KEY, false),
+        table("grades", GRADES, PAIR_KEY, true),
+        keyless("notices", NOTICES, true),
+        table("tasks", TASKS, ID_KEY, false),
+        table("habits", HABITS, ID_KEY, false),
+        table("queries", QUERIES, ID_KEY, false),
+        table("assessments", ASSESSMENTS, ID_KEY, false),
+        table("prayers", PRAYERS, PAIR_KEY, false),
+        table("gradescale", GRADE_SCALE, ID_KEY, true), // Key: Min Percent
+        table("timers", TIMERS, PAIR_KEY, false)};      // Key: UserID + Name
+
+    constexpr bool schemaValid()
+    {
+        for (const TableDescriptor &t : TABLES)
+        {
+            for (int k = 0; k < t.keyCount; ++k)
+                if (t.keys[k] < 0 || t.keys[k] >= t.columnCount)
+                    return false;
+            for (int c = 0; c < t.columnCount; ++c)
+                if ((t.columns[c].type == ColumnType::Integer || t.columns[c].type == ColumnType::Real) &&
+                    t.columns[c].min > t.columns[c].max)
+                    return false;
+        }
+        return true;
+    }
+    static_assert(schemaValid(), "Every key column must exist and every range must be ordered");
+}
+
+QStringList ColumnDescriptor::getChoices() const
+{
+    QStringList list;
+    for (int i = 0; i < choiceCount; ++i)
+        list << QString::fromLatin1(choices[i]);
+    return list;
+}
+
+QString ColumnDescriptor::validate(const QString &value) const
+{
+    if (role == ColumnRole::Username)
+        return Utils::validateUsername(value);
+    if (role == ColumnRole::Password)
+        return Utils::validatePassword(value);
+
+    bool ok = false;
+    switch (type)
+    {
+    case ColumnType::Integer:
+    case ColumnType::Real:
+    {
+        double n = type == ColumnType::Integer ? value.toInt(&ok) : value.toDouble(&ok);
+        if (!ok)
+            return "'" + value + (type == ColumnType::Integer ? "' is not a whole number." : "' is not a number.");
+        if (n < min || n > max)
+            return QString("%1 is outside %2-%3.").arg(value).arg(min, 0, 'g', 10).arg(max, 0, 'g', 10);
+        break;
+    }
+    case ColumnType::Date:
+        if (!QDate::fromString(value, "yyyy-MM-dd").isValid())
+            return "'" + value + "' is not a yyyy-MM-dd date.";
+        break;
+    case ColumnType::Time:
+        if (!QTime::fromString(value, "HH:mm").isValid())
+            return "'" + value + "' is not an HH:mm time.";
+        break;
+    case ColumnType::Text:
+        if (choiceCount > 0 && !getChoices().contains(value))
+            return "'" + value + "' is not one of " + getChoices().join(", ") + ".";
+        break;
+    }
+    return "";
+}
+
+int TableDescriptor::columnWithRole(ColumnRole role) const
+{
+    for (int c = 0; c < columnCount; ++c)
+        if (columns[c].role == role)
+            return c;
+    return -1;
+}
+
+QStringList TableDescriptor::getHeaders() const
+{
+    QStringList headers;
+    for (int c = 0; c < columnCount; ++c)
+        headers << QString::fromLatin1(columns[c].title);
+    return headers;
+}
+
+QVector<int> TableDescriptor::getKeyColumns() const
+{
+    return QVector<int>(keys, keys + keyCount);
+}
+
+const TableDescriptor *TableRegistry::find(const QString &name)
+{
+    QStringView base(name);
+    if (base.endsWith(QLatin1String(".csv")))
+        base.chop(4);
+    for (const TableDescriptor &t : TABLES)
+        if (base.compare(QLatin1String(t.name)) == 0)
+            return &t;
+    return nullptr;
+}
+
+QVector<const TableDescriptor *> TableRegistry::tables()
+{
+    QVector<const TableDescriptor *> list;
+    for (const TableDescriptor &t : TABLES)
+        list.append(&t);
+    return list;
+}
+
+QStringList TableRegistry::adminTableNames()
+{
+    QStringList names;
+    for (const TableDescriptor &t : TABLES)
+        if (t.adminEditable)
+            names << t.getName();
+    return names;
+}
@@ -0,0 +1,117 @@
+#ifndef TABLEREGISTRY_HPP
+#define TABLEREGISTRY_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief How a column's values are parsed, compared and edited.
+ */
+enum class ColumnType
+{
+    Text,    ///< Free text (or one of a fixed list of choices).
+    Integer, ///< IDs, semesters, credits.
+    Real,    ///< CGPA, salaries, marks.
+    Date,    ///< yyyy-MM-dd, compared as a Julian day.
+    Time     ///< HH:mm, compared as minutes since midnight.
+};
+
+/**
+ * @brief What a column means beyond its type.
+ */
+enum class ColumnRole
+{
+    None,
+    Id,       ///< Unique row ID; new rows get the next free one.
+    Username, ///< Login name, unique across every table that has one.
+    Password  ///< Login password.
+};
+
+/**
+ * @brief One column of a table: title, type, editor limits and role.
+ */
+struct ColumnDescriptor
+{
+    const char *title;
+    ColumnType type;
+    ColumnRole role;
+    double min;                 ///< Lowest value of an Integer/Real column.
+    double max;                 ///< Highest value of an Integer/Real column.
+    double step;                ///< Editor step of a Real column; 0 for the default.
+    const char *const *choices; ///< Allowed values of a Text column, or nullptr.
+    int choiceCount;
+
+    /**
+     * @brief The allowed values, empty if any text is allowed.
+     */
+    QStringList getChoices() const;
+
+    /**
+     * @brief Checks a value against the column's type, limits and role.
+     * @return An error message, or an empty string if the value is valid.
+     */
+    QString validate(const QString &value) const;
+};
+
+/**
+ * @brief One CSV table: its columns and the columns identifying a row.
+ */
+struct TableDescriptor
+{
+    const char *name; ///< Without extension (e.g. "students").
+    const ColumnDescriptor *columns;
+    int columnCount;
+    const int *keys; ///< Key columns, or nullptr for tables without a natural key.
+    int keyCount;
+    bool adminEditable; ///< Listed in the admin panel.
+
+    QString getName() const { return QString::fromLatin1(name); }
+    QString getFileName() const { return getName() + ".csv"; }
+
+    /**
+     * @brief The column's descriptor, or nullptr past the last column.
+     */
+    const ColumnDescriptor *column(int index) const
+    {
+        return index >= 0 && index < columnCount ? &columns[index] : nullptr;
+    }
+
+    /**
+     * @brief The first column with the given role, or -1.
+     */
+    int columnWithRole(ColumnRole role) const;
+
+    QStringList getHeaders() const;
+    QVector<int> getKeyColumns() const;
+};
+
+/**
+ * @brief The schema of every table, defined once at compile time.
+ *
+ * Admin panel headers and editors, import validation, typed sorting and
+ * row keys are all derived from these descriptors, so a column is
+ * described in exactly one place. Lookups by name happen once per table
+ * switch or commit; per-cell code indexes the descriptor's column array.
+ */
+class TableRegistry
+{
+public:
+    /**
+     * @brief Finds a table by name, with or without the ".csv" extension.
+     * @return The descriptor, or nullptr for an unknown table.
+     */
+    static const TableDescriptor *find(const QString &name);
+
+    /**
+     * @brief Every table, in dataFiles() order.
+     */
+    static QVector<const TableDescriptor *> tables();
+
+    /**
+     * @brief Names of the tables listed in the admin panel, in display order.
+     */
+    static QStringList adminTableNames();
+};
+
+#endif // TABLEREGISTRY_HPP
@@ -0,0 +1,481 @@
+/**
+ * @file themeengine.cpp
+ * @brief Precomputed themes applied through a proxy style and the application palette.
+ */
+#include "themeengine.hpp"
+#include <QAbstractSpinBox>
+#include <QApplication>
+#include <QFont>
+#include <QPainter>
+#include <QPushButton>
+#include <QScreen>
+#include <QStyleOption>
+#include <QTabBar>
+
+static const int INDICATOR_SIZE = 22; ///< Check box indicator, logical pixels.
+static const int CHECK_SIZE = 18;     ///< Check mark inside the indicator border.
+static const int ARROW_SIZE = 10;
+
+/**
+ * @brief Calculates a high-contrast text color (black or white) for a given background.
+ */
+static QColor getContrastColor(const QColor &color)
+{
+    // Calculate luminance to determine best text color (Black or White)
+    double luminance = 0.299 * color.redF() + 0.587 * color.greenF() + 0.114 * color.blueF();
+    return luminance > 0.5 ? Qt::black : Qt::white;
+}
+
+// ---------------------------------------------------------------------------
+// ThemeStyle
+// ---------------------------------------------------------------------------
+
+ThemeStyle::ThemeStyle() : QProxyStyle("Fusion") {}
+
+void ThemeStyle::prepareGlyphs(const ThemeColors &theme, qreal dpr) const
+{
+    glyph(CheckMark, theme.accentText, dpr);
+    glyph(ArrowUp, theme.text, dpr);
+    glyph(ArrowDown, theme.text, dpr);
+}
+
+QPixmap ThemeStyle::glyph(Glyph kind, const QColor &color, qreal dpr) const
+{
+    quint64 key = (quint64(kind) << 48) | (quint64(color.rgba()) << 16) | quint16(qRound(dpr * 100));
+    auto it = glyphs.constFind(key);
+    if (it != glyphs.constEnd())
+        return *it;
+
+    int size = kind == CheckMark ? CHECK_SIZE : ARROW_SIZE;
+    QPixmap pixmap(QSize(size, size) * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter p(&pixmap);
+    p.setRenderHint(QPainter::Antialiasing);
+    if (kind == CheckMark)
+    {
+        // The stroke of the former 24x24 SVG check mark, scaled to the indicator
+        p.scale(size / 24.0, size / 24.0);
+        p.setPen(QPen(color, 3, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+        p.drawPolyline(QPolygonF({QPointF(20, 6), QPointF(9, 17), QPointF(4, 12)}));
+    }
+    else
+    {
+        p.setPen(Qt::NoPen);
+        p.setBrush(color);
+        if (kind == ArrowUp)
+            p.drawPolygon(QPolygonF({QPointF(0, size), QPointF(size / 2.0, 0), QPointF(size, size)}));
+        else
+            p.drawPolygon(QPolygonF({QPointF(0, 0), QPointF(size / 2.0, size), QPointF(size, 0)}));
+    }
+    p.end();
+
+    glyphs.insert(key, pixmap);
+    return pixmap;
+}
+
+void ThemeStyle::drawGlyph(QPainter *painter, const QRect &rect, Glyph kind, const QColor &color) const
+{
+    QPixmap pixmap = glyph(kind, color, painter->device()->devicePixelRatioF());
+    QRect target(QPoint(), pixmap.deviceIndependentSize().toSize());
+    target.moveCenter(rect.center());
+    painter->drawPixmap(target.topLeft(), pixmap);
+}
+
+void ThemeStyle::drawField(QPainter *painter, const QRect &rect, const QPalette &palette, bool focused) const
+{
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(QPen(focused ? colors->accent : colors->border, 2));
+    painter->setBrush(palette.base());
+    painter->drawRoundedRect(QRectF(rect).adjusted(1, 1, -1, -1), 8, 8);
+    painter->restore();
+}
+
+void ThemeStyle::polish(QWidget *widget)
+{
+    QProxyStyle::polish(widget);
+    if (qobject_cast<QTabBar *>(widget))
+        widget->setAttribute(Qt::WA_Hover, true);
+}
+
+void ThemeStyle::drawPrimitive(PrimitiveElement element, const QStyleOption *option, QPainter *painter, const QWidget *widget) const
+{
+    if (!colors)
+    {
+        QProxyStyle::drawPrimitive(element, option, painter, widget);
+        return;
+    }
+
+    switch (element)
+    {
+    case PE_PanelButtonCommand:
+        if (widget && widget->property("themeSwatch").toBool())
+        {
+            painter->save();
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setPen(QPen((option->state & State_MouseOver) ? QColor(Qt::white) : option->palette.window().color(), 2));
+            painter->setBrush(option->palette.highlight());
+            painter->drawEllipse(QRectF(option->rect).adjusted(1, 1, -1, -1));
+            painter->restore();
+            return;
+        }
+        if (qobject_cast<const QPushButton *>(widget))
+        {
+            QColor fill = colors->accent;
+            if (!(option->state & State_Enabled))
+                fill = colors->disabledButton;
+            else if (option->state & (State_Sunken | State_On))
+                fill = colors->accentPressed;
+            else if (option->state & State_MouseOver)
+                fill = colors->accentHover;
+            painter->save();
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(fill);
+            painter->drawRoundedRect(QRectF(option->rect), 8, 8);
+            painter->restore();
+            return;
+        }
+        break;
+
+    case PE_Frame:
+        if (widget && widget->property("themeCard").toBool())
+        {
+            painter->save();
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setPen(QPen(option->palette.highlight().color(), 2));
+            painter->setBrush(option->palette.base());
+            painter->drawRoundedRect(QRectF(option->rect).adjusted(1, 1, -1, -1), 16, 16);
+            painter->restore();
+            return;
+        }
+        break;
+
+    case PE_PanelLineEdit:
+        if (auto panel = qstyleoption_cast<const QStyleOptionFrame *>(option))
+        {
+            // Line edits inside spin boxes and combo boxes have no frame of their own
+            if (panel->lineWidth > 0)
+            {
+                drawField(painter, panel->rect, panel->palette, panel->state & State_HasFocus);
+                return;
+            }
+        }
+        break;
+
+    case PE_IndicatorCheckBox:
+    {
+        bool checked = option->state & (State_On | State_NoChange);
+        bool hovered = (option->state & State_MouseOver) && (option->state & State_Enabled);
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(QPen(checked || hovered ? colors->accent : colors->border, 2));
+        painter->setBrush(checked ? QBrush(colors->accent) : QBrush(Qt::NoBrush));
+        painter->drawRoundedRect(QRectF(option->rect).adjusted(1, 1, -1, -1), 6, 6);
+        painter->restore();
+        if (checked)
+            drawGlyph(painter, option->rect, CheckMark, colors->accentText);
+        return;
+    }
+
+    case PE_FrameGroupBox:
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(QPen(colors->border, 1));
+        painter->setBrush(option->palette.base());
+        painter->drawRoundedRect(QRectF(option->rect).adjusted(0.5, 0.5, -0.5, -0.5), 12, 12);
+        painter->restore();
+        return;
+
+    case PE_FrameTabWidget:
+    case PE_FrameTabBarBase:
+        return; // Flat pane; the selected tab is underlined instead
+
+    default:
+        break;
+    }
+    QProxyStyle::drawPrimitive(element, option, painter, widget);
+}
+
+void ThemeStyle::drawControl(ControlElement element, const QStyleOption *option, QPainter *painter, const QWidget *widget) const
+{
+    if (!colors)
+    {
+        QProxyStyle::drawControl(element, option, painter, widget);
+        return;
+    }
+
+    switch (element)
+    {
+    case CE_TabBarTabShape:
+        if (option->state & State_Selected)
+        {
+            QRect line = option->rect;
+            line.setTop(line.bottom() - 2);
+            painter->fillRect(line, colors->accent);
+        }
+        else if (option->state & State_MouseOver)
+        {
+            painter->save();
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(QColor(128, 128, 128, 13));
+            painter->drawRoundedRect(QRectF(option->rect), 4, 4);
+            painter->restore();
+        }
+        return;
+
+    case CE_TabBarTabLabel:
+        if (auto tab = qstyleoption_cast<const QStyleOptionTab *>(option))
+        {
+            QStyleOptionTab copy = *tab;
+            QColor color = (tab->state & (State_Selected | State_MouseOver)) ? colors->accent : colors->text;
+            copy.palette.setColor(QPalette::WindowText, color);
+            copy.palette.setColor(QPalette::ButtonText, color);
+            QProxyStyle::drawControl(element, &copy, painter, widget);
+            return;
+        }
+        break;
+
+    case CE_HeaderSection:
+    {
+        QRect line = option->rect;
+        line.setTop(line.bottom() - 1);
+        painter->fillRect(line, colors->border);
+        return;
+    }
+
+    case CE_HeaderLabel:
+        if (auto header = qstyleoption_cast<const QStyleOptionHeader *>(option))
+        {
+            QStyleOptionHeader copy = *header;
+            copy.text = header->text.toUpper();
+            copy.palette.setColor(QPalette::ButtonText, colors->text);
+            QProxyStyle::drawControl(element, &copy, painter, widget);
+            return;
+        }
+        break;
+
+    default:
+        break;
+    }
+    QProxyStyle::drawControl(element, option, painter, widget);
+}
+
+void ThemeStyle::drawComplexControl(ComplexControl control, const QStyleOptionComplex *option, QPainter *painter, const QWidget *widget) const
+{
+    if (colors && control == CC_SpinBox)
+    {
+        if (auto spin = qstyleoption_cast<const QStyleOptionSpinBox *>(option))
+        {
+            if (spin->frame)
+                drawField(painter, spin->rect, spin->palette, spin->state & State_HasFocus);
+            else
+                painter->fillRect(spin->rect, spin->palette.base());
+            if (spin->buttonSymbols == QAbstractSpinBox::NoButtons)
+                return;
+
+            const struct
+            {
+                SubControl sub;
+                Glyph glyph;
+                bool enabled;
+            } buttons[] = {{SC_SpinBoxUp, ArrowUp, bool(spin->stepEnabled & QAbstractSpinBox::StepUpEnabled)},
+                           {SC_SpinBoxDown, ArrowDown, bool(spin->stepEnabled & QAbstractSpinBox::StepDownEnabled)}};
+            for (const auto &button : buttons)
+            {
+                QRect rect = proxy()->subControlRect(CC_SpinBox, spin, button.sub, widget);
+                bool active = button.enabled && (spin->activeSubControls & button.sub);
+                if (active && (spin->state & State_Sunken))
+                    painter->fillRect(rect.adjusted(2, 2, -2, -2), colors->accentPressed);
+                else if (active && (spin->state & State_MouseOver))
+                    painter->fillRect(rect.adjusted(2, 2, -2, -2), colors->accentHover);
+                painter->save();
+                if (!button.enabled || !(spin->state & State_Enabled))
+                    painter->setOpacity(0.4);
+                drawGlyph(painter, rect, button.glyph, colors->text);
+                painter->restore();
+            }
+            return;
+        }
+    }
+    else if (colors && control == CC_ComboBox)
+    {
+        if (auto combo = qstyleoption_cast<const QStyleOptionComboBox *>(option))
+        {
+            if (combo->frame)
+                drawField(painter, combo->rect, combo->palette, combo->state & (State_HasFocus | State_On));
+            else
+                painter->fillRect(combo->rect, combo->palette.base());
+            QRect arrow = proxy()->subControlRect(CC_ComboBox, combo, SC_ComboBoxArrow, widget);
+            drawGlyph(painter, arrow, ArrowDown, colors->text);
+            return;
+        }
+    }
+    QProxyStyle::drawComplexControl(control, option, painter, widget);
+}
+
+int ThemeStyle::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWidget *widget) const
+{
+    switch (metric)
+    {
+    case PM_IndicatorWidth:
+    case PM_IndicatorHeight:
+        return INDICATOR_SIZE;
+    case PM_CheckBoxLabelSpacing:
+        return 8;
+    default:
+        return QProxyStyle::pixelMetric(metric, option, widget);
+    }
+}
+
+int ThemeStyle::styleHint(StyleHint hint, const QStyleOption *option, const QWidget *widget, QStyleHintReturn *returnData) const
+{
+    if (colors)
+    {
+        switch (hint)
+        {
+        case SH_TabBar_Alignment:
+            return Qt::AlignCenter;
+        case SH_GroupBox_TextLabelColor:
+            return int(colors->accent.rgba());
+        case SH_Table_GridLineColor:
+            return int(colors->border.rgba());
+        default:
+            break;
+        }
+    }
+    return QProxyStyle::styleHint(hint, option, widget, returnData);
+}
+
+QSize ThemeStyle::sizeFromContents(ContentsType type, const QStyleOption *option, const QSize &size, const QWidget *widget) const
+{
+    QSize result = QProxyStyle::sizeFromContents(type, option, size, widget);
+    switch (type)
+    {
+    case CT_PushButton:
+        if (!(widget && widget->property("themeSwatch").toBool()))
+            result += QSize(24, 12);
+        break;
+    case CT_LineEdit:
+    case CT_SpinBox:
+    case CT_ComboBox:
+        result += QSize(12, 12);
+        break;
+    case CT_TabBarTab:
+        result += QSize(32, 12);
+        break;
+    case CT_HeaderSection:
+        result += QSize(8, 8);
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// ThemeEngine
+// ---------------------------------------------------------------------------
+
+ThemeEngine &ThemeEngine::instance()
+{
+    static ThemeEngine engine;
+    return engine;
+}
+
+ThemeEngine::ThemeEngine()
+{
+    themes = {
+        // 1. Deep Space (Dark Blue-Grey & Soft Blue)
+        {"Deep Space", QColor("#1E1E2E"), QColor("#89B4FA")},
+        // 2. Clean Slate (Off-White & Bootstrap Blue)
+        {"Clean Slate", QColor("#F8F9FA"), QColor("#0D6EFD")},
+        // 3. Forest Focus (Dark Green-Grey & Vibrant Green)
+        {"Forest Focus", QColor("#2D333B"), QColor("#46954A")},
+        // 4. Cyber Punk (Midnight Blue & Neon Pink)
+        {"Cyber Punk", QColor("#0B132B"), QColor("#FF007F")}};
+
+    for (const AppTheme &theme : themes)
+        prepared.append(prepare(theme));
+}
+
+ThemeColors ThemeEngine::prepare(const AppTheme &theme)
+{
+    ThemeColors c;
+    c.text = getContrastColor(theme.primary);
+    c.accent = theme.secondary;
+    c.accentText = getContrastColor(theme.secondary);
+    c.accentHover = theme.secondary.lighter(110);
+    c.accentPressed = theme.secondary.darker(120);
+    c.disabledButton = theme.primary.darker(110);
+    c.border = c.text;
+    c.border.setAlphaF(0.3);
+
+    QPalette &p = c.palette;
+    p.setColor(QPalette::Window, theme.primary);
+    p.setColor(QPalette::WindowText, c.text);
+    p.setColor(QPalette::Base, theme.primary);
+    p.setColor(QPalette::AlternateBase, theme.primary.lighter(110));
+    p.setColor(QPalette::ToolTipBase, theme.primary);
+    p.setColor(QPalette::ToolTipText, c.text);
+    p.setColor(QPalette::Text, c.text);
+
+    // Set global Button role to primary so tabs/panels match the background
+    p.setColor(QPalette::Button, theme.primary);
+    p.setColor(QPalette::ButtonText, c.text);
+
+    p.setColor(QPalette::BrightText, Qt::red);
+    p.setColor(QPalette::Link, theme.secondary);
+    p.setColor(QPalette::Highlight, theme.secondary);
+    p.setColor(QPalette::HighlightedText, c.accentText);
+
+    // Placeholder text (semi-transparent version of text color)
+    QColor placeholder = c.text;
+    placeholder.setAlpha(128);
+    p.setColor(QPalette::PlaceholderText, placeholder);
+
+    c.buttonPalette = p;
+    c.buttonPalette.setColor(QPalette::Button, theme.secondary);
+    c.buttonPalette.setColor(QPalette::ButtonText, c.accentText);
+    c.buttonPalette.setColor(QPalette::Disabled, QPalette::Button, c.disabledButton);
+    c.buttonPalette.setColor(QPalette::Disabled, QPalette::ButtonText, c.text);
+    return c;
+}
+
+void ThemeEngine::apply(int index)
+{
+    if (index < 0 || index >= themes.size() || index == current)
+        return;
+
+    if (!style)
+    {
+        style = new ThemeStyle();
+        QApplication::setStyle(style);
+
+        QFont font = QApplication::font();
+        font.setFamilies({"Segoe UI", "Roboto"});
+        font.setStyleHint(QFont::SansSerif);
+        font.setPixelSize(16);
+        QApplication::setFont(font);
+
+        QFont bold = font;
+        bold.setBold(true);
+        QApplication::setFont(bold, "QPushButton");
+        QApplication::setFont(bold, "QHeaderView");
+        bold.setPixelSize(14);
+        QApplication::setFont(bold, "QTabBar");
+
+        for (const ThemeColors &colors : prepared)
+            for (QScreen *screen : QGuiApplication::screens())
+                style->prepareGlyphs(colors, screen->devicePixelRatio());
+    }
+
+    // The style reads its colors at paint time, so the palette change repaints everything once
+    current = index;
+    style->setColors(&prepared[index]);
+    QApplication::setPalette(prepared[index].palette);
+    QApplication::setPalette(prepared[index].buttonPalette, "QPushButton");
+}
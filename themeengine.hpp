@@ -0,0 +1,133 @@
+#ifndef THEMEENGINE_HPP
+#define THEMEENGINE_HPP
+
+#include <QColor>
+#include <QHash>
+#include <QPalette>
+#include <QPixmap>
+#include <QProxyStyle>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Defines the color palette for the application theme.
+ */
+struct AppTheme
+{
+    QString name;
+    QColor primary;   // Backgrounds
+    QColor secondary; // Buttons & Accents
+};
+
+/**
+ * @brief Everything a theme needs at paint time, worked out once per theme.
+ */
+struct ThemeColors
+{
+    QPalette palette;       ///< Application palette.
+    QPalette buttonPalette; ///< Push buttons: accent background, contrasting text.
+    QColor text;            ///< Contrast color for the primary background.
+    QColor accent;
+    QColor accentText;      ///< Contrast color for the accent.
+    QColor accentHover;
+    QColor accentPressed;
+    QColor disabledButton;
+    QColor border;          ///< Text color at 30% opacity.
+};
+
+/**
+ * @brief Fusion with the Acadence look: flat rounded buttons and fields,
+ * underlined tabs, rounded check boxes and group boxes.
+ *
+ * Colors come from the current ThemeColors and the widgets' palettes, so
+ * changing theme needs no re-polish. The check mark and the arrows are
+ * pre-rendered pixmaps, cached per color and device pixel ratio.
+ *
+ * Widgets opt in to two extra shapes with dynamic properties:
+ * "themeCard" on a QFrame::StyledPanel frame draws a rounded card, and
+ * "themeSwatch" on a QPushButton draws a round swatch of the accent.
+ */
+class ThemeStyle : public QProxyStyle
+{
+    Q_OBJECT
+public:
+    ThemeStyle();
+
+    void setColors(const ThemeColors *colors) { this->colors = colors; }
+
+    /**
+     * @brief Renders a theme's glyphs at @p dpr ahead of the first paint.
+     */
+    void prepareGlyphs(const ThemeColors &theme, qreal dpr) const;
+
+    void polish(QWidget *widget) override;
+    using QProxyStyle::polish;
+
+    void drawPrimitive(PrimitiveElement element, const QStyleOption *option, QPainter *painter, const QWidget *widget = nullptr) const override;
+    void drawControl(ControlElement element, const QStyleOption *option, QPainter *painter, const QWidget *widget = nullptr) const override;
+    void drawComplexControl(ComplexControl control, const QStyleOptionComplex *option, QPainter *painter, const QWidget *widget = nullptr) const override;
+    int pixelMetric(PixelMetric metric, const QStyleOption *option = nullptr, const QWidget *widget = nullptr) const override;
+    int styleHint(StyleHint hint, const QStyleOption *option = nullptr, const QWidget *widget = nullptr, QStyleHintReturn *returnData = nullptr) const override;
+    QSize sizeFromContents(ContentsType type, const QStyleOption *option, const QSize &size, const QWidget *widget = nullptr) const override;
+
+private:
+    enum Glyph
+    {
+        CheckMark,
+        ArrowUp,
+        ArrowDown
+    };
+
+    QPixmap glyph(Glyph kind, const QColor &color, qreal dpr) const;
+    void drawGlyph(QPainter *painter, const QRect &rect, Glyph kind, const QColor &color) const;
+
+    /**
+     * @brief Rounded input field frame, accent-colored when focused.
+     */
+    void drawField(QPainter *painter, const QRect &rect, const QPalette &palette, bool focused) const;
+
+    const ThemeColors *colors = nullptr;
+    mutable QHash<quint64, QPixmap> glyphs; ///< (glyph, color, dpr) -> pixmap.
+};
+
+/**
+ * @brief Owns the application themes and switches between them.
+ *
+ * Each theme's palettes and colors are computed once, and the glyphs of
+ * every theme are rendered for the connected screens when the style is
+ * installed. Applying a theme then only swaps the style's colors and sets
+ * the application palette: widgets repaint with the new colors in the next
+ * frame, without the style sheet parse and re-polish of every widget that
+ * QApplication::setStyleSheet() costs.
+ */
+class ThemeEngine
+{
+public:
+    static ThemeEngine &instance();
+
+    const QVector<AppTheme> &getThemes() const { return themes; }
+
+    /**
+     * @return Index of the applied theme; -1 before the first apply().
+     */
+    int getIndex() const { return current; }
+
+    const AppTheme &getTheme() const { return themes[qMax(0, current)]; }
+
+    /**
+     * @brief Makes theme @p index current; installs the style on first use.
+     */
+    void apply(int index);
+
+private:
+    ThemeEngine();
+
+    static ThemeColors prepare(const AppTheme &theme);
+
+    QVector<AppTheme> themes;
+    QVector<ThemeColors> prepared; ///< Parallel to themes.
+    ThemeStyle *style = nullptr;   ///< Owned by QApplication once installed.
+    int current = -1;
+};
+
+#endif // THEMEENGINE_HPP
@@ -1,61 +1,194 @@
 #include "timer.hpp"
+#include "timerservice.hpp"
+#include "exceptions.hpp"
+#include <cmath>
 
-Timer::Timer(QObject *parent) : QObject(parent), remainingTime(0), isPaused(false)
+static const float PROGRESS_STEP = 1.0f / 5760; ///< One step of a QPainter arc (1/16 degree).
+
+Timer::Timer(QObject *parent)
+    : QObject(parent), handle(0), deadline(0), remainingTime(0), totalTime(0), isPaused(false), animated(false),
+      lastProgress(-1.0f), m_userId(0)
+{
+}
+
+Timer::~Timer()
 {
-    internalTimer = new QTimer(this);
-    connect(internalTimer, &QTimer::timeout, this, &Timer::onTimeout);
+    cancelTick();
 }
 
 void Timer::start(int minutes)
 {
     if (minutes <= 0)
         return;
-    remainingTime = minutes * 60 * 1000; // Convert to milliseconds
-    totalTime = remainingTime;
+    cancelTick();
+    totalTime = qint64(minutes) * 60 * 1000; // Convert to milliseconds
+    // On the shared second grid: all timers change their display on the same wake-up
+    deadline = TimerService::alignToSecond(TimerService::instance().now() + totalTime);
     isPaused = false;
-    internalTimer->start(10); // 10ms interval for smooth updates
-    onTimeout();              // Update display immediately
+    onTimeout(); // Update display immediately
+    saveState();
 }
 
 void Timer::pause()
 {
-    if (internalTimer->isActive())
+    if (handle != 0)
     {
-        internalTimer->stop();
+        cancelTick();
+        remainingTime = remaining();
         isPaused = true;
+        saveState();
     }
     else if (isPaused && remainingTime > 0)
     {
-        internalTimer->start(10);
+        deadline = TimerService::alignToSecond(TimerService::instance().now() + remainingTime);
         isPaused = false;
+        onTimeout();
+        saveState();
     }
 }
 
 void Timer::stop()
 {
-    internalTimer->stop();
+    cancelTick();
     isPaused = false;
     remainingTime = 0;
-    emit timeUpdated("00:00", 0.0f);
+    totalTime = 0;
+    report(0);
+    saveState();
 }
 
-void Timer::onTimeout()
+void Timer::setAnimated(bool on)
 {
-    int min = remainingTime / 60000;
-    int sec = (remainingTime % 60000) / 1000;
+    if (animated == on)
+        return;
+    animated = on;
+    if (handle != 0)
+    {
+        cancelTick();
+        onTimeout(); // Reschedule at the new rate
+    }
+}
+
+void Timer::setPersistence(int userId, const QString &name)
+{
+    m_userId = userId;
+    m_name = name;
+}
 
-    QString timeStr = QString("%1:%2").arg(min, 2, 10, QChar('0')).arg(sec, 2, 10, QChar('0'));
+bool Timer::restore()
+{
+    TimerState state;
+    if (m_name.isEmpty() || !TimerService::instance().loadState(m_userId, m_name, state) || state.total <= 0)
+        return false;
+
+    cancelTick();
+    m_tag = state.tag;
+    totalTime = state.total;
+    if (state.paused)
+    {
+        remainingTime = state.remaining;
+        isPaused = true;
+        report(remainingTime);
+        return true;
+    }
+
+    qint64 left = QDateTime::currentDateTime().msecsTo(state.endsAt);
+    if (left <= 0)
+    {
+        stop(); // Ran out while the application was closed
+        return false;
+    }
+    deadline = TimerService::alignToSecond(TimerService::instance().now() + left);
+    isPaused = false;
+    onTimeout();
+    return true;
+}
+
+qint64 Timer::remaining() const
+{
+    return qMax<qint64>(0, deadline - TimerService::instance().now());
+}
 
-    float progress = (totalTime > 0) ? (float)remainingTime / totalTime : 0.0f;
+void Timer::report(qint64 left)
+{
+    // Round up so the display reads 00:00 exactly when the countdown ends
+    qint64 seconds = (left + 999) / 1000;
+    QString timeStr = QString("%1:%2").arg(seconds / 60, 2, 10, QChar('0')).arg(seconds % 60, 2, 10, QChar('0'));
+    float progress = (totalTime > 0) ? qMin(1.0f, (float)left / totalTime) : 0.0f; // Grid alignment may add < 1 s
+
+    // Between seconds only the progress moves; skip changes too small to draw
+    if (timeStr == lastTime && (!animated || std::fabs(progress - lastProgress) < PROGRESS_STEP))
+        return;
+    lastTime = timeStr;
+    lastProgress = progress;
     emit timeUpdated(timeStr, progress);
+}
+
+void Timer::scheduleNextTick(qint64 left)
+{
+    // The displayed second changes when left reaches the next whole second
+    qint64 wait = left % 1000;
+    if (wait == 0)
+        wait = 1000;
+    if (animated)
+    {
+        // Wake when the ring would move by a drawable step; the service batches wake-ups per frame
+        wait = qMin(wait, qMax<qint64>(1, qint64(std::ceil(totalTime * PROGRESS_STEP))));
+    }
+    handle = TimerService::instance().schedule(this, TimerService::instance().now() + wait);
+}
+
+void Timer::cancelTick()
+{
+    if (handle != 0)
+        TimerService::instance().cancel(handle);
+    handle = 0;
+}
 
-    if (remainingTime <= 0)
+void Timer::onTimeout()
+{
+    handle = 0; // Delivered, or called directly with nothing pending
+    qint64 left = remaining();
+    report(left);
+
+    if (left <= 0)
     {
-        internalTimer->stop();
+        saveState();
         emit finished();
     }
     else
     {
-        remainingTime -= 10;
+        scheduleNextTick(left);
+    }
+}
+
+void Timer::saveState()
+{
+    if (m_name.isEmpty())
+        return;
+    try
+    {
+        TimerState state;
+        state.total = totalTime;
+        state.tag = m_tag;
+        if (handle != 0)
+        {
+            state.endsAt = QDateTime::currentDateTime().addMSecs(remaining());
+            TimerService::instance().saveState(m_userId, m_name, state);
+        }
+        else if (isPaused && remainingTime > 0)
+        {
+            state.paused = true;
+            state.remaining = remainingTime;
+            TimerService::instance().saveState(m_userId, m_name, state);
+        }
+        else
+        {
+            TimerService::instance().clearState(m_userId, m_name);
+        }
     }
-}
\ No newline at end of file
+    catch (const Acadence::Exception &e)
+    {
+        // The countdown itself is unaffected; it just won't survive a restart
+    }
+}
@@ -2,18 +2,24 @@
 #define TIMER_HPP
 
 #include <QObject>
-#include <QTimer>
+#include <QString>
 
 /**
- * @brief A high-precision timer for tracking duration habits.
+ * @brief A countdown timer for tracking duration habits.
  *
- * Emits signals for UI updates and completion.
+ * The remaining time is always read from a monotonic clock against a
+ * deadline, so a late event loop never makes it drift. Wake-ups come from
+ * the shared TimerService: only when the displayed second changes, or when
+ * the progress ring would visibly move while animated, and timeUpdated()
+ * is emitted only when what it reports changed. Any number of timers can
+ * run at once at the cost of one.
  */
 class Timer : public QObject
 {
     Q_OBJECT
 public:
     explicit Timer(QObject *parent = nullptr);
+    ~Timer();
 
     /**
      * @brief Starts the timer for a specific duration.
@@ -31,17 +37,56 @@ public:
      */
     void stop();
 
+    /**
+     * @brief Reports progress at the display refresh rate (e.g. while a
+     * progress ring is on screen) instead of once per second.
+     */
+    void setAnimated(bool animated);
+
+    /**
+     * @brief Keeps the timer's state in timers.csv under a name for the user.
+     */
+    void setPersistence(int userId, const QString &name);
+
+    /**
+     * @brief Picks up the state saved under the persistence name.
+     * @return False if nothing was saved or the countdown ran out meanwhile.
+     */
+    bool restore();
+
+    /**
+     * @brief Free text saved with the state (e.g. the ID of the habit being timed).
+     */
+    void setTag(const QString &tag) { m_tag = tag; }
+    QString getTag() const { return m_tag; }
+
 signals:
-    void timeUpdated(QString time, float progress); ///< Emitted every tick with formatted time and progress (0.0-1.0).
+    void timeUpdated(QString time, float progress); ///< Emitted when the formatted time or progress (1.0-0.0) changes.
     void finished();                                ///< Emitted when timer reaches zero.
 
 private slots:
     void onTimeout();
 
 private:
-    QTimer *internalTimer;
-    int remainingTime; ///< Remaining time in milliseconds.
-    int totalTime;     ///< Total duration in milliseconds.
+    friend class TimerService; // Delivers onTimeout()
+
+    qint64 remaining() const;
+    void report(qint64 left);
+    void scheduleNextTick(qint64 left);
+    void cancelTick();
+    void saveState();
+
+    quint64 handle;       ///< Pending TimerService wake-up, or 0.
+    qint64 deadline;      ///< Service clock time at which the countdown ends, in milliseconds.
+    qint64 remainingTime; ///< Remaining time in milliseconds while paused.
+    qint64 totalTime;     ///< Total duration in milliseconds.
     bool isPaused;
+    bool animated;
+    QString lastTime;   ///< Last reported time text.
+    float lastProgress; ///< Last reported progress.
+
+    int m_userId;   ///< Owner of the saved state.
+    QString m_name; ///< Name of the saved state; empty if not saved.
+    QString m_tag;
 };
-#endif // TIMER_HPP
\ No newline at end of file
+#endif // TIMER_HPP
@@ -0,0 +1,112 @@
+/**
+ * @file timerservice.cpp
+ * @brief Hierarchical timer wheel shared by every Timer, and their saved state.
+ */
+#include "timerservice.hpp"
+#include "datastore.hpp"
+#include "timer.hpp"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QVector>
+
+static const int FALLBACK_FRAME_MS = 16;
+
+TimerService &TimerService::instance()
+{
+    static TimerService service;
+    return service;
+}
+
+TimerService::TimerService() : frame(FALLBACK_FRAME_MS), nextHandle(1)
+{
+    QScreen *screen = QGuiApplication::primaryScreen();
+    if (screen && screen->refreshRate() > 0)
+        frame = qMax(1, qRound(1000.0 / screen->refreshRate()));
+
+    wakeTimer = new QTimer(this);
+    wakeTimer->setSingleShot(true);
+    wakeTimer->setTimerType(Qt::PreciseTimer);
+    connect(wakeTimer, &QTimer::timeout, this, &TimerService::onWake);
+    clock.start();
+}
+
+quint64 TimerService::schedule(Timer *timer, qint64 due)
+{
+    // Idle wheel: drop cancelled leftovers and restart from the present
+    if (wheel.isEmpty())
+        wheel.reset(now() / frame);
+
+    quint64 handle = nextHandle++;
+    pending.insert(handle, timer);
+    wheel.insert(handle, (due + frame - 1) / frame);
+    rearm();
+    return handle;
+}
+
+void TimerService::cancel(quint64 handle)
+{
+    pending.remove(handle);
+    wheel.cancel(handle);
+}
+
+void TimerService::rearm()
+{
+    qint64 wake = wheel.nextWake();
+    if (wake < 0)
+    {
+        wakeTimer->stop();
+        return;
+    }
+    wakeTimer->start(int(qBound<qint64>(0, wake * frame - now(), 24 * 3600 * 1000)));
+}
+
+void TimerService::onWake()
+{
+    QVector<quint64> due;
+    wheel.advance(now() / frame, due);
+
+    // One batch per frame; a timer may schedule its next tick while being called
+    for (quint64 handle : due)
+    {
+        Timer *timer = pending.take(handle);
+        if (timer)
+            timer->onTimeout();
+    }
+    rearm();
+}
+
+void TimerService::saveState(int userId, const QString &name, const TimerState &state)
+{
+    // Format: UserID,Name,State,EndsAt,RemainingMs,TotalMs,Tag
+    QStringList row = {QString::number(userId), name, state.paused ? "paused" : "running",
+                       state.endsAt.toString(Qt::ISODateWithMs), QString::number(state.remaining),
+                       QString::number(state.total), state.tag};
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 { batch.apply("timers.csv", {TableChange(TableChange::Upsert, row)}); });
+}
+
+void TimerService::clearState(int userId, const QString &name)
+{
+    TimerState unused;
+    if (!loadState(userId, name, unused))
+        return;
+    DataStore::instance().commit([&](DataBatch &batch)
+                                 { batch.apply("timers.csv", {TableChange(TableChange::Delete, {QString::number(userId), name})}); });
+}
+
+bool TimerService::loadState(int userId, const QString &name, TimerState &state) const
+{
+    // Format: UserID,Name,State,EndsAt,RemainingMs,TotalMs,Tag
+    for (const auto &row : DataStore::instance().table("timers.csv")->getRows())
+    {
+        if (row.size() < 7 || row[0].toInt() != userId || row[1] != name)
+            continue;
+        state.paused = row[2] == "paused";
+        state.endsAt = QDateTime::fromString(row[3], Qt::ISODateWithMs);
+        state.remaining = row[4].toLongLong();
+        state.total = row[5].toLongLong();
+        state.tag = row[6];
+        return true;
+    }
+    return false;
+}
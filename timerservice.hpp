@@ -0,0 +1,97 @@
+#ifndef TIMERSERVICE_HPP
+#define TIMERSERVICE_HPP
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include "timerwheel.hpp"
+
+class Timer;
+
+/**
+ * @brief Saved state of one countdown, so it survives a restart.
+ */
+struct TimerState
+{
+    bool paused = false;
+    QDateTime endsAt;    ///< When a running countdown ends (wall clock).
+    qint64 remaining = 0; ///< Milliseconds left of a paused countdown.
+    qint64 total = 0;     ///< Full duration in milliseconds.
+    QString tag;          ///< Caller's data, e.g. the habit being timed.
+};
+
+/**
+ * @brief Runs every Timer of the application on one QTimer.
+ *
+ * Wake-ups are filed in a hierarchical TimerWheel whose tick is one frame
+ * (~16 ms): four levels of 64 slots, each next level 64 times coarser;
+ * entries cascade down a level as their time comes closer. The QTimer is armed only for the earliest occupied slot, and everything due
+ * in that frame is delivered in one batch. Countdown deadlines are placed
+ * on a common whole-second grid (Timer::start()), so any number of
+ * running timers change their displayed second on the same wake-up.
+ *
+ * The service also keeps the timers' state in timers.csv, one row per
+ * user and timer name.
+ */
+class TimerService : public QObject
+{
+    Q_OBJECT
+public:
+    static TimerService &instance();
+
+    /**
+     * @brief Milliseconds on the service's monotonic clock.
+     */
+    qint64 now() const { return clock.elapsed(); }
+
+    /**
+     * @brief Rounds a clock time up to the shared whole-second grid.
+     */
+    static qint64 alignToSecond(qint64 time) { return (time + 999) / 1000 * 1000; }
+
+    /**
+     * @brief Length of one wheel slot (one display frame) in milliseconds.
+     */
+    int getFrameInterval() const { return frame; }
+
+    /**
+     * @brief Calls @p timer's onTimeout() in the first frame at or after @p due.
+     * @return Handle for cancel(); never 0.
+     */
+    quint64 schedule(Timer *timer, qint64 due);
+
+    void cancel(quint64 handle);
+
+    /**
+     * @brief Stores or replaces the state of a user's named timer.
+     * @throws Acadence::Exception if the commit fails.
+     */
+    void saveState(int userId, const QString &name, const TimerState &state);
+
+    /**
+     * @brief Forgets a user's named timer.
+     */
+    void clearState(int userId, const QString &name);
+
+    /**
+     * @return False if nothing is stored for the timer.
+     */
+    bool loadState(int userId, const QString &name, TimerState &state) const;
+
+private:
+    TimerService();
+
+    void rearm();
+    void onWake();
+
+    QTimer *wakeTimer;
+    QElapsedTimer clock;
+    int frame; ///< Milliseconds per tick.
+    quint64 nextHandle;
+    TimerWheel wheel;
+    QHash<quint64, Timer *> pending; ///< Scheduled, not yet delivered or cancelled.
+};
+
+#endif // TIMERSERVICE_HPP
@@ -0,0 +1,112 @@
+/**
+ * @file timerwheel.cpp
+ * @brief Tick bookkeeping of the hierarchical timer wheel.
+ */
+#include "timerwheel.hpp"
+#include <utility>
+
+void TimerWheel::reset(qint64 tick)
+{
+    for (auto &level : wheel)
+        for (auto &slot : level)
+            slot.clear();
+    live.clear();
+    currentTick = tick;
+}
+
+void TimerWheel::insert(quint64 handle, qint64 tick)
+{
+    live.insert(handle);
+    file({handle, tick});
+}
+
+void TimerWheel::file(const Entry &entry)
+{
+    static const qint64 HORIZON = qint64(1) << (SLOT_BITS * LEVELS);
+
+    // Entries already due go in the next slot to be delivered
+    qint64 delta = qBound<qint64>(1, entry.tick - currentTick, HORIZON - 1);
+    qint64 tick = currentTick + delta;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (qint64(1) << (SLOT_BITS * (level + 1))))
+        ++level;
+    wheel[level][(tick >> (SLOT_BITS * level)) & (SLOTS - 1)].append(entry);
+}
+
+void TimerWheel::release(const QVector<Entry> &entries, qint64 t, QVector<quint64> &due)
+{
+    for (const Entry &entry : entries)
+    {
+        if (!live.contains(entry.handle))
+            continue;
+        if (entry.tick <= t)
+        {
+            live.remove(entry.handle);
+            due.append(entry.handle);
+        }
+        else
+        {
+            file(entry); // Closer now, or clamped beyond the horizon
+        }
+    }
+}
+
+void TimerWheel::advance(qint64 toTick, QVector<quint64> &due)
+{
+    if (toTick - currentTick > SLOTS * SLOTS)
+    {
+        // Long stall (e.g. the machine slept): refile everything instead of walking every tick
+        QVector<Entry> all;
+        for (auto &level : wheel)
+            for (auto &slot : level)
+                all += std::exchange(slot, {});
+        currentTick = toTick;
+        release(all, toTick, due);
+        return;
+    }
+
+    for (qint64 t = currentTick + 1; t <= toTick; ++t)
+    {
+        // Distances are measured from t from here on: measured from t - 1, an
+        // entry a whole coarse period away would go back into the slot that is
+        // being emptied and wait a full turn of that level
+        currentTick = t;
+
+        // A coarser slot whose period starts now moves down to the finer levels
+        for (int level = LEVELS - 1; level >= 1; --level)
+        {
+            if ((t & ((qint64(1) << (SLOT_BITS * level)) - 1)) != 0)
+                continue;
+            release(std::exchange(wheel[level][(t >> (SLOT_BITS * level)) & (SLOTS - 1)], {}), t, due);
+        }
+        release(std::exchange(wheel[0][t & (SLOTS - 1)], {}), t, due);
+    }
+}
+
+qint64 TimerWheel::nextWake() const
+{
+    auto occupied = [this](const QVector<Entry> &slot)
+    {
+        for (const Entry &entry : slot)
+            if (live.contains(entry.handle))
+                return true;
+        return false;
+    };
+
+    qint64 wake = -1;
+    for (int level = 0; level < LEVELS; ++level)
+    {
+        int shift = SLOT_BITS * level;
+        for (qint64 period = (currentTick >> shift) + 1; period <= (currentTick >> shift) + SLOTS; ++period)
+        {
+            if (occupied(wheel[level][period & (SLOTS - 1)]))
+            {
+                qint64 tick = period << shift;
+                if (wake < 0 || tick < wake)
+                    wake = tick;
+                break;
+            }
+        }
+    }
+    return wake;
+}
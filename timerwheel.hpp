@@ -0,0 +1,82 @@
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include <QSet>
+#include <QVector>
+#include <array>
+
+/**
+ * @brief Hierarchical timer wheel counting in ticks, with no clock of its own.
+ *
+ * Four levels of 64 slots: a level-0 slot is one tick, each next level 64
+ * times coarser. An entry is filed at the finest level whose span covers
+ * its distance from the current tick; when the period of a coarser slot
+ * starts, its entries cascade down to finer levels. Cancelled entries stay
+ * in their slot and are dropped when it comes up.
+ */
+class TimerWheel
+{
+public:
+    explicit TimerWheel(qint64 tick = 0) : currentTick(tick) {}
+
+    /**
+     * @return True if no live entry is left.
+     */
+    bool isEmpty() const { return live.isEmpty(); }
+
+    /**
+     * @brief Last tick whose slot was delivered.
+     */
+    qint64 getCurrentTick() const { return currentTick; }
+
+    /**
+     * @brief Drops every entry and restarts the wheel at @p tick.
+     */
+    void reset(qint64 tick);
+
+    /**
+     * @brief Files @p handle to be due in @p tick; one already due comes in the next tick.
+     */
+    void insert(quint64 handle, qint64 tick);
+
+    void cancel(quint64 handle) { live.remove(handle); }
+
+    /**
+     * @brief Walks the wheel up to @p toTick.
+     * @param due Receives the handles that became due, each once.
+     */
+    void advance(qint64 toTick, QVector<quint64> &due);
+
+    /**
+     * @return The earliest tick at which a slot with a live entry is delivered
+     * or cascaded, or -1 if there is none.
+     */
+    qint64 nextWake() const;
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    struct Entry
+    {
+        quint64 handle;
+        qint64 tick; ///< Tick in which it is due.
+    };
+
+    /**
+     * @brief Places a live entry by its distance from currentTick.
+     */
+    void file(const Entry &entry);
+
+    /**
+     * @brief Delivers or refiles the live entries taken out of a slot in tick @p t.
+     */
+    void release(const QVector<Entry> &entries, qint64 t, QVector<quint64> &due);
+
+    qint64 currentTick;
+    std::array<std::array<QVector<Entry>, SLOTS>, LEVELS> wheel;
+    QSet<quint64> live; ///< Inserted, not yet delivered or cancelled.
+};
+
+#endif // TIMERWHEEL_HPP
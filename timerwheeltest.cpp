@@ -0,0 +1,99 @@
+/**
+ * @file timerwheeltest.cpp
+ * @brief Tests that the timer wheel delivers every entry in its own tick.
+ *
+ * Entries are placed just before, on and after the span of each level, from
+ * start ticks on and off the level boundaries, and the wheel is walked both
+ * tick by tick and from one nextWake() to the next, as TimerService does.
+ */
+#include "timerwheel.hpp"
+#include <QMap>
+#include <QtTest>
+
+namespace
+{
+    const qint64 DISTANCES[] = {1, 2, 62, 63, 64, 65, 126, 127, 128, 129, 4031, 4032, 4095, 4096, 4097,
+                                4160, 8191, 8192, 262143, 262144, 262145, 300000};
+}
+
+class TimerWheelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void deliversAcrossLevelBoundaries_data();
+    void deliversAcrossLevelBoundaries();
+    void cancelledEntriesAreNotDelivered();
+    void overdueEntriesComeInTheNextTick();
+};
+
+void TimerWheelTest::deliversAcrossLevelBoundaries_data()
+{
+    QTest::addColumn<qint64>("start");
+    QTest::addColumn<bool>("stepByWake");
+    for (qint64 start : {0, 5, 61, 63, 64, 4000, 4095, 4096})
+    {
+        QTest::addRow("from %lld, every tick", start) << start << false;
+        QTest::addRow("from %lld, by wake", start) << start << true;
+    }
+}
+
+void TimerWheelTest::deliversAcrossLevelBoundaries()
+{
+    QFETCH(qint64, start);
+    QFETCH(bool, stepByWake);
+
+    TimerWheel wheel(start);
+    QMap<quint64, qint64> expected;
+    quint64 handle = 1;
+    for (qint64 distance : DISTANCES)
+    {
+        wheel.insert(handle, start + distance);
+        expected.insert(handle++, start + distance);
+    }
+
+    QMap<quint64, qint64> delivered;
+    qint64 tick = start;
+    while (!wheel.isEmpty())
+    {
+        qint64 next = stepByWake ? wheel.nextWake() : tick + 1;
+        QVERIFY2(next > tick, "no wake-up while entries are pending");
+        QVector<quint64> due;
+        wheel.advance(next, due);
+        tick = next;
+        for (quint64 h : due)
+        {
+            QVERIFY2(!delivered.contains(h), "delivered twice");
+            delivered.insert(h, tick);
+        }
+    }
+    QCOMPARE(delivered, expected);
+}
+
+void TimerWheelTest::cancelledEntriesAreNotDelivered()
+{
+    TimerWheel wheel;
+    wheel.insert(1, 100);
+    wheel.insert(2, 100);
+    wheel.cancel(1);
+
+    QVector<quint64> due;
+    wheel.advance(100, due);
+    QCOMPARE(due, QVector<quint64>{2});
+    QVERIFY(wheel.isEmpty());
+    QCOMPARE(wheel.nextWake(), qint64(-1));
+}
+
+void TimerWheelTest::overdueEntriesComeInTheNextTick()
+{
+    TimerWheel wheel(50);
+    wheel.insert(1, 10);
+    QCOMPARE(wheel.nextWake(), qint64(51));
+
+    QVector<quint64> due;
+    wheel.advance(51, due);
+    QCOMPARE(due, QVector<quint64>{1});
+}
+
+QTEST_APPLESS_MAIN(TimerWheelTest)
+#include "timerwheeltest.moc"
@@ -0,0 +1,263 @@
+/**
+ * @file tracer.cpp
+ * @brief Per-thread event rings and the thread that writes them to the trace file.
+ */
+#include "tracer.hpp"
+#include "exceptions.hpp"
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+static const int RING_CAPACITY = 1 << 14; // Events per thread between two flushes
+static const int DETAIL_LENGTH = 31;
+static const int FLUSH_INTERVAL_MS = 50;
+
+std::atomic<bool> Tracer::active{false};
+
+namespace
+{
+    struct Event
+    {
+        qint64 ns;
+        const char *category;
+        const char *name;
+        char phase;
+        quint8 detailLength;
+        char16_t detail[DETAIL_LENGTH]; ///< UTF-16, so recording never allocates.
+    };
+
+    /**
+     * @brief Single-producer, single-consumer ring: the owning thread writes
+     * at head, the flusher reads at tail.
+     */
+    struct Ring
+    {
+        Event events[RING_CAPACITY];
+        std::atomic<quint64> head{0};
+        std::atomic<quint64> tail{0};
+        std::atomic<quint64> dropped{0};
+        int tid = 0;
+        QString threadName;
+        bool named = false;       ///< Flusher only: thread name written.
+        quint64 reportedDrops = 0; ///< Flusher only.
+    };
+
+    struct State
+    {
+        QMutex mutex; ///< Guards rings and stopping; the file belongs to the flusher.
+        QWaitCondition wake;
+        QVector<std::shared_ptr<Ring>> rings;
+        bool stopping = false;
+        QThread *flusher = nullptr;
+        QFile file;
+        qint64 originNs = 0;
+    };
+
+    State &state()
+    {
+        static State instance;
+        return instance;
+    }
+
+    qint64 nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Ring &localRing()
+    {
+        thread_local std::shared_ptr<Ring> ring = []
+        {
+            auto created = std::make_shared<Ring>();
+            QThread *thread = QThread::currentThread();
+            bool main = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread();
+            QMutexLocker lock(&state().mutex);
+            created->tid = state().rings.size() + 1;
+            created->threadName = main ? QString("Main thread") : thread->objectName();
+            if (created->threadName.isEmpty())
+                created->threadName = QString("Thread %1").arg(created->tid);
+            state().rings.append(created);
+            return created;
+        }();
+        return *ring;
+    }
+
+    void appendString(QByteArray &out, const QString &text)
+    {
+        QString escaped;
+        escaped.reserve(text.size());
+        for (QChar c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            if (c.unicode() < 0x20)
+                escaped += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+            else
+                escaped += c;
+        }
+        out += '"';
+        out += escaped.toUtf8();
+        out += '"';
+    }
+
+    void appendHeader(QByteArray &out, const char *phase, const char *category, const QString &name, qint64 ns, int tid)
+    {
+        out += "{\"ph\":\"";
+        out += phase;
+        out += "\",\"cat\":";
+        appendString(out, QString::fromLatin1(category));
+        out += ",\"name\":";
+        appendString(out, name);
+        out += ",\"ts\":" + QByteArray::number((ns - state().originNs) / 1000.0, 'f', 3);
+        out += ",\"pid\":" + QByteArray::number(QCoreApplication::applicationPid());
+        out += ",\"tid\":" + QByteArray::number(tid);
+    }
+
+    void appendEvent(QByteArray &out, const Event &e, int tid)
+    {
+        char phase[2] = {e.phase, 0};
+        appendHeader(out, phase, e.category, QString::fromLatin1(e.name), e.ns, tid);
+        if (e.detailLength > 0)
+        {
+            out += ",\"args\":{\"detail\":";
+            appendString(out, QString::fromUtf16(e.detail, e.detailLength));
+            out += '}';
+        }
+        out += "},\n";
+    }
+
+    /**
+     * @brief Moves every ring's pending events to the trace file.
+     */
+    void drain()
+    {
+        State &s = state();
+        QVector<std::shared_ptr<Ring>> rings;
+        {
+            QMutexLocker lock(&s.mutex);
+            rings = s.rings;
+        }
+
+        QByteArray out;
+        for (const auto &ring : rings)
+        {
+            quint64 tail = ring->tail.load(std::memory_order_relaxed);
+            quint64 head = ring->head.load(std::memory_order_acquire);
+            if (tail == head)
+                continue;
+            if (!ring->named)
+            {
+                appendHeader(out, "M", "__metadata", "thread_name", s.originNs, ring->tid);
+                out += ",\"args\":{\"name\":";
+                appendString(out, ring->threadName);
+                out += "}},\n";
+                ring->named = true;
+            }
+            for (; tail != head; ++tail)
+                appendEvent(out, ring->events[tail % RING_CAPACITY], ring->tid);
+            ring->tail.store(head, std::memory_order_release);
+
+            quint64 dropped = ring->dropped.load(std::memory_order_relaxed);
+            if (dropped != ring->reportedDrops)
+            {
+                appendHeader(out, "i", "tracer", "events dropped", nowNs(), ring->tid);
+                out += ",\"s\":\"t\",\"args\":{\"count\":" + QByteArray::number(dropped - ring->reportedDrops) + "}},\n";
+                ring->reportedDrops = dropped;
+            }
+        }
+        s.file.write(out);
+    }
+}
+
+void Tracer::start(const QString &path)
+{
+    State &s = state();
+    if (isEnabled())
+        return;
+
+    s.file.setFileName(path);
+    if (!s.file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        throw Acadence::FileException("Failed to open file for writing: " + path);
+    s.file.write("[\n");
+    s.originNs = nowNs();
+
+    // Forget events left over from an earlier trace
+    QMutexLocker lock(&s.mutex);
+    for (const auto &ring : s.rings)
+    {
+        ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+        ring->reportedDrops = ring->dropped.load(std::memory_order_relaxed);
+        ring->named = false;
+    }
+    s.stopping = false;
+    s.flusher = QThread::create([]()
+                                {
+        State &s = state();
+        QMutexLocker lock(&s.mutex);
+        while (!s.stopping)
+        {
+            s.wake.wait(&s.mutex, FLUSH_INTERVAL_MS);
+            lock.unlock();
+            drain();
+            lock.relock();
+        } });
+    s.flusher->setObjectName("Trace writer");
+    s.flusher->start(QThread::LowPriority);
+    active.store(true, std::memory_order_release);
+}
+
+void Tracer::stop()
+{
+    State &s = state();
+    if (!isEnabled())
+        return;
+    active.store(false, std::memory_order_release);
+    {
+        QMutexLocker lock(&s.mutex);
+        s.stopping = true;
+        s.wake.wakeAll();
+    }
+    s.flusher->wait();
+    delete s.flusher;
+    s.flusher = nullptr;
+
+    drain();
+    // Ends the array without a trailing comma
+    QByteArray last;
+    appendHeader(last, "M", "__metadata", "process_name", s.originNs, 0);
+    last += ",\"args\":{\"name\":";
+    appendString(last, QCoreApplication::applicationName());
+    last += "}}\n]\n";
+    s.file.write(last);
+    s.file.close();
+}
+
+void Tracer::record(char phase, const char *category, const char *name, const QString *detail)
+{
+    Ring &ring = localRing();
+    quint64 head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= quint64(RING_CAPACITY))
+    {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event &e = ring.events[head % RING_CAPACITY];
+    e.ns = nowNs();
+    e.category = category;
+    e.name = name;
+    e.phase = phase;
+    e.detailLength = 0;
+    if (detail)
+    {
+        e.detailLength = quint8(qMin<qsizetype>(detail->size(), DETAIL_LENGTH));
+        std::memcpy(e.detail, detail->utf16(), e.detailLength * sizeof(char16_t));
+    }
+    ring.head.store(head + 1, std::memory_order_release);
+}
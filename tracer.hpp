@@ -0,0 +1,78 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <QString>
+#include <atomic>
+
+/**
+ * @brief Timeline of begin/end events in Chrome's Trace Event format, for
+ * chrome://tracing or ui.perfetto.dev.
+ *
+ * Each thread records into its own fixed-size ring buffer without locks or
+ * allocation; a background thread drains the rings every few milliseconds
+ * and appends the events to the trace file. A ring that fills before it is
+ * drained drops events and the count is written to the trace.
+ *
+ * Tracing is off unless start() was called (the app does so for --trace
+ * <file> or ACADENCE_TRACE); until then each span costs one branch.
+ */
+class Tracer
+{
+public:
+    /**
+     * @brief Begins writing a trace to @p path.
+     * @throws Acadence::FileException if the file cannot be written.
+     */
+    static void start(const QString &path);
+
+    /**
+     * @brief Writes the remaining events and closes the trace.
+     */
+    static void stop();
+
+    static bool isEnabled() { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Begin event on construction, matching end event on destruction.
+     * @p category and @p name must outlive the trace (string literals or
+     * meta-object class names); @p detail is copied, truncated.
+     */
+    class Span
+    {
+    public:
+        Span(const char *category, const char *name) : category(category), name(name), open(isEnabled())
+        {
+            if (open)
+                record('B', category, name);
+        }
+        Span(const char *category, const char *name, const QString &detail) : category(category), name(name), open(isEnabled())
+        {
+            if (open)
+                record('B', category, name, &detail);
+        }
+        ~Span()
+        {
+            if (open)
+                record('E', category, name);
+        }
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+    private:
+        const char *category;
+        const char *name;
+        bool open;
+    };
+
+private:
+    static void record(char phase, const char *category, const char *name, const QString *detail = nullptr);
+
+    static std::atomic<bool> active;
+};
+
+#define ACADENCE_TRACE_CONCAT2(a, b) a##b
+#define ACADENCE_TRACE_CONCAT(a, b) ACADENCE_TRACE_CONCAT2(a, b)
+#define ACADENCE_TRACE(category, name) Tracer::Span ACADENCE_TRACE_CONCAT(acadenceSpan, __LINE__)(category, name)
+#define ACADENCE_TRACE_DETAIL(category, name, detail) Tracer::Span ACADENCE_TRACE_CONCAT(acadenceSpan, __LINE__)(category, name, detail)
+
+#endif // TRACER_HPP
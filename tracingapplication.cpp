@@ -0,0 +1,19 @@
+/**
+ * @file tracingapplication.cpp
+ * @brief Paint event spans for the trace.
+ */
+#include "tracingapplication.hpp"
+#include "tracer.hpp"
+#include <QEvent>
+
+TracingApplication::TracingApplication(int &argc, char **argv) : QApplication(argc, argv) {}
+
+bool TracingApplication::notify(QObject *receiver, QEvent *event)
+{
+    if (Tracer::isEnabled() && event->type() == QEvent::Paint)
+    {
+        Tracer::Span span("paint", receiver->metaObject()->className(), receiver->objectName());
+        return QApplication::notify(receiver, event);
+    }
+    return QApplication::notify(receiver, event);
+}
@@ -0,0 +1,19 @@
+#ifndef TRACINGAPPLICATION_HPP
+#define TRACINGAPPLICATION_HPP
+
+#include <QApplication>
+
+/**
+ * @brief QApplication that adds each widget's paint events to the trace
+ * while Tracer is enabled, named after the widget's class.
+ */
+class TracingApplication : public QApplication
+{
+    Q_OBJECT
+public:
+    TracingApplication(int &argc, char **argv);
+
+    bool notify(QObject *receiver, QEvent *event) override;
+};
+
+#endif // TRACINGAPPLICATION_HPP
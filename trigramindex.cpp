@@ -0,0 +1,220 @@
+/**
+ * @file trigramindex.cpp
+ * @brief Trigram inverted index for substring search over a table.
+ */
+#include "trigramindex.hpp"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+#include <numeric>
+
+TrigramIndex::TrigramIndex(const CsvTable &data) : rows(data), nextId(static_cast<int>(data.size())), columns(0)
+{
+    postings.reserve(1 << 14);
+    ids.resize(rows.size());
+    std::iota(ids.begin(), ids.end(), 0);
+    for (int r = 0; r < rows.size(); ++r)
+    {
+        const QStringList &row = rows[r];
+        columns = std::max(columns, static_cast<int>(row.size()));
+        for (int c = 0; c < row.size(); ++c)
+            index(r, c, row[c]);
+    }
+}
+
+quint64 TrigramIndex::key(int column, const QString &folded, int pos)
+{
+    return (quint64(column & 0xFFFF) << 48) | (quint64(folded[pos].unicode()) << 32) |
+           (quint64(folded[pos + 1].unicode()) << 16) | quint64(folded[pos + 2].unicode());
+}
+
+void TrigramIndex::index(int id, int column, const QString &field)
+{
+    QString folded = field.toCaseFolded();
+    for (int i = 0; i + 3 <= folded.size(); ++i)
+    {
+        Postings &list = postings[key(column, folded, i)];
+        // Rows are usually added in order, so the common case is a push_back
+        if (list.isEmpty() || list.last() < id)
+        {
+            list.append(id);
+            continue;
+        }
+        auto it = std::lower_bound(list.begin(), list.end(), id);
+        if (*it != id)
+            list.insert(it, id);
+    }
+}
+
+void TrigramIndex::unindex(int id, int column, const QString &field)
+{
+    QString folded = field.toCaseFolded();
+    for (int i = 0; i + 3 <= folded.size(); ++i)
+    {
+        auto found = postings.find(key(column, folded, i));
+        if (found == postings.end())
+            continue;
+        Postings &list = found.value();
+        auto it = std::lower_bound(list.begin(), list.end(), id);
+        if (it != list.end() && *it == id)
+            list.erase(it);
+        if (list.isEmpty())
+            postings.erase(found);
+    }
+}
+
+void TrigramIndex::updateRow(int row, const QStringList &fields)
+{
+    QWriteLocker locker(&lock);
+    if (row < 0 || row >= rows.size())
+        return;
+
+    // Only columns whose text changed are touched
+    const QStringList before = rows[row];
+    int width = std::max(before.size(), fields.size());
+    for (int c = 0; c < width; ++c)
+    {
+        QString oldField = before.value(c);
+        QString newField = fields.value(c);
+        if (oldField == newField)
+            continue;
+        unindex(ids[row], c, oldField);
+        index(ids[row], c, newField);
+    }
+    rows[row] = fields;
+    columns = std::max(columns, static_cast<int>(fields.size()));
+}
+
+void TrigramIndex::appendRow(const QStringList &fields)
+{
+    QWriteLocker locker(&lock);
+    int id = nextId++;
+    rows.append(fields);
+    ids.append(id);
+    columns = std::max(columns, static_cast<int>(fields.size()));
+    for (int c = 0; c < fields.size(); ++c)
+        index(id, c, fields[c]);
+}
+
+void TrigramIndex::removeRows(const QVector<int> &positions)
+{
+    QWriteLocker locker(&lock);
+    for (int i = 0; i < positions.size(); ++i)
+        if (positions[i] < 0 || positions[i] >= rows.size() || (i > 0 && positions[i] <= positions[i - 1]))
+            return;
+
+    for (int row : positions)
+    {
+        const QStringList &fields = std::as_const(rows)[row];
+        for (int c = 0; c < fields.size(); ++c)
+            unindex(ids[row], c, fields[c]);
+    }
+
+    // One pass moves the later rows up past all removed ones
+    int kept = positions.isEmpty() ? static_cast<int>(rows.size()) : positions.first();
+    int next = 0;
+    for (int r = kept; r < rows.size(); ++r)
+    {
+        if (next < positions.size() && positions[next] == r)
+        {
+            ++next;
+            continue;
+        }
+        rows[kept] = std::move(rows[r]);
+        ids[kept] = ids[r];
+        ++kept;
+    }
+    rows.resize(kept);
+    ids.resize(kept);
+}
+
+int TrigramIndex::position(int id) const
+{
+    return static_cast<int>(std::lower_bound(ids.begin(), ids.end(), id) - ids.begin());
+}
+
+QVector<int> TrigramIndex::searchColumn(const QString &folded, const QString &needle, int column) const
+{
+    // Shortest posting list first keeps the intersection small from the start
+    QVector<const Postings *> lists;
+    for (int i = 0; i + 3 <= folded.size(); ++i)
+    {
+        auto it = postings.constFind(key(column, folded, i));
+        if (it == postings.constEnd())
+            return {};
+        lists.append(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const Postings *a, const Postings *b)
+              { return a->size() < b->size(); });
+
+    QVector<int> candidates = *lists.first();
+    for (int i = 1; i < lists.size() && !candidates.isEmpty(); ++i)
+    {
+        const Postings &list = *lists[i];
+        QVector<int> kept;
+        kept.reserve(candidates.size());
+        auto from = list.begin();
+        for (int id : candidates)
+        {
+            from = std::lower_bound(from, list.end(), id);
+            if (from == list.end())
+                break;
+            if (*from == id)
+                kept.append(id);
+        }
+        candidates.swap(kept);
+    }
+
+    // Trigrams may occur out of order; confirm the actual substring
+    QVector<int> result;
+    result.reserve(candidates.size());
+    for (int id : candidates)
+    {
+        int row = position(id);
+        if (rows[row].value(column).contains(needle, Qt::CaseInsensitive))
+            result.append(row);
+    }
+    return result;
+}
+
+QVector<int> TrigramIndex::search(const QString &needle, int column) const
+{
+    QReadLocker locker(&lock);
+    if (needle.size() < 3)
+        return scan(rows, needle, column);
+
+    QString folded = needle.toCaseFolded();
+    if (column >= 0)
+        return searchColumn(folded, needle, column);
+
+    QVector<int> result;
+    for (int c = 0; c < columns; ++c)
+        result += searchColumn(folded, needle, c);
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QVector<int> TrigramIndex::scan(const CsvTable &rows, const QString &needle, int column)
+{
+    QVector<int> result;
+    for (int r = 0; r < rows.size(); ++r)
+    {
+        const QStringList &row = rows[r];
+        if (column >= 0)
+        {
+            if (row.value(column).contains(needle, Qt::CaseInsensitive))
+                result.append(r);
+            continue;
+        }
+        for (const QString &field : row)
+        {
+            if (field.contains(needle, Qt::CaseInsensitive))
+            {
+                result.append(r);
+                break;
+            }
+        }
+    }
+    return result;
+}
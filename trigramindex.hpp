@@ -0,0 +1,80 @@
+#ifndef TRIGRAMINDEX_HPP
+#define TRIGRAMINDEX_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QReadWriteLock>
+#include "datastore.hpp"
+
+/**
+ * @brief Inverted index from (column, trigram) to the rows containing it.
+ *
+ * Answers case-insensitive substring searches over one table without
+ * scanning it: the posting lists of the needle's trigrams are intersected
+ * and only the surviving rows are checked. Needles shorter than three
+ * characters fall back to a scan.
+ *
+ * Posting lists hold row ids rather than positions. Ids are handed out in
+ * table order and never reused, so the ids of the rows, in order, stay
+ * ascending: a position is found by binary search, and removing rows only
+ * unindexes them instead of renumbering every posting after them.
+ *
+ * Searches may run on any thread concurrently with updateRow(),
+ * appendRow() and removeRows().
+ */
+class TrigramIndex
+{
+public:
+    /**
+     * @brief Indexes every field of every row.
+     */
+    explicit TrigramIndex(const CsvTable &rows);
+
+    /**
+     * @brief Re-indexes the fields of a row that changed.
+     */
+    void updateRow(int row, const QStringList &fields);
+
+    /**
+     * @brief Indexes a row added at the end of the table.
+     */
+    void appendRow(const QStringList &fields);
+
+    /**
+     * @brief Drops rows from the index; later rows move up, like QVector::remove().
+     * @param positions Row positions, ascending.
+     */
+    void removeRows(const QVector<int> &positions);
+
+    /**
+     * @brief Rows with a field containing @p needle (ignoring case).
+     * @param column Column to search, or -1 for all columns.
+     * @return Matching row indexes in ascending order.
+     */
+    QVector<int> search(const QString &needle, int column = -1) const;
+
+    /**
+     * @brief Same result as search(), by checking every row.
+     */
+    static QVector<int> scan(const CsvTable &rows, const QString &needle, int column = -1);
+
+private:
+    using Postings = QVector<int>; ///< Ascending row ids.
+
+    static quint64 key(int column, const QString &folded, int pos);
+    void index(int id, int column, const QString &field);
+    void unindex(int id, int column, const QString &field);
+    int position(int id) const;
+    QVector<int> searchColumn(const QString &folded, const QString &needle, int column) const;
+
+    mutable QReadWriteLock lock;
+    CsvTable rows;
+    QVector<int> ids; ///< Id of the row at each position; ascending.
+    int nextId;
+    QHash<quint64, Postings> postings;
+    int columns; ///< Widest row seen.
+};
+
+#endif // TRIGRAMINDEX_HPP